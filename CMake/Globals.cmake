@@ -1 +1,3 @@
 option(Math_USE_DOUBLE "defines the datat type Real as double" ON)
+option(Math_USE_SIMD_VEC4 "Store and evaluate Vec4 in a single SIMD register" OFF)
+option(Math_USE_FAST_RSQRT "Use the refined hardware estimate for 1/sqrt in normalize" OFF)
@@ -0,0 +1,117 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Affine3.h"
+#include <cstdio>
+#include "Math/Dispatch.h"
+
+namespace Rt2::Math
+{
+    template <typename T>
+    void TAffine3<T>::multiplyArrays(TAffine3* d, const TAffine3* a, const TAffine3* b, const size_t n)
+    {
+        static_assert(sizeof(TAffine3) == 12 * sizeof(T));
+
+        if constexpr (std::is_same_v<T, Real>)
+        {
+            Dispatch::kernels().affineMul(
+                reinterpret_cast<Real*>(d),
+                reinterpret_cast<const Real*>(a),
+                reinterpret_cast<const Real*>(b),
+                n);
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                d[i] = a[i] * b[i];
+        }
+    }
+
+    template <typename T>
+    void TAffine3<T>::multiplyArrays(TAffine3* d, const TAffine3* a, const int32_t* parent, const TAffine3* b, const size_t n)
+    {
+        if constexpr (std::is_same_v<T, Real>)
+        {
+            Dispatch::kernels().affineMulIndexed(
+                reinterpret_cast<Real*>(d),
+                reinterpret_cast<const Real*>(a),
+                parent,
+                reinterpret_cast<const Real*>(b),
+                n);
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                d[i] = parent[i] < 0 ? b[i] : a[parent[i]] * b[i];
+        }
+    }
+
+    template <typename T>
+    void TAffine3<T>::multiplyHierarchy(TAffine3* world, const TAffine3* local, const int32_t* parent, const size_t n)
+    {
+        multiplyArrays(world, world, parent, local, n);
+    }
+
+    template <typename T>
+    void TAffine3<T>::makeTransforms(TAffine3* d, const TVec3<T>* loc, const TVec3<T>* scale, const TQuat<T>* rot, const size_t n)
+    {
+        static_assert(sizeof(TVec3<T>) == 3 * sizeof(T) && sizeof(TQuat<T>) == 4 * sizeof(T));
+
+        if constexpr (std::is_same_v<T, Real>)
+        {
+            Dispatch::kernels().affineCompose(
+                reinterpret_cast<Real*>(d),
+                reinterpret_cast<const Real*>(loc),
+                reinterpret_cast<const Real*>(scale),
+                reinterpret_cast<const Real*>(rot),
+                n);
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                d[i].makeTransform(loc[i], scale[i], rot[i]);
+        }
+    }
+
+    template <typename T>
+    void TAffine3<T>::print() const
+    {
+        printf("[ %3.3f, %3.3f, %3.3f, %3.3f ]\n", (double)m[0][0], (double)m[0][1], (double)m[0][2], (double)m[0][3]);
+        printf("[ %3.3f, %3.3f, %3.3f, %3.3f ]\n", (double)m[1][0], (double)m[1][1], (double)m[1][2], (double)m[1][3]);
+        printf("[ %3.3f, %3.3f, %3.3f, %3.3f ]\n", (double)m[2][0], (double)m[2][1], (double)m[2][2], (double)m[2][3]);
+    }
+
+    template void TAffine3<float>::print() const;
+    template void TAffine3<double>::print() const;
+
+    template void TAffine3<float>::multiplyArrays(TAffine3*, const TAffine3*, const TAffine3*, size_t);
+    template void TAffine3<double>::multiplyArrays(TAffine3*, const TAffine3*, const TAffine3*, size_t);
+
+    template void TAffine3<float>::multiplyArrays(TAffine3*, const TAffine3*, const int32_t*, const TAffine3*, size_t);
+    template void TAffine3<double>::multiplyArrays(TAffine3*, const TAffine3*, const int32_t*, const TAffine3*, size_t);
+
+    template void TAffine3<float>::multiplyHierarchy(TAffine3*, const TAffine3*, const int32_t*, size_t);
+    template void TAffine3<double>::multiplyHierarchy(TAffine3*, const TAffine3*, const int32_t*, size_t);
+
+    template void TAffine3<float>::makeTransforms(TAffine3*, const Vec3f*, const Vec3f*, const Quatf*, size_t);
+    template void TAffine3<double>::makeTransforms(TAffine3*, const Vec3d*, const Vec3d*, const Quatd*, size_t);
+
+}  // namespace Rt2::Math
@@ -0,0 +1,361 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstdint>
+#include "Math/Forward.h"
+#include "Math/Mat3.h"
+#include "Math/Mat4.h"
+#include "Math/Quat.h"
+#include "Math/Simd.h"
+#include "Math/Transform.h"
+#include "Math/Vec3.h"
+
+namespace Rt2::Math
+{
+    // The top three rows of a Mat4 whose bottom row is [0 0 0 1], as
+    // built by Mat4::makeTransform. Composition needs 36 products
+    // instead of 64, and the inverse only has to invert the 3x3 part.
+    template <typename T>
+    class TAffine3
+    {
+    public:
+        T m[3][4]{};
+
+        static const TAffine3 Identity;
+
+    public:
+        TAffine3() = default;
+
+        TAffine3(const TAffine3&) = default;
+
+        constexpr TAffine3(const TMat3<T>& linear, const TVec3<T>& trans);
+
+        template <typename U>
+        explicit constexpr TAffine3(const TAffine3<U>& v);
+
+        // Drops the bottom row of m4.
+        explicit constexpr TAffine3(const TMat4<T>& m4);
+
+        constexpr TAffine3 operator*(const TAffine3& rhs) const;
+
+        constexpr bool operator==(const TAffine3& rhs) const;
+
+        constexpr TVec3<T> transformPoint(const TVec3<T>& p) const;
+
+        constexpr TVec3<T> transformDirection(const TVec3<T>& v) const;
+
+        // Batch forms of transformPoint and transformDirection, see
+        // Transform::apply for the strided forms.
+        void transformPoints(TVec3<T>* d, const TVec3<T>* s, size_t n) const;
+
+        void transformPoints(T* d, size_t dStride, const T* s, size_t sStride, size_t n) const;
+
+        void transformDirections(TVec3<T>* d, const TVec3<T>* s, size_t n) const;
+
+        void transformDirections(T* d, size_t dStride, const T* s, size_t sStride, size_t n) const;
+
+        constexpr T det() const;
+
+        // General affine inverse. Returns Identity if the 3x3 part is singular.
+        constexpr TAffine3 inverted() const;
+
+        // Inverse of a rotation and translation only transform, the
+        // transposed rotation with the translation rotated back.
+        constexpr TAffine3 invertedRigid() const;
+
+        constexpr TMat3<T> linear() const;
+
+        constexpr TVec3<T> getTrans() const;
+
+        constexpr void setTrans(const TVec3<T>& v);
+
+        constexpr TMat4<T> toMat4() const;
+
+        constexpr void makeIdentity();
+
+        constexpr void makeTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TQuat<T>& rot);
+
+        constexpr void makeTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TMat3<T>& rot);
+
+        // Batch forms of operator*, following Mat4::multiplyArrays.
+        static void multiplyArrays(TAffine3* d, const TAffine3* a, const TAffine3* b, size_t n);
+
+        static void multiplyArrays(TAffine3* d, const TAffine3* a, const int32_t* parent, const TAffine3* b, size_t n);
+
+        static void multiplyHierarchy(TAffine3* world, const TAffine3* local, const int32_t* parent, size_t n);
+
+        // Batch form of makeTransform, following Mat4::makeTransforms.
+        static void makeTransforms(TAffine3* d, const TVec3<T>* loc, const TVec3<T>* scale, const TQuat<T>* rot, size_t n);
+
+        void print() const;
+    };
+
+    template <typename T>
+    constexpr TAffine3<T>::TAffine3(const TMat3<T>& linear, const TVec3<T>& trans)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+                m[i][j] = linear.m[i][j];
+        }
+        setTrans(trans);
+    }
+
+    template <typename T>
+    template <typename U>
+    constexpr TAffine3<T>::TAffine3(const TAffine3<U>& v)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+                m[i][j] = T(v.m[i][j]);
+        }
+    }
+
+    template <typename T>
+    constexpr TAffine3<T>::TAffine3(const TMat4<T>& m4)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+                m[i][j] = m4.m[i][j];
+        }
+    }
+
+    template <typename T>
+    constexpr TAffine3<T> TAffine3<T>::operator*(const TAffine3& rhs) const
+    {
+        TAffine3 r;
+#if defined(Math_SIMD_QUAD) && defined(Math_HAS_CONSTANT_EVALUATED)
+        if constexpr (std::is_same_v<T, Real>)
+        {
+            if (!isConstantEvaluated())
+            {
+                Simd::mul3x4(r.m[0], m[0], rhs.m[0]);
+                return r;
+            }
+        }
+#endif
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+                r.m[i][j] = m[i][0] * rhs.m[0][j] + m[i][1] * rhs.m[1][j] + m[i][2] * rhs.m[2][j];
+            r.m[i][3] += m[i][3];
+        }
+        return r;
+    }
+
+    template <typename T>
+    constexpr bool TAffine3<T>::operator==(const TAffine3& rhs) const
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                if (!eq<T>(m[i][j], rhs.m[i][j]))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TAffine3<T>::transformPoint(const TVec3<T>& p) const
+    {
+        return {
+            m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+            m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+            m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3],
+        };
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TAffine3<T>::transformDirection(const TVec3<T>& v) const
+    {
+        return {
+            m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+            m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+            m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z,
+        };
+    }
+
+    template <typename T>
+    void TAffine3<T>::transformPoints(TVec3<T>* d, const TVec3<T>* s, const size_t n) const
+    {
+        transformPoints(reinterpret_cast<T*>(d), sizeof(TVec3<T>), reinterpret_cast<const T*>(s), sizeof(TVec3<T>), n);
+    }
+
+    template <typename T>
+    void TAffine3<T>::transformPoints(T* d, const size_t dStride, const T* s, const size_t sStride, const size_t n) const
+    {
+        Transform::apply(TM_POINT, m[0], d, dStride, s, sStride, n);
+    }
+
+    template <typename T>
+    void TAffine3<T>::transformDirections(TVec3<T>* d, const TVec3<T>* s, const size_t n) const
+    {
+        transformDirections(reinterpret_cast<T*>(d), sizeof(TVec3<T>), reinterpret_cast<const T*>(s), sizeof(TVec3<T>), n);
+    }
+
+    template <typename T>
+    void TAffine3<T>::transformDirections(T* d, const size_t dStride, const T* s, const size_t sStride, const size_t n) const
+    {
+        Transform::apply(TM_DIRECTION, m[0], d, dStride, s, sStride, n);
+    }
+
+    template <typename T>
+    constexpr T TAffine3<T>::det() const
+    {
+        return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+               m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+               m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    }
+
+    template <typename T>
+    constexpr TAffine3<T> TAffine3<T>::inverted() const
+    {
+        T d = det();
+        if (isZero<T>(d))
+            return Identity;
+        d = T(1.0) / d;
+
+        // The columns of the inverse are the cross products of the rows.
+        const TVec3<T> r0(m[0][0], m[0][1], m[0][2]);
+        const TVec3<T> r1(m[1][0], m[1][1], m[1][2]);
+        const TVec3<T> r2(m[2][0], m[2][1], m[2][2]);
+
+        const TVec3<T> c0 = r1.cross(r2) * d;
+        const TVec3<T> c1 = r2.cross(r0) * d;
+        const TVec3<T> c2 = r0.cross(r1) * d;
+
+        TAffine3 r;
+        r.m[0][0] = c0.x;
+        r.m[0][1] = c1.x;
+        r.m[0][2] = c2.x;
+        r.m[1][0] = c0.y;
+        r.m[1][1] = c1.y;
+        r.m[1][2] = c2.y;
+        r.m[2][0] = c0.z;
+        r.m[2][1] = c1.z;
+        r.m[2][2] = c2.z;
+        r.setTrans(-r.transformDirection(getTrans()));
+        return r;
+    }
+
+    template <typename T>
+    constexpr TAffine3<T> TAffine3<T>::invertedRigid() const
+    {
+        TAffine3 r;
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+                r.m[i][j] = m[j][i];
+        }
+        r.setTrans(-r.transformDirection(getTrans()));
+        return r;
+    }
+
+    template <typename T>
+    constexpr TMat3<T> TAffine3<T>::linear() const
+    {
+        return {
+            m[0][0],
+            m[0][1],
+            m[0][2],
+            m[1][0],
+            m[1][1],
+            m[1][2],
+            m[2][0],
+            m[2][1],
+            m[2][2],
+        };
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TAffine3<T>::getTrans() const
+    {
+        return TVec3<T>(m[0][3], m[1][3], m[2][3]);
+    }
+
+    template <typename T>
+    constexpr void TAffine3<T>::setTrans(const TVec3<T>& v)
+    {
+        m[0][3] = v.x;
+        m[1][3] = v.y;
+        m[2][3] = v.z;
+    }
+
+    template <typename T>
+    constexpr TMat4<T> TAffine3<T>::toMat4() const
+    {
+        return {
+            m[0][0],
+            m[0][1],
+            m[0][2],
+            m[0][3],
+            m[1][0],
+            m[1][1],
+            m[1][2],
+            m[1][3],
+            m[2][0],
+            m[2][1],
+            m[2][2],
+            m[2][3],
+            0,
+            0,
+            0,
+            1,
+        };
+    }
+
+    template <typename T>
+    constexpr void TAffine3<T>::makeIdentity()
+    {
+        *this = Identity;
+    }
+
+    template <typename T>
+    constexpr void TAffine3<T>::makeTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TQuat<T>& rot)
+    {
+        TMat3<T> m3;
+
+        m3.fromQuaternion(rot);
+        makeTransform(loc, scale, m3);
+    }
+
+    template <typename T>
+    constexpr void TAffine3<T>::makeTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TMat3<T>& rot)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            m[i][0] = scale.x * rot.m[i][0];
+            m[i][1] = scale.y * rot.m[i][1];
+            m[i][2] = scale.z * rot.m[i][2];
+        }
+        setTrans(loc);
+    }
+
+    template <typename T>
+    inline constexpr TAffine3<T> TAffine3<T>::Identity = TAffine3<T>(TMat3<T>::Identity, TVec3<T>::Zero);
+
+}  // namespace Rt2::Math
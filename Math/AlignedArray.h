@@ -0,0 +1,217 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "Math/Scalar.h"
+
+namespace Rt2::Math
+{
+    // Contiguous storage whose first element, and capacity, sit on a
+    // cache line boundary so that stream kernels can use full-width loads.
+    template <typename T, size_t Alignment = 64>
+    class AlignedArray
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+    public:
+        static constexpr size_t Granularity = Alignment / sizeof(T) > 0 ? Alignment / sizeof(T) : 1;
+
+    private:
+        T*     _data{nullptr};
+        size_t _size{0};
+        size_t _capacity{0};
+
+    public:
+        AlignedArray() = default;
+
+        explicit AlignedArray(const size_t n)
+        {
+            resize(n);
+        }
+
+        AlignedArray(const AlignedArray& o)
+        {
+            *this = o;
+        }
+
+        AlignedArray(AlignedArray&& o) noexcept
+        {
+            swap(o);
+        }
+
+        ~AlignedArray()
+        {
+            release();
+        }
+
+        AlignedArray& operator=(const AlignedArray& o)
+        {
+            if (this != &o)
+            {
+                resize(o._size);
+                if (_size > 0)
+                    std::memcpy(_data, o._data, _size * sizeof(T));
+            }
+            return *this;
+        }
+
+        AlignedArray& operator=(AlignedArray&& o) noexcept
+        {
+            if (this != &o)
+            {
+                release();
+                swap(o);
+            }
+            return *this;
+        }
+
+        void swap(AlignedArray& o) noexcept
+        {
+            T*           d = _data;
+            const size_t s = _size;
+            const size_t c = _capacity;
+
+            _data     = o._data;
+            _size     = o._size;
+            _capacity = o._capacity;
+
+            o._data     = d;
+            o._size     = s;
+            o._capacity = c;
+        }
+
+        void reserve(size_t n)
+        {
+            if (n <= _capacity)
+                return;
+
+            n = (n + Granularity - 1) / Granularity * Granularity;
+
+            // The slots past size are value-initialized as well, so that
+            // full-width loads over the padding never see garbage.
+            T* data = static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+            if (_size > 0)
+                std::memcpy(data, _data, _size * sizeof(T));
+            std::uninitialized_value_construct_n(data + _size, n - _size);
+
+            const size_t size = _size;
+            release();
+            _data     = data;
+            _size     = size;
+            _capacity = n;
+        }
+
+        void resize(const size_t n)
+        {
+            if (n > _capacity)
+                reserve(n > _capacity * 2 ? n : _capacity * 2);
+            if (n > _size)
+                std::uninitialized_value_construct_n(_data + _size, n - _size);
+            _size = n;
+        }
+
+        void push_back(const T& v)
+        {
+            // v may refer into this array, so it is copied before the
+            // storage can move.
+            const T copy = v;
+            if (_size + 1 > _capacity)
+                reserve(_capacity > 0 ? _capacity * 2 : Granularity);
+            _data[_size++] = copy;
+        }
+
+        void clear()
+        {
+            _size = 0;
+        }
+
+        T* data()
+        {
+            return _data;
+        }
+
+        const T* data() const
+        {
+            return _data;
+        }
+
+        T& operator[](const size_t i)
+        {
+            return _data[i];
+        }
+
+        const T& operator[](const size_t i) const
+        {
+            return _data[i];
+        }
+
+        T* begin()
+        {
+            return _data;
+        }
+
+        T* end()
+        {
+            return _data + _size;
+        }
+
+        const T* begin() const
+        {
+            return _data;
+        }
+
+        const T* end() const
+        {
+            return _data + _size;
+        }
+
+        size_t size() const
+        {
+            return _size;
+        }
+
+        size_t capacity() const
+        {
+            return _capacity;
+        }
+
+        bool empty() const
+        {
+            return _size == 0;
+        }
+
+    private:
+        void release()
+        {
+            if (_data)
+                ::operator delete(_data, std::align_val_t(Alignment));
+            _data     = nullptr;
+            _size     = 0;
+            _capacity = 0;
+        }
+    };
+
+}  // namespace Rt2::Math
@@ -0,0 +1,233 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Animation.h"
+#include <algorithm>
+#include "Math/Barrier.h"
+#include "Math/Dispatch.h"
+
+namespace Rt2::Math
+{
+    namespace
+    {
+        // Below this many states per thread, fewer threads are used.
+        constexpr size_t MinStatesPerWorker = 16;
+
+        // Keys a cursor steps forward before it falls back to a
+        // binary search.
+        constexpr uint32_t MaxCursorSteps = 4;
+
+        // The index k of the key pair [k, k + 1] that brackets t, for
+        // n >= 2 keys, starting from the previous result in cursor.
+        uint32_t seek(const Real* kt, const uint32_t n, const Real t, uint32_t& cursor)
+        {
+            uint32_t k = cursor < n - 1 ? cursor : 0;
+            if (t >= kt[k])
+            {
+                for (uint32_t s = 0; s < MaxCursorSteps && k + 2 < n && kt[k + 1] <= t; ++s)
+                    ++k;
+                if (k + 2 >= n || kt[k + 1] > t)
+                    return cursor = k;
+            }
+
+            k = (uint32_t)(std::upper_bound(kt, kt + n, t) - kt);
+            k = k > 0 ? k - 1 : 0;
+            return cursor = k < n - 2 ? k : n - 2;
+        }
+    }  // namespace
+
+    void AnimationClip::clear()
+    {
+        _tracks.clear();
+        _times.clear();
+        _realKeys.clear();
+        _vec3Keys.clear();
+        _quatKeys.clear();
+
+        for (uint32_t& slot : _slots)
+            slot = 0;
+        _duration = 0;
+    }
+
+    int32_t AnimationClip::addTimes(const TrackType type, const Real* times, const size_t n, const size_t key)
+    {
+        if (n == 0 || !times)
+            return None;
+        for (size_t i = 1; i < n; ++i)
+        {
+            if (!(times[i] > times[i - 1]))
+                return None;
+        }
+
+        Track track{};
+        track.type  = type;
+        track.time  = (uint32_t)_times.size();
+        track.key   = (uint32_t)key;
+        track.count = (uint32_t)n;
+        track.slot  = _slots[type]++;
+        _tracks.push_back(track);
+
+        for (size_t i = 0; i < n; ++i)
+            _times.push_back(times[i]);
+        if (times[n - 1] > _duration)
+            _duration = times[n - 1];
+        return (int32_t)track.slot;
+    }
+
+    int32_t AnimationClip::addTrack(const Real* times, const Real* keys, const size_t n)
+    {
+        const int32_t slot = keys ? addTimes(TT_REAL, times, n, _realKeys.size()) : None;
+        if (slot != None)
+        {
+            for (size_t i = 0; i < n; ++i)
+                _realKeys.push_back(keys[i]);
+        }
+        return slot;
+    }
+
+    int32_t AnimationClip::addTrack(const Real* times, const Vec3* keys, const size_t n)
+    {
+        const int32_t slot = keys ? addTimes(TT_VEC3, times, n, _vec3Keys.size()) : None;
+        if (slot != None)
+        {
+            for (size_t i = 0; i < n; ++i)
+                _vec3Keys.push(keys[i]);
+        }
+        return slot;
+    }
+
+    int32_t AnimationClip::addTrack(const Real* times, const Quat* keys, const size_t n)
+    {
+        const int32_t slot = keys ? addTimes(TT_QUAT, times, n, _quatKeys.size()) : None;
+        if (slot != None)
+        {
+            for (size_t i = 0; i < n; ++i)
+                _quatKeys.push(keys[i]);
+        }
+        return slot;
+    }
+
+    void AnimationClip::sample(AnimationState& state, const Real time) const
+    {
+        const size_t n = tracks();
+        if (state._cursor.size() != n)
+        {
+            state._cursor.resize(n);
+            std::fill_n(state._cursor.data(), n, 0u);
+        }
+
+        const size_t nr = _slots[TT_REAL], nv = _slots[TT_VEC3], nq = _slots[TT_QUAT];
+        state._ra.resize(nr);
+        state._rb.resize(nr);
+        state._rt.resize(nr);
+        state._va.resize(nv);
+        state._vb.resize(nv);
+        state._vt.resize(nv);
+        state._qa.resize(nq);
+        state._qb.resize(nq);
+        state._qt.resize(nq);
+
+        // Gathers the bracketing keys and blend factor of each track.
+        for (size_t i = 0; i < n; ++i)
+        {
+            const Track& tr = _tracks[i];
+            const Real*  kt = _times.data() + tr.time;
+
+            size_t a = tr.key, b = tr.key;
+            Real   f = 0;
+            if (tr.count > 1)
+            {
+                const uint32_t k = seek(kt, tr.count, time, state._cursor[i]);
+
+                a += k;
+                b += k + 1;
+                f = (time - kt[k]) / (kt[k + 1] - kt[k]);
+                f = f < 0 ? 0 : f > 1 ? 1 : f;
+            }
+
+            switch (tr.type)
+            {
+            case TT_REAL:
+                state._ra[tr.slot] = _realKeys[a];
+                state._rb[tr.slot] = _realKeys[b];
+                state._rt[tr.slot] = f;
+                break;
+            case TT_VEC3:
+                state._va.set(tr.slot, _vec3Keys.at(a));
+                state._vb.set(tr.slot, _vec3Keys.at(b));
+                state._vt[tr.slot] = f;
+                break;
+            case TT_QUAT:
+                state._qa.set(tr.slot, _quatKeys.at(a));
+                state._qb.set(tr.slot, _quatKeys.at(b));
+                state._qt[tr.slot] = f;
+                break;
+            default:
+                break;
+            }
+        }
+
+        const KernelTable& k = Dispatch::kernels();
+
+        state._reals.resize(nr);
+        k.realLerp(state._reals.data(), state._ra.data(), state._rb.data(), state._rt.data(), nr);
+
+        state._vec3s.resize(nv);
+        k.realLerp(state._vec3s.x(), state._va.x(), state._vb.x(), state._vt.data(), nv);
+        k.realLerp(state._vec3s.y(), state._va.y(), state._vb.y(), state._vt.data(), nv);
+        k.realLerp(state._vec3s.z(), state._va.z(), state._vb.z(), state._vt.data(), nv);
+
+        switch (_blend)
+        {
+        case RB_NLERP:
+            QuatStream::nlerp(state._quats, state._qa, state._qb, state._qt);
+            break;
+        case RB_SLERP:
+            QuatStream::slerp(state._quats, state._qa, state._qb, state._qt);
+            break;
+        case RB_FAST_SLERP:
+            QuatStream::fastSlerp(state._quats, state._qa, state._qb, state._qt);
+            break;
+        }
+    }
+
+    void AnimationClip::sample(AnimationState* states, const Real* times, const size_t n, unsigned workers) const
+    {
+        if (workers > n / MinStatesPerWorker)
+            workers = (unsigned)(n / MinStatesPerWorker);
+
+        const auto run = [&](const size_t w)
+        {
+            const size_t e = workers > 1 ? n * (w + 1) / workers : n;
+            for (size_t i = workers > 1 ? n * w / workers : 0; i < e; ++i)
+                sample(states[i], times[i]);
+        };
+
+        if (workers <= 1)
+        {
+            run(0);
+            return;
+        }
+
+        parallel(workers, run);
+    }
+
+}  // namespace Rt2::Math
@@ -0,0 +1,214 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstdint>
+#include "Math/AlignedArray.h"
+#include "Math/QuatStream.h"
+#include "Math/Vec3Stream.h"
+
+namespace Rt2::Math
+{
+    enum TrackType
+    {
+        TT_REAL = 0,
+        TT_VEC3,
+        TT_QUAT,
+        TT_MAX,
+    };
+
+    // How quaternion tracks blend between keys, see Quat::nlerp,
+    // slerp and fastSlerp.
+    enum RotationBlend
+    {
+        RB_NLERP = 0,
+        RB_SLERP,
+        RB_FAST_SLERP,
+    };
+
+    // The sampling state of one animated instance: a key cursor per
+    // track of the clip it was last sampled with, and the sampled values.
+    // Each track writes to its slot in the stream of its type.
+    class AnimationState
+    {
+    private:
+        friend class AnimationClip;
+
+        AlignedArray<uint32_t> _cursor;
+
+        RealArray  _reals;
+        Vec3Stream _vec3s;
+        QuatStream _quats;
+
+        // The bracketing keys and blend factors gathered per sample.
+        RealArray  _ra, _rb, _rt, _vt, _qt;
+        Vec3Stream _va, _vb;
+        QuatStream _qa, _qb;
+
+    public:
+        AnimationState() = default;
+
+        // Forgets the cursors, for when time jumps far back.
+        void reset();
+
+        Real real(size_t slot) const;
+
+        Vec3 vec3(size_t slot) const;
+
+        Quat quat(size_t slot) const;
+
+        const RealArray& reals() const;
+
+        const Vec3Stream& vec3s() const;
+
+        const QuatStream& quats() const;
+    };
+
+    // A set of keyframe tracks sampled together.
+    //
+    // Key times and values of every track are stored back to back, with
+    // one structure of arrays stream per value type, so that sampling
+    // gathers the bracketing keys of all tracks and blends them in one
+    // batch call per type. Time outside a track's keys clamps to its
+    // first or last key.
+    class AnimationClip
+    {
+    public:
+        static constexpr int32_t None = -1;
+
+    private:
+        struct Track
+        {
+            TrackType type;
+            uint32_t  time;
+            uint32_t  key;
+            uint32_t  count;
+            uint32_t  slot;
+        };
+
+        AlignedArray<Track> _tracks;
+        RealArray           _times;
+        RealArray           _realKeys;
+        Vec3Stream          _vec3Keys;
+        QuatStream          _quatKeys;
+        uint32_t            _slots[TT_MAX]{};
+        Real                _duration{0};
+        RotationBlend       _blend{RB_FAST_SLERP};
+
+    public:
+        AnimationClip() = default;
+
+        void clear();
+
+        // Appends a track of n keys and returns its slot in the sampled
+        // stream of its type. Returns None when n is zero or times are
+        // not strictly increasing.
+        int32_t addTrack(const Real* times, const Real* keys, size_t n);
+
+        int32_t addTrack(const Real* times, const Vec3* keys, size_t n);
+
+        int32_t addTrack(const Real* times, const Quat* keys, size_t n);
+
+        void setRotationBlend(RotationBlend blend);
+
+        RotationBlend rotationBlend() const;
+
+        size_t tracks() const;
+
+        size_t tracks(TrackType type) const;
+
+        // The largest key time of any track.
+        Real duration() const;
+
+        // Samples every track at time into state. When time only moves
+        // forward between calls, finding the keys costs O(1) per track.
+        void sample(AnimationState& state, Real time) const;
+
+        // Samples states[i] at times[i], with the states split between
+        // the given number of threads, the caller included.
+        void sample(AnimationState* states, const Real* times, size_t n, unsigned workers = 1) const;
+
+    private:
+        int32_t addTimes(TrackType type, const Real* times, size_t n, size_t key);
+    };
+
+    inline void AnimationState::reset()
+    {
+        _cursor.clear();
+    }
+
+    inline Real AnimationState::real(const size_t slot) const
+    {
+        return _reals[slot];
+    }
+
+    inline Vec3 AnimationState::vec3(const size_t slot) const
+    {
+        return _vec3s.at(slot);
+    }
+
+    inline Quat AnimationState::quat(const size_t slot) const
+    {
+        return _quats.at(slot);
+    }
+
+    inline const RealArray& AnimationState::reals() const
+    {
+        return _reals;
+    }
+
+    inline const Vec3Stream& AnimationState::vec3s() const
+    {
+        return _vec3s;
+    }
+
+    inline const QuatStream& AnimationState::quats() const
+    {
+        return _quats;
+    }
+
+    inline void AnimationClip::setRotationBlend(const RotationBlend blend)
+    {
+        _blend = blend;
+    }
+
+    inline RotationBlend AnimationClip::rotationBlend() const
+    {
+        return _blend;
+    }
+
+    inline size_t AnimationClip::tracks() const
+    {
+        return _tracks.size();
+    }
+
+    inline size_t AnimationClip::tracks(const TrackType type) const
+    {
+        return _slots[type];
+    }
+
+    inline Real AnimationClip::duration() const
+    {
+        return _duration;
+    }
+
+}  // namespace Rt2::Math
@@ -0,0 +1,80 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Rt2::Math
+{
+    // Blocks each of count threads in wait until all of them have
+    // reached it, then releases them together. Reusable.
+    class Barrier
+    {
+    private:
+        std::mutex              _mutex;
+        std::condition_variable _cond;
+        const size_t            _count;
+        size_t                  _waiting{0};
+        size_t                  _generation{0};
+
+    public:
+        explicit Barrier(const size_t count) :
+            _count(count)
+        {
+        }
+
+        void wait()
+        {
+            std::unique_lock lock(_mutex);
+
+            const size_t gen = _generation;
+            if (++_waiting == _count)
+            {
+                _waiting = 0;
+                ++_generation;
+                _cond.notify_all();
+            }
+            else
+                _cond.wait(lock, [&] { return gen != _generation; });
+        }
+    };
+
+    // Calls fn(w) for every w in [0, workers), w = 0 on the calling
+    // thread and the others on threads of their own, and returns once
+    // all of them have.
+    template <typename Fn>
+    void parallel(const unsigned workers, const Fn& fn)
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(workers > 1 ? workers - 1 : 0);
+        for (unsigned w = 1; w < workers; ++w)
+            threads.emplace_back([&fn, w] { fn(w); });
+        fn(0);
+
+        for (std::thread& t : threads)
+            t.join();
+    }
+
+}  // namespace Rt2::Math
@@ -23,7 +23,50 @@
 
 namespace Rt2::Math
 {
-    Box3d::Box3d(const Real mi[3], const Real ma[3])
+    namespace
+    {
+        // The face normal of box at dest.point.
+        template <typename T>
+        void hitNormal(RayHitTest& dest, const TBox3d<T>& box)
+        {
+            const TVec3<T> p1 = TVec3<T>(dest.point) - box.center();
+            const TVec3<T> p2 = box.extent() * T(0.5);
+            const TVec3<T> p3 = p1 / p2;
+            const TVec3<T> p4 = p3.abs();
+            const T        m3 = p4.max3();
+            dest.normal       = {0, 0, 0};
+            if (eq<T>(m3, p4.x))
+                dest.normal.x = sign<T>(p3.x);
+            else if (eq<T>(m3, p4.y))
+                dest.normal.y = sign<T>(p3.y);
+            else
+                dest.normal.z = sign<T>(p3.z);
+        }
+
+        // Narrows [r0, r1] to the span of ray inside box.
+        template <typename T>
+        void slabs(T& r0, T& r1, const TBox3d<T>& box, const PreparedRay& ray)
+        {
+            const T* bounds[2] = {box.bMin, box.bMax};
+
+            const Real* op = ray.origin.ptr();
+            const Real* ip = ray.invDir.ptr();
+            for (int i = 0; i < 3; ++i)
+            {
+                const int s = ray.sign[i];
+                const T   o = T(op[i]), d = T(ip[i]);
+
+                const T t0 = (bounds[s][i] - o) * d;
+                const T t1 = (bounds[1 - s][i] - o) * d;
+
+                r0 = t0 > r0 ? t0 : r0;
+                r1 = t1 < r1 ? t1 : r1;
+            }
+        }
+    }  // namespace
+
+    template <typename T>
+    TBox3d<T>::TBox3d(const T mi[3], const T ma[3])
     {
         for (int i = 0; i < 3; ++i)
         {
@@ -32,30 +75,33 @@ namespace Rt2::Math
         }
     }
 
-    Box3d::Box3d(const Vec3& extent, const Vec3& center)
+    template <typename T>
+    TBox3d<T>::TBox3d(const TVec3<T>& extent, const TVec3<T>& center)
     {
-        const Real* ep = extent.ptr();
-        const Real* cp = center.ptr();
+        const T* ep = extent.ptr();
+        const T* cp = center.ptr();
 
         for (int i = 0; i < 3; ++i)
         {
-            bMin[i] = cp[i] - ep[i] * Real(0.5);
-            bMax[i] = cp[i] + ep[i] * Real(0.5);
+            bMin[i] = cp[i] - ep[i] * T(0.5);
+            bMax[i] = cp[i] + ep[i] * T(0.5);
         }
     }
 
-    void Box3d::clear()
+    template <typename T>
+    void TBox3d<T>::clear()
     {
         for (int i = 0; i < 3; ++i)
         {
-            bMin[i] = Infinity;
-            bMax[i] = -Infinity;
+            bMin[i] = Limits<T>::Infinity;
+            bMax[i] = -Limits<T>::Infinity;
         }
     }
 
-    void Box3d::compare(const Vec3& pt)
+    template <typename T>
+    void TBox3d<T>::compare(const TVec3<T>& pt)
     {
-        const Real* ep = pt.ptr();
+        const T* ep = pt.ptr();
         for (int i = 0; i < 3; ++i)
         {
             if (ep[i] < bMin[i])
@@ -65,7 +111,8 @@ namespace Rt2::Math
         }
     }
 
-    void Box3d::compare(const Real* pt)
+    template <typename T>
+    void TBox3d<T>::compare(const T* pt)
     {
         for (int i = 0; i < 3; ++i)
         {
@@ -76,13 +123,15 @@ namespace Rt2::Math
         }
     }
 
-    void Box3d::merge(const Box3d& bb)
+    template <typename T>
+    void TBox3d<T>::merge(const TBox3d& bb)
     {
         compare(bb.bMin);
         compare(bb.bMax);
     }
 
-    void Box3d::scale(const Real& sc)
+    template <typename T>
+    void TBox3d<T>::scale(const T& sc)
     {
         for (int i = 0; i < 3; ++i)
         {
@@ -91,9 +140,10 @@ namespace Rt2::Math
         }
     }
 
-    void Box3d::translate(const Vec3& pt)
+    template <typename T>
+    void TBox3d<T>::translate(const TVec3<T>& pt)
     {
-        const Real* ep = pt.ptr();
+        const T* ep = pt.ptr();
 
         for (int i = 0; i < 3; ++i)
         {
@@ -102,25 +152,28 @@ namespace Rt2::Math
         }
     }
 
-    void Box3d::setMin(const Vec3& mi)
+    template <typename T>
+    void TBox3d<T>::setMin(const TVec3<T>& mi)
     {
         bMin[0] = mi.x;
         bMin[1] = mi.y;
         bMin[2] = mi.z;
     }
 
-    void Box3d::setMax(const Vec3& ma)
+    template <typename T>
+    void TBox3d<T>::setMax(const TVec3<T>& ma)
     {
         bMax[0] = ma.x;
         bMax[1] = ma.y;
         bMax[2] = ma.z;
     }
 
-    Real Box3d::signedLength() const
+    template <typename T>
+    T TBox3d<T>::signedLength() const
     {
-        const Vec3 c = center();
+        const TVec3<T> c = center();
 
-        Real sign = 1;
+        T sign = 1;
         if (c.x < 0)
             sign *= -1;
         if (c.y < 0)
@@ -130,54 +183,71 @@ namespace Rt2::Math
         return sign * c.length();
     }
 
-    bool Box3d::contains(const Box3d& bb) const
+    template <typename T>
+    bool TBox3d<T>::contains(const TBox3d& bb) const
     {
-        const Vec3 tmi = min();
-        const Vec3 tma = max();
-        const Vec3 bmi = bb.min();
-        const Vec3 bma = bb.max();
+        const TVec3<T> tmi = min();
+        const TVec3<T> tma = max();
+        const TVec3<T> bmi = bb.min();
+        const TVec3<T> bma = bb.max();
 
-        bool res = bmi.x >= tmi.x && bmi.y >= tmi.y && bmi.x >= tmi.z;
+        bool res = bmi.x >= tmi.x && bmi.y >= tmi.y && bmi.z >= tmi.z;
         if (res)
-            res = bma.x <= tma.x && bma.y <= tma.y && bma.x <= tma.z;
+            res = bma.x <= tma.x && bma.y <= tma.y && bma.z <= tma.z;
         return res;
     }
 
-    void Box3d::majorAxis(Vec3& dest, const Vec3& src)
+    template <typename T>
+    bool TBox3d<T>::overlaps(const TBox3d& bb) const
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            if (bb.bMin[i] > bMax[i] || bb.bMax[i] < bMin[i])
+                return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    void TBox3d<T>::majorAxis(TVec3<T>& dest, const TVec3<T>& src)
     {
-        const Real m = Max3(src.x, src.y, src.z);
+        const T m = Max3<T>(src.x, src.y, src.z);
 
-        if (eq(m, src.x))
-            dest = Vec3::UnitX;
-        else if (eq(m, src.y))
-            dest = Vec3::UnitY;
+        if (eq<T>(m, src.x))
+            dest = TVec3<T>::UnitX;
+        else if (eq<T>(m, src.y))
+            dest = TVec3<T>::UnitY;
         else
-            dest = Vec3::UnitZ;
+            dest = TVec3<T>::UnitZ;
         if (m < 0)
             dest *= -1;
     }
 
-    bool Box3d::hit(const Ray& ray, const Vec2& limit) const
+    template <typename T>
+    bool TBox3d<T>::hit(const Ray& ray, const Vec2& limit) const
     {
-        const Real* origP = ray.origin.ptr();
-        const Real* dirP  = ray.direction.ptr();
+        const TVec3<T> origin(ray.origin);
+        const TVec3<T> direction(ray.direction);
 
-        Real tMin = limit.x;
-        Real tMax = limit.y;
+        const T* origP = origin.ptr();
+        const T* dirP  = direction.ptr();
+
+        T tMin = T(limit.x);
+        T tMax = T(limit.y);
 
         for (int i = 0; i < 3; ++i)
         {
-            Real t0 = 0, t1 = 0;
-            if (!eq(dirP[i], 0))
+            T t0 = 0, t1 = 0;
+            if (!eq<T>(dirP[i], 0))
             {
-                const Real t2 = 1 / dirP[i];
+                const T t2 = 1 / dirP[i];
 
                 t0 = (bMin[i] - origP[i]) * t2;
                 t1 = (bMax[i] - origP[i]) * t2;
 
-                if (t2 < Real(0.0))
+                if (t2 < T(0.0))
                 {
-                    const Real t = t0;
+                    const T t = t0;
 
                     t0 = t1;
                     t1 = t;
@@ -192,27 +262,31 @@ namespace Rt2::Math
         return true;
     }
 
-    bool Box3d::hit(Real& r0, Real& r1, const Ray& ray, const Vec2& limit) const
+    template <typename T>
+    bool TBox3d<T>::hit(T& r0, T& r1, const Ray& ray, const Vec2& limit) const
     {
-        const Real* origP = ray.origin.ptr();
-        const Real* dirP  = ray.direction.ptr();
+        const TVec3<T> origin(ray.origin);
+        const TVec3<T> direction(ray.direction);
+
+        const T* origP = origin.ptr();
+        const T* dirP  = direction.ptr();
 
-        r0 = limit.x;
-        r1 = limit.y;
+        r0 = T(limit.x);
+        r1 = T(limit.y);
 
         for (int i = 0; i < 3; ++i)
         {
-            Real t0 = 0, t1 = 0;
-            if (!eq(dirP[i], 0))
+            T t0 = 0, t1 = 0;
+            if (!eq<T>(dirP[i], 0))
             {
-                const Real t2 = 1 / dirP[i];
+                const T t2 = 1 / dirP[i];
 
                 t0 = (bMin[i] - origP[i]) * t2;
                 t1 = (bMax[i] - origP[i]) * t2;
 
-                if (t2 < Real(0.0))
+                if (t2 < T(0.0))
                 {
-                    const Real t = t0;
+                    const T t = t0;
 
                     t0 = t1;
                     t1 = t;
@@ -227,28 +301,32 @@ namespace Rt2::Math
         return true;
     }
 
-    bool Box3d::hit(RayHitTest& dest, const Ray& ray, const Vec2& limit) const
+    template <typename T>
+    bool TBox3d<T>::hit(RayHitTest& dest, const Ray& ray, const Vec2& limit) const
     {
-        const Real* origP = ray.origin.ptr();
-        const Real* dirP  = ray.direction.ptr();
+        const TVec3<T> origin(ray.origin);
+        const TVec3<T> direction(ray.direction);
+
+        const T* origP = origin.ptr();
+        const T* dirP  = direction.ptr();
 
-        Real tMin = limit.x;
-        Real tMax = limit.y;
+        T tMin = T(limit.x);
+        T tMax = T(limit.y);
 
         for (int i = 0; i < 3; ++i)
         {
-            Real t0 = 0, t1 = 0;
+            T t0 = 0, t1 = 0;
 
-            if (!eq(dirP[i], 0))
+            if (!eq<T>(dirP[i], 0))
             {
-                const Real t2 = 1 / dirP[i];
+                const T t2 = 1 / dirP[i];
 
                 t0 = (bMin[i] - origP[i]) * t2;
                 t1 = (bMax[i] - origP[i]) * t2;
 
-                if (t2 < Real(0.0))
+                if (t2 < T(0.0))
                 {
-                    const Real t = t0;
+                    const T t = t0;
 
                     t0 = t1;
                     t1 = t;
@@ -263,20 +341,47 @@ namespace Rt2::Math
 
         dest.distance = tMin;
         dest.point    = ray.at(tMin);
+        hitNormal(dest, *this);
+        return true;
+    }
 
-        const Vec3 p1 = dest.point - center();
-        const Vec3 p2 = extent() * Real(0.5);
-        const Vec3 p3 = p1 / p2;
-        const Vec3 p4 = p3.abs();
-        const Real  m3 = p4.max3();
-        dest.normal        = {0, 0, 0};
-        if (eq(m3, p4.x))
-            dest.normal.x = sign(p3.x);
-        else if (eq(m3, p4.y))
-            dest.normal.y = sign(p3.y);
-        else
-            dest.normal.z = sign(p3.z);
+    template <typename T>
+    bool TBox3d<T>::hit(const PreparedRay& ray, const Vec2& limit) const
+    {
+        T tMin = T(limit.x);
+        T tMax = T(limit.y);
+
+        slabs(tMin, tMax, *this, ray);
+        return tMax > tMin;
+    }
+
+    template <typename T>
+    bool TBox3d<T>::hit(T& r0, T& r1, const PreparedRay& ray, const Vec2& limit) const
+    {
+        r0 = T(limit.x);
+        r1 = T(limit.y);
+
+        slabs(r0, r1, *this, ray);
+        return r1 >= r0;
+    }
+
+    template <typename T>
+    bool TBox3d<T>::hit(RayHitTest& dest, const PreparedRay& ray, const Vec2& limit) const
+    {
+        T tMin = T(limit.x);
+        T tMax = T(limit.y);
+
+        slabs(tMin, tMax, *this, ray);
+        if (tMax <= tMin)
+            return false;
+
+        dest.distance = tMin;
+        dest.point    = ray.at(tMin);
+        hitNormal(dest, *this);
         return true;
     }
 
+    template class TBox3d<float>;
+    template class TBox3d<double>;
+
 }  // namespace Rt2::Math
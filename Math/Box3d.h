@@ -22,6 +22,7 @@
 #pragma once
 
 #include <algorithm>
+#include "Math/Forward.h"
 #include "Math/Math.h"
 #include "Math/Ray.h"
 #include "Math/Vec2.h"
@@ -29,129 +30,154 @@
 
 namespace Rt2::Math
 {
-    class Box3d
+    template <typename T>
+    class TBox3d
     {
     public:
-        Real bMin[3]{};
-        Real bMax[3]{};
+        T bMin[3]{};
+        T bMax[3]{};
 
     public:
-        Box3d();
+        TBox3d();
 
-        Box3d(const Real mi[3], const Real ma[3]);
+        TBox3d(const T mi[3], const T ma[3]);
 
-        Box3d(const Vec3& extent, const Vec3& center);
+        TBox3d(const TVec3<T>& extent, const TVec3<T>& center);
 
         void clear();
 
-        void compare(const Vec3& pt);
+        void compare(const TVec3<T>& pt);
 
-        void compare(const Real* pt);
+        void compare(const T* pt);
 
-        void merge(const Box3d& bb);
+        void merge(const TBox3d& bb);
 
-        void scale(const Real& sc);
+        void scale(const T& sc);
 
-        void translate(const Vec3& pt);
+        void translate(const TVec3<T>& pt);
 
-        void setMin(const Vec3& mi);
+        void setMin(const TVec3<T>& mi);
 
-        void setMax(const Vec3& ma);
+        void setMax(const TVec3<T>& ma);
 
-        Real signedLength() const;
+        T signedLength() const;
 
-        bool contains(const Box3d& bb) const;
+        bool contains(const TBox3d& bb) const;
 
-        static void majorAxis(Vec3& dest, const Vec3& src);
+        // True when the two boxes share at least a point.
+        bool overlaps(const TBox3d& bb) const;
+
+        static void majorAxis(TVec3<T>& dest, const TVec3<T>& src);
 
         bool hit(const Ray& ray, const Vec2& limit) const;
 
-        bool hit(Real& r0, Real& r1, const Ray& ray, const Vec2& limit) const;
+        bool hit(T& r0, T& r1, const Ray& ray, const Vec2& limit) const;
 
         bool hit(RayHitTest& dest, const Ray& ray, const Vec2& limit) const;
 
-        Vec3 min() const;
+        // The same tests from a PreparedRay, without divisions or
+        // branches per axis. Unlike the Ray forms, a ray parallel to a
+        // slab hits when its origin lies inside that slab.
+        bool hit(const PreparedRay& ray, const Vec2& limit) const;
+
+        bool hit(T& r0, T& r1, const PreparedRay& ray, const Vec2& limit) const;
+
+        bool hit(RayHitTest& dest, const PreparedRay& ray, const Vec2& limit) const;
+
+        TVec3<T> min() const;
 
-        Vec3 max() const;
+        TVec3<T> max() const;
 
-        Vec3 extent() const;
+        TVec3<T> extent() const;
 
-        Real halfLength2() const;
+        T halfLength2() const;
 
-        Real halfLength() const;
+        T halfLength() const;
 
-        Real max3() const;
+        T max3() const;
 
-        Real min3() const;
+        T min3() const;
 
-        Vec3 center() const;
+        TVec3<T> center() const;
 
-        Real length() const;
+        T length() const;
 
-        Real length2() const;
+        T length2() const;
 
-        bool less(const Box3d& bb) const;
+        bool less(const TBox3d& bb) const;
     };
 
-    inline Box3d::Box3d()
+    template <typename T>
+    inline TBox3d<T>::TBox3d()
     {
         clear();
     }
 
-    inline Vec3 Box3d::min() const
+    template <typename T>
+    inline TVec3<T> TBox3d<T>::min() const
     {
         return {bMin[0], bMin[1], bMin[2]};
     }
 
-    inline Vec3 Box3d::max() const
+    template <typename T>
+    inline TVec3<T> TBox3d<T>::max() const
     {
         return {bMax[0], bMax[1], bMax[2]};
     }
 
-    inline Vec3 Box3d::extent() const
+    template <typename T>
+    inline TVec3<T> TBox3d<T>::extent() const
     {
         return {bMax[0] - bMin[0], bMax[1] - bMin[1], bMax[2] - bMin[2]};
     }
 
-    inline Real Box3d::halfLength2() const
+    template <typename T>
+    inline T TBox3d<T>::halfLength2() const
     {
-        return extent().length2() * Real(0.5);
+        return extent().length2() * T(0.5);
     }
 
-    inline Real Box3d::halfLength() const
+    template <typename T>
+    inline T TBox3d<T>::halfLength() const
     {
-        return extent().length() * Real(0.5);
+        return extent().length() * T(0.5);
     }
 
-    inline Real Box3d::max3() const
+    template <typename T>
+    inline T TBox3d<T>::max3() const
     {
         return std::max(bMax[0], std::max(bMax[1], bMax[2]));
     }
 
-    inline Real Box3d::min3() const
+    template <typename T>
+    inline T TBox3d<T>::min3() const
     {
         return std::min(bMin[0], std::min(bMin[1], bMin[2]));
     }
 
-    inline Vec3 Box3d::center() const
+    template <typename T>
+    inline TVec3<T> TBox3d<T>::center() const
     {
         return {
-            Real(0.5) * (bMax[0] + bMin[0]),
-            Real(0.5) * (bMax[1] + bMin[1]),
-            Real(0.5) * (bMax[2] + bMin[2])};
+            T(0.5) * (bMax[0] + bMin[0]),
+            T(0.5) * (bMax[1] + bMin[1]),
+            T(0.5) * (bMax[2] + bMin[2])};
     }
 
-    inline Real Box3d::length() const
+    template <typename T>
+    inline T TBox3d<T>::length() const
     {
         return extent().length();
     }
 
-    inline Real Box3d::length2() const
+    template <typename T>
+    inline T TBox3d<T>::length2() const
     {
         return extent().length();
     }
 
-    inline bool Box3d::less(const Box3d& bb) const
+    template <typename T>
+    inline bool TBox3d<T>::less(const TBox3d& bb) const
     {
         return signedLength() < bb.signedLength();
     }
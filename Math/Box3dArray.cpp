@@ -0,0 +1,128 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Box3dArray.h"
+#include "Math/Dispatch.h"
+
+namespace Rt2::Math
+{
+    namespace
+    {
+        Box3dIn in(const Box3dArray& s, const size_t first = 0)
+        {
+            return {
+                {s.min(0) + first, s.min(1) + first, s.min(2) + first},
+                {s.max(0) + first, s.max(1) + first, s.max(2) + first},
+            };
+        }
+    }  // namespace
+
+    Box3dArray::Box3dArray(const size_t size)
+    {
+        resize(size);
+    }
+
+    Box3dArray::Box3dArray(const Box3d* src, const size_t size)
+    {
+        assign(src, size);
+    }
+
+    void Box3dArray::reserve(const size_t size)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            _min[j].reserve(size);
+            _max[j].reserve(size);
+        }
+    }
+
+    void Box3dArray::resize(const size_t size)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            _min[j].resize(size);
+            _max[j].resize(size);
+        }
+    }
+
+    void Box3dArray::clear()
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            _min[j].clear();
+            _max[j].clear();
+        }
+    }
+
+    void Box3dArray::push(const Box3d& b)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            _min[j].push_back(b.bMin[j]);
+            _max[j].push_back(b.bMax[j]);
+        }
+    }
+
+    void Box3dArray::assign(const Box3d* src, const size_t size)
+    {
+        resize(size);
+        if (src)
+        {
+            for (size_t i = 0; i < size; ++i)
+                set(i, src[i]);
+        }
+    }
+
+    void Box3dArray::copy(Box3d* dest) const
+    {
+        if (dest)
+        {
+            const size_t n = size();
+            for (size_t i = 0; i < n; ++i)
+                dest[i] = at(i);
+        }
+    }
+
+    void Box3dArray::hit(uint32_t* mask, Real* distance, const PreparedRay& ray, const Vec2& limit) const
+    {
+        Dispatch::kernels().box3dHit(mask, distance, in(*this), ray.origin.ptr(), ray.invDir.ptr(), ray.sign, limit.x, limit.y, size());
+    }
+
+    void Box3dArray::contains(uint32_t* mask, const Box3d& query) const
+    {
+        Dispatch::kernels().box3dContains(mask, in(*this), query.bMin, query.bMax, size());
+    }
+
+    void Box3dArray::overlaps(uint32_t* mask, const Box3d& query) const
+    {
+        Dispatch::kernels().box3dOverlaps(mask, in(*this), query.bMin, query.bMax, size());
+    }
+
+    Box3d Box3dArray::merge(const size_t first, const size_t count) const
+    {
+        Box3d r;
+        r.clear();
+        if (count > 0)
+            Dispatch::kernels().box3dBounds(r.bMin, r.bMax, in(*this, first), count);
+        return r;
+    }
+
+}  // namespace Rt2::Math
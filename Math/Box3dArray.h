@@ -0,0 +1,138 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstdint>
+#include "Math/Box3d.h"
+#include "Math/Vec3Stream.h"
+
+namespace Rt2::Math
+{
+    // Structure of arrays storage for Box3d, one array per bound and
+    // axis, so that a query is tested against a full SIMD register of
+    // boxes per instruction.
+    //
+    // The mask forms write bit i % 32 of word i / 32 for box i, to
+    // (size() + 31) / 32 words, as Frustum::cull does.
+    class Box3dArray
+    {
+    private:
+        RealArray _min[3], _max[3];
+
+    public:
+        Box3dArray() = default;
+
+        explicit Box3dArray(size_t size);
+
+        Box3dArray(const Box3d* src, size_t size);
+
+        void reserve(size_t size);
+
+        void resize(size_t size);
+
+        void clear();
+
+        void push(const Box3d& b);
+
+        void set(size_t i, const Box3d& b);
+
+        Box3d at(size_t i) const;
+
+        void assign(const Box3d* src, size_t size);
+
+        void copy(Box3d* dest) const;
+
+        size_t size() const;
+
+        Real* min(int axis);
+
+        Real* max(int axis);
+
+        const Real* min(int axis) const;
+
+        const Real* max(int axis) const;
+
+        // Box3d::hit(r0, r1, ray, limit) for every box. When distance is
+        // not null, distance[i] receives r0, the entry distance, which
+        // is only meaningful for the boxes that hit.
+        void hit(uint32_t* mask, Real* distance, const PreparedRay& ray, const Vec2& limit) const;
+
+        // Box3d::contains(query) for every box.
+        void contains(uint32_t* mask, const Box3d& query) const;
+
+        // Box3d::overlaps(query) for every box.
+        void overlaps(uint32_t* mask, const Box3d& query) const;
+
+        // The merge of the boxes in [first, first + count), or of every
+        // box. Empty ranges give a cleared box.
+        Box3d merge(size_t first, size_t count) const;
+
+        Box3d merge() const;
+    };
+
+    inline size_t Box3dArray::size() const
+    {
+        return _min[0].size();
+    }
+
+    inline Real* Box3dArray::min(const int axis)
+    {
+        return _min[axis].data();
+    }
+
+    inline Real* Box3dArray::max(const int axis)
+    {
+        return _max[axis].data();
+    }
+
+    inline const Real* Box3dArray::min(const int axis) const
+    {
+        return _min[axis].data();
+    }
+
+    inline const Real* Box3dArray::max(const int axis) const
+    {
+        return _max[axis].data();
+    }
+
+    inline void Box3dArray::set(const size_t i, const Box3d& b)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            _min[j][i] = b.bMin[j];
+            _max[j][i] = b.bMax[j];
+        }
+    }
+
+    inline Box3d Box3dArray::at(const size_t i) const
+    {
+        const Real mi[3] = {_min[0][i], _min[1][i], _min[2][i]};
+        const Real ma[3] = {_max[0][i], _max[1][i], _max[2][i]};
+        return {mi, ma};
+    }
+
+    inline Box3d Box3dArray::merge() const
+    {
+        return merge(0, size());
+    }
+
+}  // namespace Rt2::Math
@@ -0,0 +1,1391 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Bvh.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include "Math/Barrier.h"
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace Rt2::Math
+{
+    namespace
+    {
+        static_assert(sizeof(BvhNode) == 32);
+
+        // Bins per axis for the split search.
+        constexpr uint32_t Bins = 16;
+
+        // The cost of visiting a node, relative to testing a primitive.
+        constexpr Real TraversalCost = 1;
+
+        // Past this depth, build splits at the median so that every
+        // level halves the primitives and the tree stays within
+        // Bvh::MaxDepth.
+        constexpr uint32_t MedianDepth = Bvh::MaxDepth - 34;
+
+        float lower(const Real v)
+        {
+            float f = (float)v;
+            if ((Real)f > v)
+                f = std::nextafter(f, -Limits<float>::Infinity);
+            return f;
+        }
+
+        float upper(const Real v)
+        {
+            float f = (float)v;
+            if ((Real)f < v)
+                f = std::nextafter(f, Limits<float>::Infinity);
+            return f;
+        }
+
+        // Box3d without its out of line members, for the build loops.
+        struct Bounds
+        {
+            Real bMin[3]{Limits<Real>::Infinity, Limits<Real>::Infinity, Limits<Real>::Infinity};
+            Real bMax[3]{-Limits<Real>::Infinity, -Limits<Real>::Infinity, -Limits<Real>::Infinity};
+        };
+
+        Box3df outwards(const Bounds& b)
+        {
+            Box3df r;
+            for (int i = 0; i < 3; ++i)
+            {
+                r.bMin[i] = lower(b.bMin[i]);
+                r.bMax[i] = upper(b.bMax[i]);
+            }
+            return r;
+        }
+
+        template <typename B>
+        void grow(Bounds& a, const B& b)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                a.bMin[i] = b.bMin[i] < a.bMin[i] ? b.bMin[i] : a.bMin[i];
+                a.bMax[i] = b.bMax[i] > a.bMax[i] ? b.bMax[i] : a.bMax[i];
+            }
+        }
+
+        void grow(Bounds& a, const Vec3& p)
+        {
+            const Real* pp = p.ptr();
+            for (int i = 0; i < 3; ++i)
+            {
+                a.bMin[i] = pp[i] < a.bMin[i] ? pp[i] : a.bMin[i];
+                a.bMax[i] = pp[i] > a.bMax[i] ? pp[i] : a.bMax[i];
+            }
+        }
+
+        Box3df merged(const Box3df& a, const Box3df& b)
+        {
+            Box3df r;
+            for (int i = 0; i < 3; ++i)
+            {
+                r.bMin[i] = std::min(a.bMin[i], b.bMin[i]);
+                r.bMax[i] = std::max(a.bMax[i], b.bMax[i]);
+            }
+            return r;
+        }
+
+        // Half the surface area, zero for a cleared box.
+        template <typename B>
+        Real area(const B& b)
+        {
+            const Real x = Real(b.bMax[0] - b.bMin[0]);
+            const Real y = Real(b.bMax[1] - b.bMin[1]);
+            const Real z = Real(b.bMax[2] - b.bMin[2]);
+            if (x < 0 || y < 0 || z < 0)
+                return 0;
+            return x * y + y * z + z * x;
+        }
+
+        // The slab test of Box3d::hit(r0, r1, ray, limit) against a
+        // node, giving the entry distance.
+        bool enter(Real& r0, const Box3df& b, const PreparedRay& ray, const Real tNear, const Real tFar)
+        {
+            const Real* op = ray.origin.ptr();
+            const Real* ip = ray.invDir.ptr();
+
+            Real r1 = tFar;
+            r0      = tNear;
+            for (int i = 0; i < 3; ++i)
+            {
+                const int  s  = ray.sign[i];
+                const Real t0 = (Real(s ? b.bMax[i] : b.bMin[i]) - op[i]) * ip[i];
+                const Real t1 = (Real(s ? b.bMin[i] : b.bMax[i]) - op[i]) * ip[i];
+
+                r0 = t0 > r0 ? t0 : r0;
+                r1 = t1 < r1 ? t1 : r1;
+            }
+            return r1 >= r0;
+        }
+
+        template <typename T>
+        bool overlap(const TBox3d<T>& b, const Box3d& q)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                if (q.bMin[i] > Real(b.bMax[i]) || q.bMax[i] < Real(b.bMin[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        template <typename T>
+        bool overlap(const TBox3d<T>& b, const Sphere& q)
+        {
+            const Real* cp = q.center.ptr();
+
+            Real d2 = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                const Real d = cp[i] - clamp<Real>(cp[i], Real(b.bMin[i]), Real(b.bMax[i]));
+                d2 += d * d;
+            }
+            return d2 <= q.radius * q.radius;
+        }
+
+        // Primitive bounds and centers of a group.
+        struct Span
+        {
+            Bounds bounds, centers;
+
+            void add(const Box3d& b, const Vec3& c)
+            {
+                grow(bounds, b);
+                grow(centers, c);
+            }
+        };
+
+        struct Bin
+        {
+            Bounds   bounds;
+            uint32_t count{0};
+        };
+
+        // Top down binned SAH build, after Wald, "On fast Construction
+        // of SAH-based Bounding Volume Hierarchies". Every node bins
+        // its primitives on the three axes in one pass, and passes the
+        // bounds of each half down with the half.
+        class SahBuilder
+        {
+        private:
+            struct Item
+            {
+                uint32_t node, begin, end, depth;
+                Span     span;
+            };
+
+            // The primitives are partitioned by value rather than by
+            // id, which keeps the passes over deep nodes in cache.
+            struct Ref
+            {
+                Box3d    bounds;
+                Vec3     center;
+                uint32_t id;
+            };
+
+            AlignedArray<BvhNode>& _nodes;
+            AlignedArray<Ref>      _refs;
+
+        public:
+            explicit SahBuilder(AlignedArray<BvhNode>& nodes) :
+                _nodes(nodes)
+            {
+            }
+
+            // Builds the subtree of node over the n primitive ids in
+            // prims, which it reorders into leaf order. The leaves
+            // reference prims from offset and the subtree starts at the
+            // given depth. The nodes below node are appended.
+            void build(const uint32_t node, uint32_t* prims, const Box3d* bounds, const uint32_t offset, const uint32_t n, const uint32_t depth)
+            {
+                _refs.resize(n);
+                for (uint32_t i = 0; i < n; ++i)
+                    _refs[i] = {bounds[prims[i]], bounds[prims[i]].center(), prims[i]};
+
+                std::vector<Item> stack;
+                stack.push_back({node, 0, n, depth, measure(0, n)});
+
+                while (!stack.empty())
+                {
+                    const Item it = stack.back();
+                    stack.pop_back();
+
+                    BvhNode& nd = _nodes[it.node];
+                    nd.bounds   = outwards(it.span.bounds);
+                    nd.first    = offset + it.begin;
+                    nd.count    = it.end - it.begin;
+
+                    Span           left, right;
+                    const uint32_t mid = split(left, right, it);
+                    if (mid == it.begin)
+                        continue;
+
+                    const uint32_t c = (uint32_t)_nodes.size();
+                    _nodes.resize(c + 2);
+                    _nodes[it.node].first = c;
+                    _nodes[it.node].count = 0;
+
+                    // Right first, so that the left subtree is laid
+                    // out next.
+                    stack.push_back({c + 1, mid, it.end, it.depth + 1, right});
+                    stack.push_back({c, it.begin, mid, it.depth + 1, left});
+                }
+
+                for (uint32_t i = 0; i < n; ++i)
+                    prims[i] = _refs[i].id;
+            }
+
+        private:
+            Span measure(const uint32_t begin, const uint32_t end) const
+            {
+                Span s;
+                for (uint32_t i = begin; i < end; ++i)
+                    s.add(_refs[i].bounds, _refs[i].center);
+                return s;
+            }
+
+            static uint32_t binOf(const Real c, const Real lo, const Real scale)
+            {
+                const Real b = (c - lo) * scale;
+                return b < Real(Bins - 1) ? (uint32_t)b : Bins - 1;
+            }
+
+            // Partitions the item's primitives, returning the start of
+            // the right half, or begin when the node stays a leaf.
+            uint32_t split(Span& left, Span& right, const Item& it)
+            {
+                const uint32_t n = it.end - it.begin;
+                if (n <= 1)
+                    return it.begin;
+                if (it.depth >= MedianDepth)
+                    return median(left, right, it);
+
+                const Bounds& cb = it.span.centers;
+
+                Real lo[3], scale[3];
+                for (int a = 0; a < 3; ++a)
+                {
+                    const Real ext = cb.bMax[a] - cb.bMin[a];
+                    lo[a]          = cb.bMin[a];
+                    scale[a]       = ext > Limits<Real>::Epsilon ? Real(Bins) / ext : 0;
+                }
+
+                Bin bins[3][Bins];
+                for (uint32_t i = it.begin; i < it.end; ++i)
+                {
+                    const Ref&  r  = _refs[i];
+                    const Real* cp = r.center.ptr();
+                    for (int a = 0; a < 3; ++a)
+                    {
+                        Bin& b = bins[a][binOf(cp[a], lo[a], scale[a])];
+                        grow(b.bounds, r.bounds);
+                        ++b.count;
+                    }
+                }
+
+                int      axis = -1;
+                uint32_t bin  = 0;
+                Real     best = Limits<Real>::Infinity;
+                for (int a = 0; a < 3; ++a)
+                {
+                    if (scale[a] == 0)
+                        continue;
+
+                    // Right to left sweep, the costs of the right sides.
+                    // Empty bins leave the sides unchanged.
+                    Real     cost[Bins];
+                    Bounds   acc;
+                    uint32_t count = 0;
+                    for (uint32_t b = Bins - 1; b > 0; --b)
+                    {
+                        if (const Bin& bs = bins[a][b]; bs.count > 0)
+                        {
+                            grow(acc, bs.bounds);
+                            count += bs.count;
+                        }
+                        cost[b] = area(acc) * Real(count);
+                    }
+
+                    acc   = Bounds();
+                    count = 0;
+                    for (uint32_t b = 1; b < Bins; ++b)
+                    {
+                        const Bin& bs = bins[a][b - 1];
+                        if (bs.count == 0)
+                            continue;
+
+                        grow(acc, bs.bounds);
+                        count += bs.count;
+                        if (count == n)
+                            break;
+
+                        const Real c = area(acc) * Real(count) + cost[b];
+                        if (c < best)
+                        {
+                            best = c;
+                            axis = a;
+                            bin  = b;
+                        }
+                    }
+                }
+
+                if (axis < 0)
+                    return n <= Bvh::MaxLeafSize ? it.begin : median(left, right, it);
+
+                // Both costs are relative to testing one primitive of
+                // this node.
+                const Real leafCost  = Real(n);
+                const Real splitCost = TraversalCost + best / area(it.span.bounds);
+                if (n <= Bvh::MaxLeafSize && leafCost <= splitCost)
+                    return it.begin;
+
+                const Ref* mid = std::partition(
+                    _refs.data() + it.begin,
+                    _refs.data() + it.end,
+                    [&](const Ref& r)
+                    { return binOf(r.center.ptr()[axis], lo[axis], scale[axis]) < bin; });
+
+                const uint32_t m = (uint32_t)(mid - _refs.data());
+                left             = measure(it.begin, m);
+                right            = measure(m, it.end);
+                return m;
+            }
+
+            // Splits at the median center along the widest axis of the
+            // centers, or in half by order when they coincide.
+            uint32_t median(Span& left, Span& right, const Item& it)
+            {
+                const uint32_t mid = it.begin + (it.end - it.begin) / 2;
+
+                const Bounds& cb = it.span.centers;
+
+                int a = 0;
+                for (int i = 1; i < 3; ++i)
+                {
+                    if (cb.bMax[i] - cb.bMin[i] > cb.bMax[a] - cb.bMin[a])
+                        a = i;
+                }
+
+                std::nth_element(
+                    _refs.data() + it.begin,
+                    _refs.data() + mid,
+                    _refs.data() + it.end,
+                    [&](const Ref& l, const Ref& r)
+                    { return l.center.ptr()[a] < r.center.ptr()[a]; });
+
+                left  = measure(it.begin, mid);
+                right = measure(mid, it.end);
+                return mid;
+            }
+        };
+
+        // Below this many primitives per thread, buildLinear uses fewer
+        // threads.
+        constexpr size_t MinPrimsPerWorker = 4096;
+
+        // Below this many changed leaves per thread, refit uses fewer
+        // threads.
+        constexpr size_t MinLeavesPerWorker = 256;
+
+        // Radix sort digit width.
+        constexpr uint32_t RadixBits = 8;
+        constexpr uint32_t Radix     = 1 << RadixBits;
+
+        int leadingZeros(const uint64_t v)
+        {
+            if (v == 0)
+                return 64;
+#if defined(_MSC_VER)
+            unsigned long i;
+            _BitScanReverse64(&i, v);
+            return 63 - (int)i;
+#else
+            return __builtin_clzll(v);
+#endif
+        }
+
+        // Spaces the low bits of v three apart, for interleaving.
+        uint32_t spread(uint32_t v)
+        {
+            v &= 0x3FF;
+            v = (v | v << 16) & 0x030000FF;
+            v = (v | v << 8) & 0x0300F00F;
+            v = (v | v << 4) & 0x030C30C3;
+            v = (v | v << 2) & 0x09249249;
+            return v;
+        }
+
+        uint64_t spread(uint64_t v)
+        {
+            v &= 0x1FFFFF;
+            v = (v | v << 32) & 0x001F00000000FFFF;
+            v = (v | v << 16) & 0x001F0000FF0000FF;
+            v = (v | v << 8) & 0x100F00F00F00F00F;
+            v = (v | v << 4) & 0x10C30C30C30C30C3;
+            v = (v | v << 2) & 0x1249249249249249;
+            return v;
+        }
+
+        // Builds the tree of Bvh::buildLinear with Morton codes of type
+        // K, 10 bits per axis in 32 bit keys and 21 in 64 bit ones.
+        //
+        // The phases run in one group of threads, with a barrier
+        // between them. The tree stores the children of internal node
+        // k, in Karras' numbering, at 2k + 1 and 2k + 2, so that every
+        // internal node writes its children without knowing where
+        // itself is stored.
+        template <typename K>
+        class LinearBuilder
+        {
+        private:
+            static constexpr uint32_t AxisBits = sizeof(K) == 4 ? 10 : 21;
+            static constexpr uint32_t KeyBits  = 8 * sizeof(K);
+
+            AlignedArray<BvhNode>&  _nodes;
+            AlignedArray<uint32_t>& _prims;
+            const Box3d*            _bounds;
+            const uint32_t          _n;
+            const unsigned          _workers;
+
+            AlignedArray<K>        _keys[2];
+            AlignedArray<uint32_t> _ids[2];
+            AlignedArray<uint32_t> _hist;
+            AlignedArray<Box3d>    _centers;
+
+            // The slots of leaf j and of internal node k, and the
+            // internal node that owns each slot.
+            AlignedArray<uint32_t> _leafSlot;
+            AlignedArray<uint32_t> _slot;
+            AlignedArray<uint32_t> _owner;
+
+            // Children that have reached each internal node in the
+            // bottom up pass.
+            std::vector<std::atomic<uint32_t>> _visits;
+
+            Barrier _barrier;
+
+        public:
+            LinearBuilder(AlignedArray<BvhNode>& nodes, AlignedArray<uint32_t>& prims, const Box3d* bounds, const uint32_t n, const unsigned workers) :
+                _nodes(nodes),
+                _prims(prims),
+                _bounds(bounds),
+                _n(n),
+                _workers(workers),
+                _hist((size_t)workers * Radix),
+                _centers(workers),
+                _leafSlot(n),
+                _slot(n - 1),
+                _owner(2 * (size_t)n - 1),
+                _visits(n - 1),
+                _barrier(workers)
+            {
+                for (int b = 0; b < 2; ++b)
+                {
+                    _keys[b].resize(n);
+                    _ids[b].resize(n);
+                }
+                _nodes.resize(2 * (size_t)n - 1);
+                _prims.resize(n);
+            }
+
+            void build()
+            {
+                parallel(_workers, [this](const unsigned w) { run(w); });
+            }
+
+        private:
+            uint32_t first(const unsigned w, const uint32_t count) const
+            {
+                return (uint32_t)((uint64_t)count * w / _workers);
+            }
+
+            void run(const unsigned w)
+            {
+                const uint32_t b = first(w, _n), e = first(w + 1, _n);
+
+                encode(w, b, e);
+                _barrier.wait();
+
+                int src = 0;
+                for (uint32_t shift = 0; shift < KeyBits; shift += RadixBits)
+                {
+                    if (sort(w, b, e, src, shift))
+                        src ^= 1;
+                }
+
+                link(first(w, _n - 1), first(w + 1, _n - 1), src);
+                _barrier.wait();
+
+                fit(b, e);
+            }
+
+            // Morton codes of the box centers, quantized over the
+            // bounds of all centers.
+            void encode(const unsigned w, const uint32_t b, const uint32_t e)
+            {
+                Box3d& cb = _centers[w];
+                cb.clear();
+                for (uint32_t i = b; i < e; ++i)
+                    cb.compare(_bounds[i].center());
+                _barrier.wait();
+
+                Box3d all;
+                all.clear();
+                for (unsigned k = 0; k < _workers; ++k)
+                    all.merge(_centers[k]);
+
+                constexpr Real Cells = Real(1 << AxisBits);
+
+                Real lo[3], scale[3];
+                for (int a = 0; a < 3; ++a)
+                {
+                    const Real ext = all.bMax[a] - all.bMin[a];
+                    lo[a]          = all.bMin[a];
+                    scale[a]       = ext > Limits<Real>::Epsilon ? Cells / ext : 0;
+                }
+
+                for (uint32_t i = b; i < e; ++i)
+                {
+                    const Vec3  c  = _bounds[i].center();
+                    const Real* cp = c.ptr();
+
+                    K code = 0;
+                    for (int a = 0; a < 3; ++a)
+                    {
+                        const Real q = (cp[a] - lo[a]) * scale[a];
+                        const K    v = q < Cells - 1 ? (K)q : (K)(Cells - 1);
+                        code |= spread(v) << (2 - a);
+                    }
+                    _keys[0][i] = code;
+                    _ids[0][i]  = i;
+                }
+            }
+
+            // One stable counting pass of the radix sort, from buffer
+            // src to the other one. Returns false, without moving
+            // anything, when every key has the same digit.
+            bool sort(const unsigned w, const uint32_t b, const uint32_t e, const int src, const uint32_t shift)
+            {
+                const K*        keys = _keys[src].data();
+                const uint32_t* ids  = _ids[src].data();
+
+                uint32_t* hist = _hist.data() + (size_t)w * Radix;
+                std::fill(hist, hist + Radix, 0);
+                for (uint32_t i = b; i < e; ++i)
+                    ++hist[(keys[i] >> shift) & (Radix - 1)];
+                _barrier.wait();
+
+                // Every worker finds the same offsets for its range,
+                // digits first, then workers.
+                uint32_t offset[Radix];
+                uint32_t base = 0;
+                for (uint32_t d = 0; d < Radix; ++d)
+                {
+                    uint32_t total = 0;
+                    for (unsigned k = 0; k < _workers; ++k)
+                    {
+                        if (k == w)
+                            offset[d] = base + total;
+                        total += _hist[(size_t)k * Radix + d];
+                    }
+                    if (total == _n)
+                    {
+                        _barrier.wait();
+                        return false;
+                    }
+                    base += total;
+                }
+
+                K*        dk = _keys[src ^ 1].data();
+                uint32_t* di = _ids[src ^ 1].data();
+                for (uint32_t i = b; i < e; ++i)
+                {
+                    const uint32_t o = offset[(keys[i] >> shift) & (Radix - 1)]++;
+
+                    dk[o] = keys[i];
+                    di[o] = ids[i];
+                }
+                _barrier.wait();
+                return true;
+            }
+
+            // The length of the common prefix of the keys of i and j,
+            // with ties broken by the indices, or -1 when j is out of
+            // range.
+            int delta(const K* keys, const int64_t i, const int64_t j) const
+            {
+                if (j < 0 || j >= (int64_t)_n)
+                    return -1;
+
+                const K a = keys[i], b = keys[j];
+                if (a != b)
+                    return leadingZeros((uint64_t)(a ^ b)) - (64 - (int)KeyBits);
+                return (int)KeyBits + leadingZeros((uint64_t)(i ^ j)) - 32;
+            }
+
+            // Finds the range and split of internal nodes [b, e), and
+            // writes their children.
+            void link(const uint32_t b, const uint32_t e, const int src)
+            {
+                const K*        keys = _keys[src].data();
+                const uint32_t* ids  = _ids[src].data();
+
+                for (int64_t i = b; i < (int64_t)e; ++i)
+                {
+                    const int d    = delta(keys, i, i + 1) > delta(keys, i, i - 1) ? 1 : -1;
+                    const int dmin = delta(keys, i, i - d);
+
+                    int64_t lmax = 2;
+                    while (delta(keys, i, i + lmax * d) > dmin)
+                        lmax *= 2;
+
+                    int64_t l = 0;
+                    for (int64_t t = lmax / 2; t >= 1; t /= 2)
+                    {
+                        if (delta(keys, i, i + (l + t) * d) > dmin)
+                            l += t;
+                    }
+
+                    const int64_t j     = i + l * d;
+                    const int     dnode = delta(keys, i, j);
+
+                    int64_t s = 0, t = l;
+                    do
+                    {
+                        t = (t + 1) / 2;
+                        if (delta(keys, i, i + (s + t) * d) > dnode)
+                            s += t;
+                    } while (t > 1);
+
+                    const int64_t split = i + s * d + (d < 0 ? -1 : 0);
+
+                    const uint32_t c = 2 * (uint32_t)i + 1;
+                    child(c, (uint32_t)split, std::min(i, j) == split);
+                    child(c + 1, (uint32_t)split + 1, std::max(i, j) == split + 1);
+                    _owner[c]     = (uint32_t)i;
+                    _owner[c + 1] = (uint32_t)i;
+                }
+
+                // The root, internal node 0.
+                if (b == 0)
+                {
+                    _slot[0]        = 0;
+                    _nodes[0].first = 1;
+                    _nodes[0].count = 0;
+                }
+
+                // The leaves take the sorted ids, in the same split
+                // as the internal nodes.
+                for (uint32_t i = b; i < e; ++i)
+                    _prims[i] = ids[i];
+                if (e == _n - 1)
+                    _prims[e] = ids[e];
+            }
+
+            void child(const uint32_t slot, const uint32_t k, const bool leaf)
+            {
+                BvhNode& nd = _nodes[slot];
+                if (leaf)
+                {
+                    nd.first     = k;
+                    nd.count     = 1;
+                    _leafSlot[k] = slot;
+                }
+                else
+                {
+                    nd.first = 2 * k + 1;
+                    nd.count = 0;
+                    _slot[k] = slot;
+                }
+            }
+
+            // Bottom up bounds. The second child to reach a node merges
+            // both and carries on to its parent.
+            void fit(const uint32_t b, const uint32_t e)
+            {
+                for (uint32_t j = b; j < e; ++j)
+                {
+                    uint32_t slot = _leafSlot[j];
+
+                    Bounds lb;
+                    grow(lb, _bounds[_prims[j]]);
+                    _nodes[slot].bounds = outwards(lb);
+
+                    while (slot != 0)
+                    {
+                        const uint32_t k = _owner[slot];
+                        if (_visits[k].fetch_add(1, std::memory_order_acq_rel) == 0)
+                            break;
+
+                        slot                = _slot[k];
+                        _nodes[slot].bounds = merged(_nodes[2 * k + 1].bounds, _nodes[2 * k + 2].bounds);
+                    }
+                }
+            }
+        };
+    }  // namespace
+
+    void Bvh::clear()
+    {
+        _nodes.clear();
+        _prims.clear();
+        _bounds.clear();
+        _dirty.clear();
+        _touched.clear();
+
+        _dead   = 0;
+        _linked = false;
+    }
+
+    void Bvh::build(const Box3d* bounds, const size_t n)
+    {
+        clear();
+        if (!bounds || n == 0)
+            return;
+
+        _bounds.resize(n);
+        _prims.resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            _bounds[i] = bounds[i];
+            _prims[i]  = (uint32_t)i;
+        }
+
+        _nodes.reserve(2 * n - 1);
+        _nodes.resize(1);
+
+        SahBuilder builder(_nodes);
+        builder.build(0, _prims.data(), _bounds.data(), 0, (uint32_t)n, 0);
+    }
+
+    void Bvh::buildLinear(const Box3d* bounds, const size_t n, const MortonBits bits, unsigned workers)
+    {
+        clear();
+        if (!bounds || n == 0)
+            return;
+
+        _bounds.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            _bounds[i] = bounds[i];
+
+        if (n == 1)
+        {
+            Bounds b;
+            grow(b, bounds[0]);
+
+            _prims.push_back(0);
+            _nodes.resize(1);
+            _nodes[0].bounds = outwards(b);
+            _nodes[0].first  = 0;
+            _nodes[0].count  = 1;
+            return;
+        }
+
+        if (workers > n / MinPrimsPerWorker)
+            workers = (unsigned)(n / MinPrimsPerWorker);
+        if (workers < 1)
+            workers = 1;
+
+        if (bits == MB_63)
+            LinearBuilder<uint64_t>(_nodes, _prims, _bounds.data(), (uint32_t)n, workers).build();
+        else
+            LinearBuilder<uint32_t>(_nodes, _prims, _bounds.data(), (uint32_t)n, workers).build();
+    }
+
+    void Bvh::update(const size_t id, const Box3d& bounds)
+    {
+        link();
+        _bounds[id] = bounds;
+
+        const uint32_t leaf = _leafOf[id];
+        if (!_queued[leaf])
+        {
+            _queued[leaf] = 1;
+            _dirty.push_back(leaf);
+        }
+    }
+
+    void Bvh::refit(unsigned workers)
+    {
+        const size_t n = _dirty.size();
+
+        _touched.clear();
+        if (n == 0)
+            return;
+
+        if (workers > n / MinLeavesPerWorker)
+            workers = (unsigned)(n / MinLeavesPerWorker);
+        if (workers < 1)
+            workers = 1;
+
+        std::atomic<uint32_t>*              pending = _pending.data();
+        std::vector<AlignedArray<uint32_t>> touched(workers);
+        Barrier                             barrier(workers);
+
+        const auto run = [&](const unsigned w)
+        {
+            const size_t b = n * w / workers, e = n * (w + 1) / workers;
+
+            // Counts the children that will reach each node. Only the
+            // first path to reach a node carries on above it, so each
+            // child is counted once.
+            for (size_t i = b; i < e; ++i)
+            {
+                for (uint32_t x = _dirty[i]; _parent[x] != Root;)
+                {
+                    const uint32_t p = _parent[x];
+                    if (pending[p].fetch_add(1, std::memory_order_relaxed) != 0)
+                        break;
+                    x = p;
+                }
+            }
+            barrier.wait();
+
+            // The last child to reach a node refits it and carries on.
+            for (size_t i = b; i < e; ++i)
+            {
+                uint32_t x = _dirty[i];
+                fit(x);
+                while (_parent[x] != Root)
+                {
+                    const uint32_t p = _parent[x];
+                    if (pending[p].fetch_sub(1, std::memory_order_acq_rel) != 1)
+                        break;
+
+                    fit(p);
+                    touched[w].push_back(p);
+                    x = p;
+                }
+            }
+        };
+
+        parallel(workers, run);
+
+        for (const AlignedArray<uint32_t>& t : touched)
+        {
+            for (const uint32_t x : t)
+                _touched.push_back(x);
+        }
+        for (const uint32_t x : _dirty)
+            _queued[x] = 0;
+        _dirty.clear();
+    }
+
+    void Bvh::repair(const Real threshold)
+    {
+        if (!_dirty.empty())
+            refit();
+
+        // The nodes that grew too much, rebuilding only the highest of
+        // those on a path, which takes the others along.
+        std::vector<uint32_t> grown;
+        for (const uint32_t x : _touched)
+        {
+            if (relativeCost(x) > threshold * Real(_builtCost[x]))
+                grown.push_back(x);
+        }
+        std::sort(grown.begin(), grown.end());
+
+        size_t rebuilt = 0;
+        for (const uint32_t x : grown)
+        {
+            uint32_t p = _parent[x];
+            while (p != Root && p != Dead && !std::binary_search(grown.begin(), grown.end(), p))
+                p = _parent[p];
+            if (p == Root)
+                rebuilt += rebuild(x);
+        }
+
+        for (const uint32_t x : _touched)
+        {
+            if (_parent[x] != Dead && !_nodes[x].leaf())
+                rotate(x);
+        }
+        _touched.clear();
+
+        // A rebuild of most of the tree leaves about half of both
+        // arrays dead, which is compacted straight away.
+        if (2 * rebuilt >= size() || 2 * _dead >= _nodes.size() || _prims.size() >= 2 * size())
+            compact();
+    }
+
+    void Bvh::link()
+    {
+        if (_linked)
+            return;
+
+        const size_t nn = _nodes.size();
+        _parent.resize(nn);
+        _height.resize(nn);
+        _sah.resize(nn);
+        _builtCost.resize(nn);
+        _queued.resize(nn);
+        _leafOf.resize(size());
+        _pending = std::vector<std::atomic<uint32_t>>(nn);
+        if (nn > 0)
+        {
+            std::memset(_queued.data(), 0, nn);
+
+            _parent[0] = Root;
+            link(0);
+        }
+        for (size_t i = 0; i < nn; ++i)
+            _builtCost[i] = (float)relativeCost((uint32_t)i);
+
+        _dead   = 0;
+        _linked = true;
+    }
+
+    void Bvh::link(const uint32_t node)
+    {
+        // Breadth first, so that the reverse order has children
+        // before parents.
+        std::vector<uint32_t> order;
+        order.push_back(node);
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            const uint32_t x  = order[i];
+            const BvhNode& nd = _nodes[x];
+            if (nd.leaf())
+            {
+                for (uint32_t k = nd.first; k < nd.first + nd.count; ++k)
+                    _leafOf[_prims[k]] = x;
+            }
+            else
+            {
+                _parent[nd.first]     = x;
+                _parent[nd.first + 1] = x;
+                order.push_back(nd.first);
+                order.push_back(nd.first + 1);
+            }
+        }
+
+        for (size_t i = order.size(); i-- > 0;)
+            measure(order[i]);
+    }
+
+    void Bvh::measure(const uint32_t node)
+    {
+        const BvhNode& nd = _nodes[node];
+        if (nd.leaf())
+        {
+            _height[node] = 0;
+            _sah[node]    = area(nd.bounds) * Real(nd.count);
+        }
+        else
+        {
+            _height[node] = (uint8_t)(1 + std::max(_height[nd.first], _height[nd.first + 1]));
+            _sah[node]    = area(nd.bounds) * TraversalCost + _sah[nd.first] + _sah[nd.first + 1];
+        }
+    }
+
+    Real Bvh::relativeCost(const uint32_t node) const
+    {
+        const Real a = area(_nodes[node].bounds);
+        return a > 0 ? _sah[node] / a : _sah[node];
+    }
+
+    uint32_t Bvh::depth(uint32_t node) const
+    {
+        uint32_t d = 0;
+        while (_parent[node] != Root)
+        {
+            node = _parent[node];
+            ++d;
+        }
+        return d;
+    }
+
+    void Bvh::fit(const uint32_t node)
+    {
+        BvhNode& nd = _nodes[node];
+        if (nd.leaf())
+        {
+            Bounds b;
+            for (uint32_t k = nd.first; k < nd.first + nd.count; ++k)
+                grow(b, _bounds[_prims[k]]);
+            nd.bounds = outwards(b);
+        }
+        else
+            nd.bounds = merged(_nodes[nd.first].bounds, _nodes[nd.first + 1].bounds);
+        measure(node);
+    }
+
+    void Bvh::rotate(const uint32_t node)
+    {
+        const uint32_t l = _nodes[node].first;
+        const uint32_t d = depth(node);
+
+        // Swapping child c with grandchild g, under c's sibling s,
+        // changes s alone, to the union of c and g's sibling.
+        Real     best = 0;
+        uint32_t bc = 0, bg = 0;
+        for (uint32_t c = l; c < l + 2; ++c)
+        {
+            const uint32_t s = c == l ? l + 1 : l;
+            if (_nodes[s].leaf() || d + 2 + _height[c] >= MaxDepth)
+                continue;
+
+            const Real     size = area(_nodes[s].bounds);
+            const uint32_t g0   = _nodes[s].first;
+            for (uint32_t g = g0; g < g0 + 2; ++g)
+            {
+                const uint32_t h    = g == g0 ? g0 + 1 : g0;
+                const Real     gain = size - area(merged(_nodes[c].bounds, _nodes[h].bounds));
+                if (gain > best)
+                {
+                    best = gain;
+                    bc   = c;
+                    bg   = g;
+                }
+            }
+        }
+        if (best <= 0)
+            return;
+
+        const uint32_t s = _parent[bg];
+        swap(bc, bg);
+        fit(s);
+        _builtCost[s] = (float)relativeCost(s);
+        raise(node);
+    }
+
+    void Bvh::swap(const uint32_t a, const uint32_t b)
+    {
+        std::swap(_nodes[a], _nodes[b]);
+        std::swap(_height[a], _height[b]);
+        std::swap(_sah[a], _sah[b]);
+        std::swap(_builtCost[a], _builtCost[b]);
+
+        for (const uint32_t x : {a, b})
+        {
+            const BvhNode& nd = _nodes[x];
+            if (nd.leaf())
+            {
+                for (uint32_t k = nd.first; k < nd.first + nd.count; ++k)
+                    _leafOf[_prims[k]] = x;
+            }
+            else
+            {
+                _parent[nd.first]     = x;
+                _parent[nd.first + 1] = x;
+            }
+        }
+    }
+
+    void Bvh::raise(uint32_t node)
+    {
+        for (; node != Root; node = _parent[node])
+            measure(node);
+    }
+
+    size_t Bvh::rebuild(const uint32_t node)
+    {
+        // Collects the primitives, and retires the nodes below.
+        const size_t offset = _prims.size();
+
+        std::vector<uint32_t> stack;
+        stack.push_back(node);
+        while (!stack.empty())
+        {
+            const uint32_t x = stack.back();
+            stack.pop_back();
+
+            const BvhNode& nd = _nodes[x];
+            if (nd.leaf())
+            {
+                for (uint32_t k = nd.first; k < nd.first + nd.count; ++k)
+                    _prims.push_back(_prims[k]);
+            }
+            else
+            {
+                stack.push_back(nd.first);
+                stack.push_back(nd.first + 1);
+            }
+
+            if (x != node)
+            {
+                _parent[x] = Dead;
+                ++_dead;
+            }
+        }
+
+        // The new subtree takes fresh slots at the end of both arrays.
+        const size_t first = _nodes.size();
+        const size_t m     = _prims.size() - offset;
+
+        SahBuilder builder(_nodes);
+        builder.build(node, _prims.data() + offset, _bounds.data(), (uint32_t)offset, (uint32_t)m, depth(node));
+
+        const size_t nn = _nodes.size();
+        _parent.resize(nn);
+        _height.resize(nn);
+        _sah.resize(nn);
+        _builtCost.resize(nn);
+        _queued.resize(nn);
+        if (_pending.size() < nn)
+            _pending = std::vector<std::atomic<uint32_t>>(std::max(nn, 2 * _pending.size()));
+
+        link(node);
+        _builtCost[node] = (float)relativeCost(node);
+        for (size_t i = first; i < nn; ++i)
+            _builtCost[i] = (float)relativeCost((uint32_t)i);
+        if (_parent[node] != Root)
+            raise(_parent[node]);
+        return m;
+    }
+
+    void Bvh::compact()
+    {
+        // Lays the tree out again in depth first order, leaving the
+        // retired nodes and primitive slots behind.
+        AlignedArray<BvhNode>  nodes;
+        AlignedArray<uint32_t> prims;
+        AlignedArray<float>    built;
+        nodes.reserve(_nodes.size() - _dead);
+        prims.reserve(size());
+        built.resize(_nodes.size());
+        nodes.resize(1);
+
+        std::vector<std::pair<uint32_t, uint32_t>> stack;
+        stack.emplace_back(0, 0);
+        while (!stack.empty())
+        {
+            const auto [from, to] = stack.back();
+            stack.pop_back();
+
+            BvhNode nd = _nodes[from];
+            built[to]  = _builtCost[from];
+            if (nd.leaf())
+            {
+                const uint32_t k = (uint32_t)prims.size();
+                for (uint32_t i = nd.first; i < nd.first + nd.count; ++i)
+                    prims.push_back(_prims[i]);
+                nd.first = k;
+            }
+            else
+            {
+                const uint32_t c = (uint32_t)nodes.size();
+                nodes.resize(c + 2);
+                stack.emplace_back(nd.first + 1, c + 1);
+                stack.emplace_back(nd.first, c);
+                nd.first = c;
+            }
+            nodes[to] = nd;
+        }
+
+        built.resize(nodes.size());
+
+        _nodes.swap(nodes);
+        _prims.swap(prims);
+        _builtCost.swap(built);
+
+        const size_t nn = _nodes.size();
+        _parent.resize(nn);
+        _height.resize(nn);
+        _sah.resize(nn);
+        _queued.resize(nn);
+        std::memset(_queued.data(), 0, nn);
+        _pending = std::vector<std::atomic<uint32_t>>(nn);
+
+        _parent[0] = Root;
+        link(0);
+        _dead = 0;
+    }
+
+    int32_t Bvh::hit(RayHitTest& dest, const PreparedRay& ray, const Vec2& limit) const
+    {
+        Real t;
+        if (_nodes.empty() || !enter(t, _nodes[0].bounds, ray, limit.x, limit.y))
+            return None;
+
+        uint32_t stack[MaxDepth];
+        Real     entry[MaxDepth];
+        size_t   top = 0;
+
+        int32_t  best = None;
+        Real     far  = limit.y;
+        uint32_t node = 0;
+        for (;;)
+        {
+            const BvhNode& nd = _nodes[node];
+            if (nd.leaf())
+            {
+                for (uint32_t i = nd.first; i < nd.first + nd.count; ++i)
+                {
+                    // The limit only admits closer hits.
+                    const uint32_t p = _prims[i];
+                    if (_bounds[p].hit(dest, ray, {limit.x, far}))
+                    {
+                        far  = dest.distance;
+                        best = (int32_t)p;
+                    }
+                }
+            }
+            else
+            {
+                Real       ta, tb;
+                const bool ha = enter(ta, _nodes[nd.first].bounds, ray, limit.x, far);
+                const bool hb = enter(tb, _nodes[nd.first + 1].bounds, ray, limit.x, far);
+                if (ha && hb)
+                {
+                    // Visits the nearer child first, the other waits
+                    // on the stack with its entry distance.
+                    const bool swap = tb < ta;
+                    stack[top]      = nd.first + (swap ? 0 : 1);
+                    entry[top++]    = swap ? ta : tb;
+                    node            = nd.first + (swap ? 1 : 0);
+                    continue;
+                }
+                if (ha || hb)
+                {
+                    node = nd.first + (ha ? 0 : 1);
+                    continue;
+                }
+            }
+
+            // Skips the nodes that start past the closest hit so far.
+            do
+            {
+                if (top == 0)
+                    return best;
+                --top;
+            } while (entry[top] > far);
+            node = stack[top];
+        }
+    }
+
+    bool Bvh::hitAny(const PreparedRay& ray, const Vec2& limit) const
+    {
+        Real t;
+        if (_nodes.empty() || !enter(t, _nodes[0].bounds, ray, limit.x, limit.y))
+            return false;
+
+        uint32_t stack[MaxDepth];
+        size_t   top = 0;
+
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const BvhNode& nd = _nodes[stack[--top]];
+            if (nd.leaf())
+            {
+                for (uint32_t i = nd.first; i < nd.first + nd.count; ++i)
+                {
+                    if (_bounds[_prims[i]].hit(ray, limit))
+                        return true;
+                }
+            }
+            else
+            {
+                if (enter(t, _nodes[nd.first + 1].bounds, ray, limit.x, limit.y))
+                    stack[top++] = nd.first + 1;
+                if (enter(t, _nodes[nd.first].bounds, ray, limit.x, limit.y))
+                    stack[top++] = nd.first;
+            }
+        }
+        return false;
+    }
+
+    namespace
+    {
+        template <typename Q>
+        void gather(AlignedArray<uint32_t>&       dest,
+                    const AlignedArray<BvhNode>&  nodes,
+                    const AlignedArray<uint32_t>& prims,
+                    const AlignedArray<Box3d>&    bounds,
+                    const Q&                      query)
+        {
+            dest.clear();
+            if (nodes.empty() || !overlap(nodes[0].bounds, query))
+                return;
+
+            uint32_t stack[Bvh::MaxDepth];
+            size_t   top = 0;
+
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const BvhNode& nd = nodes[stack[--top]];
+                if (nd.leaf())
+                {
+                    for (uint32_t i = nd.first; i < nd.first + nd.count; ++i)
+                    {
+                        if (overlap(bounds[prims[i]], query))
+                            dest.push_back(prims[i]);
+                    }
+                }
+                else
+                {
+                    if (overlap(nodes[nd.first + 1].bounds, query))
+                        stack[top++] = nd.first + 1;
+                    if (overlap(nodes[nd.first].bounds, query))
+                        stack[top++] = nd.first;
+                }
+            }
+        }
+    }  // namespace
+
+    void Bvh::overlaps(AlignedArray<uint32_t>& dest, const Box3d& query) const
+    {
+        gather(dest, _nodes, _prims, _bounds, query);
+    }
+
+    void Bvh::overlaps(AlignedArray<uint32_t>& dest, const Sphere& query) const
+    {
+        gather(dest, _nodes, _prims, _bounds, query);
+    }
+
+    Real Bvh::cost() const
+    {
+        if (_nodes.empty())
+            return 0;
+
+        Real sum = 0;
+
+        std::vector<uint32_t> stack;
+        stack.push_back(0);
+        while (!stack.empty())
+        {
+            const BvhNode& nd = _nodes[stack.back()];
+            stack.pop_back();
+
+            sum += area(nd.bounds) * (nd.leaf() ? Real(nd.count) : TraversalCost);
+            if (!nd.leaf())
+            {
+                stack.push_back(nd.first);
+                stack.push_back(nd.first + 1);
+            }
+        }
+
+        const Real root = area(_nodes[0].bounds);
+        return root > 0 ? sum / root : sum;
+    }
+
+}  // namespace Rt2::Math
@@ -0,0 +1,266 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "Math/AlignedArray.h"
+#include "Math/Box3d.h"
+#include "Math/Ray.h"
+#include "Math/Sphere.h"
+
+namespace Rt2::Math
+{
+    // A node of Bvh. The bounds are kept in float, rounded outwards
+    // when Real is double, so that a node fills 32 bytes.
+    struct alignas(32) BvhNode
+    {
+        Box3df bounds;
+
+        // For a leaf, the first of its entries in Bvh::primitives().
+        // For an interior node, the left child, the right child being
+        // stored right after it.
+        uint32_t first;
+
+        // The number of primitives in a leaf, 0 for interior nodes.
+        uint32_t count;
+
+        bool leaf() const;
+    };
+
+    // Morton code sizes for Bvh::buildLinear. MB_30 sorts 32 bit keys
+    // on a 1024 cells grid per axis, MB_63 sorts 64 bit keys on a two
+    // million cells grid, for scenes that are large and detailed.
+    enum MortonBits
+    {
+        MB_30,
+        MB_63,
+    };
+
+    // Bounding volume hierarchy over an array of Box3d.
+    //
+    // The nodes live in one flat array, root first, with the two
+    // children of a node side by side. Leaves reference a range of
+    // primitive ids, and queries report the ids, which are indices into
+    // the array given to build.
+    //
+    // For scenes that move, update changes the bounds of primitives,
+    // refit brings the nodes above them up to date, and repair restores
+    // the quality that the moves cost, far cheaper than building
+    // again.
+    class Bvh
+    {
+    public:
+        static constexpr int32_t None = -1;
+
+        // Leaves hold at most this many primitives.
+        static constexpr uint32_t MaxLeafSize = 4;
+
+        // The deepest tree that queries can walk. Builds keep their
+        // trees within it.
+        static constexpr uint32_t MaxDepth = 128;
+
+        // The default of repair, rebuilding subtrees whose surface
+        // area heuristic cost has grown past this factor of their cost
+        // when built.
+        static constexpr Real RebuildThreshold = 2;
+
+    private:
+        AlignedArray<BvhNode>  _nodes;
+        AlignedArray<uint32_t> _prims;
+        AlignedArray<Box3d>    _bounds;
+
+        // Built on the first update, for the dynamic operations: the
+        // parent of each node, Root or Dead, the leaf of each
+        // primitive, and for each subtree its height, its unscaled
+        // cost and its relative cost when it was built.
+        AlignedArray<uint32_t> _parent;
+        AlignedArray<uint32_t> _leafOf;
+        AlignedArray<uint8_t>  _height;
+        AlignedArray<Real>     _sah;
+        AlignedArray<float>    _builtCost;
+        bool                   _linked{false};
+
+        // Leaves queued for refit, and the interior nodes it changed.
+        AlignedArray<uint32_t> _dirty;
+        AlignedArray<uint8_t>  _queued;
+        AlignedArray<uint32_t> _touched;
+
+        // Per node arrival counts for the parallel refit. Every count
+        // it raises is brought back to zero before it returns.
+        std::vector<std::atomic<uint32_t>> _pending;
+
+        // Nodes in the array that left the tree.
+        size_t _dead{0};
+
+    public:
+        Bvh() = default;
+
+        void clear();
+
+        // Builds the tree over bounds[0, n) with binned surface area
+        // heuristic splits, laying the nodes out in depth first order.
+        void build(const Box3d* bounds, size_t n);
+
+        // Builds a linear BVH over bounds[0, n), after Karras,
+        // "Maximizing Parallelism in the Construction of BVHs, Octrees,
+        // and k-d Trees". The boxes are sorted along the Morton curve of
+        // their centers, and the tree follows the bits of the sorted
+        // codes. Every phase is split between the given number of
+        // threads, the caller included. It builds much faster than
+        // build, and gives a tree that is slower to query. Its leaves
+        // hold one primitive each, and its nodes are laid out by
+        // split position rather than in depth first order.
+        void buildLinear(const Box3d* bounds, size_t n, MortonBits bits = MB_30, unsigned workers = 1);
+
+        // Sets the bounds of primitive id. The nodes above it are out
+        // of date until the next refit.
+        void update(size_t id, const Box3d& bounds);
+
+        // Recomputes the bounds of the nodes above the primitives
+        // changed by update, bottom up and only along their paths,
+        // split between the given number of threads, the caller
+        // included.
+        void refit(unsigned workers = 1);
+
+        // Improves the nodes that the last refit changed. A node whose
+        // cost, as cost() measures it for its subtree, has grown past
+        // threshold times its cost when built has its subtree rebuilt
+        // with build's heuristic, and the others
+        // try the tree rotations of Kopta et al., "Fast, Effective BVH
+        // Updates for Animated Scenes", swapping a child with a
+        // grandchild when that shrinks the node between them.
+        void repair(Real threshold = RebuildThreshold);
+
+        // Finds the closest primitive that ray hits within limit, and
+        // returns its id, or None. dest is filled as by Box3d::hit.
+        int32_t hit(RayHitTest& dest, const Ray& ray, const Vec2& limit) const;
+
+        int32_t hit(RayHitTest& dest, const PreparedRay& ray, const Vec2& limit) const;
+
+        // True when ray hits any primitive within limit. Stops at the
+        // first one found.
+        bool hitAny(const Ray& ray, const Vec2& limit) const;
+
+        bool hitAny(const PreparedRay& ray, const Vec2& limit) const;
+
+        // Replaces the content of dest with the ids of the primitives
+        // that overlap query.
+        void overlaps(AlignedArray<uint32_t>& dest, const Box3d& query) const;
+
+        void overlaps(AlignedArray<uint32_t>& dest, const Sphere& query) const;
+
+        // The surface area heuristic cost of the tree, relative to
+        // testing every primitive of the root, for measuring quality.
+        Real cost() const;
+
+        // The number of primitives.
+        size_t size() const;
+
+        bool empty() const;
+
+        // The size of the node array. After repair it can hold nodes
+        // that are no longer part of the tree.
+        size_t nodeCount() const;
+
+        const BvhNode* nodes() const;
+
+        // Primitive ids, in leaf order.
+        const uint32_t* primitives() const;
+
+        const Box3d& bounds(size_t id) const;
+
+    private:
+        static constexpr uint32_t Root = ~0u;
+        static constexpr uint32_t Dead = ~1u;
+
+        void link();
+
+        void link(uint32_t node);
+
+        uint32_t depth(uint32_t node) const;
+
+        void measure(uint32_t node);
+
+        Real relativeCost(uint32_t node) const;
+
+        void fit(uint32_t node);
+
+        void rotate(uint32_t node);
+
+        void swap(uint32_t a, uint32_t b);
+
+        void raise(uint32_t node);
+
+        // Returns the number of primitives under node.
+        size_t rebuild(uint32_t node);
+
+        void compact();
+    };
+
+    inline bool BvhNode::leaf() const
+    {
+        return count != 0;
+    }
+
+    inline size_t Bvh::size() const
+    {
+        return _bounds.size();
+    }
+
+    inline bool Bvh::empty() const
+    {
+        return _nodes.empty();
+    }
+
+    inline size_t Bvh::nodeCount() const
+    {
+        return _nodes.size();
+    }
+
+    inline const BvhNode* Bvh::nodes() const
+    {
+        return _nodes.data();
+    }
+
+    inline const uint32_t* Bvh::primitives() const
+    {
+        return _prims.data();
+    }
+
+    inline const Box3d& Bvh::bounds(const size_t id) const
+    {
+        return _bounds[id];
+    }
+
+    inline int32_t Bvh::hit(RayHitTest& dest, const Ray& ray, const Vec2& limit) const
+    {
+        return hit(dest, PreparedRay(ray), limit);
+    }
+
+    inline bool Bvh::hitAny(const Ray& ray, const Vec2& limit) const
+    {
+        return hitAny(PreparedRay(ray), limit);
+    }
+
+}  // namespace Rt2::Math
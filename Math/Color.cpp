@@ -22,6 +22,7 @@
 #include "Math/Color.h"
 #include <cstdint>
 #include <cstdio>
+#include "Math/Dispatch.h"
 #include "Math/Vec3.h"
 #include "Utils/Definitions.h"
 
@@ -214,6 +215,32 @@ namespace Rt2::Math
         dst.a = (Real)uf.b[Ia] * i255;
     }
 
+    static_assert(sizeof(Color) == 4 * sizeof(Real));
+
+    void ColorUtils::convert(U32* dst, const Color* src, const size_t n)
+    {
+        if (!dst || !src)
+            return;
+#if RT_ENDIAN == RT_ENDIAN_BIG
+        for (size_t i = 0; i < n; ++i)
+            convert(dst[i], src[i]);
+#else
+        Dispatch::kernels().colorToInt(dst, &src->r, n);
+#endif
+    }
+
+    void ColorUtils::convert(Color* dst, const U32* src, const size_t n)
+    {
+        if (!dst || !src)
+            return;
+#if RT_ENDIAN == RT_ENDIAN_BIG
+        for (size_t i = 0; i < n; ++i)
+            convert(dst[i], src[i]);
+#else
+        Dispatch::kernels().intToColor(&dst->r, src, n);
+#endif
+    }
+
     void ColorUtils::convert(ColorHsv& dst, const Color& src)
     {
         dst.v = Max3(src.r, src.g, src.b);
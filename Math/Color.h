@@ -22,12 +22,12 @@
 #pragma once
 
 #include <cstdint>
+#include "Math/Forward.h"
 #include "Math/Math.h"
 #include "Utils/Definitions.h"
 
 namespace Rt2::Math
 {
-    class Vec3;
 
     class ColorHsv;
     class Color;
@@ -71,6 +71,11 @@ namespace Rt2::Math
         static void convert(U8*& dst, const Real& src);
         static void convert(U8*& dst, const U32& src);
         static void convert(Color& dst, const Real& src);
+
+        // Batch versions of convert(U32&, const Color&) and
+        // convert(Color&, const U32&) for n colors.
+        static void convert(U32* dst, const Color* src, size_t n);
+        static void convert(Color* dst, const U32* src, size_t n);
     };
 
     class ColorHsv
@@ -22,4 +22,6 @@
 #pragma once
 
 #define Math_USE_DOUBLE ON
+/* #undef Math_USE_SIMD_VEC4 */
+/* #undef Math_USE_FAST_RSQRT */
 
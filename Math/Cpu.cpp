@@ -0,0 +1,136 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Cpu.h"
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define Math_CPU_X86
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+namespace Rt2::Math
+{
+#ifdef Math_CPU_X86
+    namespace
+    {
+        void cpuid(uint32_t regs[4], const uint32_t leaf, const uint32_t sub)
+        {
+    #if defined(_MSC_VER)
+            int r[4];
+            __cpuidex(r, (int)leaf, (int)sub);
+            for (int i = 0; i < 4; ++i)
+                regs[i] = (uint32_t)r[i];
+    #else
+            __cpuid_count(leaf, sub, regs[0], regs[1], regs[2], regs[3]);
+    #endif
+        }
+
+        uint64_t xgetbv()
+        {
+    #if defined(_MSC_VER)
+            return _xgetbv(0);
+    #else
+            uint32_t lo, hi;
+            __asm__ volatile("xgetbv"
+                             : "=a"(lo), "=d"(hi)
+                             : "c"(0));
+            return (uint64_t)hi << 32 | lo;
+    #endif
+        }
+
+        int detect()
+        {
+            uint32_t r[4];
+            cpuid(r, 0, 0);
+            const uint32_t maxLeaf = r[0];
+            if (maxLeaf < 1)
+                return 0;
+
+            int f = 0;
+            cpuid(r, 1, 0);
+            const uint32_t ecx1 = r[2];
+            const uint32_t edx1 = r[3];
+
+            if (edx1 & 1u << 26)
+                f |= CPU_SSE2;
+            if (ecx1 & 1u << 19)
+                f |= CPU_SSE41;
+
+            // The wide registers are only usable when the operating system
+            // saves them on a context switch (OSXSAVE and XCR0).
+            if (!(ecx1 & 1u << 27))
+                return f;
+
+            const uint64_t xcr0 = xgetbv();
+            if ((xcr0 & 0x06) != 0x06)
+                return f;
+
+            if (ecx1 & 1u << 28)
+                f |= CPU_AVX;
+            if (ecx1 & 1u << 12)
+                f |= CPU_FMA;
+            if (ecx1 & 1u << 29)
+                f |= CPU_F16C;
+
+            if (maxLeaf < 7)
+                return f;
+
+            cpuid(r, 7, 0);
+            const uint32_t ebx7 = r[1];
+            if (ebx7 & 1u << 5)
+                f |= CPU_AVX2;
+
+            if ((xcr0 & 0xE6) != 0xE6)
+                return f;
+
+            if (ebx7 & 1u << 16)
+                f |= CPU_AVX512F;
+            if (ebx7 & 1u << 17)
+                f |= CPU_AVX512DQ;
+            if (ebx7 & 1u << 30)
+                f |= CPU_AVX512BW;
+            if (ebx7 & 1u << 31)
+                f |= CPU_AVX512VL;
+            return f;
+        }
+    }  // namespace
+#else
+    namespace
+    {
+        int detect()
+        {
+            return 0;
+        }
+    }  // namespace
+#endif
+
+    int Cpu::features()
+    {
+        static const int features = detect();
+        return features;
+    }
+
+}  // namespace Rt2::Math
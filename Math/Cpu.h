@@ -0,0 +1,55 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+namespace Rt2::Math
+{
+    enum CpuFeature
+    {
+        CPU_SSE2     = 0x001,
+        CPU_SSE41    = 0x002,
+        CPU_AVX      = 0x004,
+        CPU_AVX2     = 0x008,
+        CPU_FMA      = 0x010,
+        CPU_F16C     = 0x020,
+        CPU_AVX512F  = 0x040,
+        CPU_AVX512DQ = 0x080,
+        CPU_AVX512BW = 0x100,
+        CPU_AVX512VL = 0x200,
+    };
+
+    class Cpu
+    {
+    public:
+        // Returns the CpuFeature bits supported by both the processor
+        // and the operating system. The query runs once.
+        static int features();
+
+        static bool has(int mask);
+    };
+
+    inline bool Cpu::has(const int mask)
+    {
+        return (features() & mask) == mask;
+    }
+
+}  // namespace Rt2::Math
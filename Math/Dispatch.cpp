@@ -0,0 +1,135 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Dispatch.h"
+#include <atomic>
+#include "Math/Cpu.h"
+
+namespace Rt2::Math
+{
+    namespace
+    {
+        struct Tables
+        {
+            KernelTable table[KL_MAX]{};
+            bool        linked[KL_MAX]{};
+
+            Tables()
+            {
+                Kernels::bindBase(table[KL_BASE]);
+                linked[KL_BASE] = true;
+
+#ifdef Math_DISPATCH_X86
+                Kernels::bindSse41(table[KL_SSE41]);
+                Kernels::bindAvx2(table[KL_AVX2]);
+                Kernels::bindAvx512(table[KL_AVX512]);
+                linked[KL_SSE41]  = true;
+                linked[KL_AVX2]   = true;
+                linked[KL_AVX512] = true;
+#endif
+            }
+        };
+
+        const Tables& tables()
+        {
+            static const Tables tables;
+            return tables;
+        }
+
+        bool supported(const KernelLevel lv)
+        {
+            switch (lv)
+            {
+            case KL_BASE:
+                return true;
+            case KL_SSE41:
+                return Cpu::has(CPU_SSE2 | CPU_SSE41);
+            case KL_AVX2:
+                return Cpu::has(CPU_AVX | CPU_AVX2 | CPU_FMA | CPU_F16C);
+            case KL_AVX512:
+                return Cpu::has(CPU_AVX512F | CPU_AVX512DQ | CPU_AVX512BW | CPU_AVX512VL | CPU_FMA | CPU_F16C);
+            default:
+                return false;
+            }
+        }
+
+        std::atomic<int> active{-1};
+    }  // namespace
+
+    bool Dispatch::available(const KernelLevel lv)
+    {
+        if (lv < KL_BASE || lv >= KL_MAX)
+            return false;
+        return tables().linked[lv] && supported(lv);
+    }
+
+    KernelLevel Dispatch::best()
+    {
+        for (int lv = KL_MAX - 1; lv > KL_BASE; --lv)
+        {
+            if (available((KernelLevel)lv))
+                return (KernelLevel)lv;
+        }
+        return KL_BASE;
+    }
+
+    KernelLevel Dispatch::level()
+    {
+        int lv = active.load(std::memory_order_acquire);
+        if (lv < 0)
+        {
+            lv = best();
+            active.store(lv, std::memory_order_release);
+        }
+        return (KernelLevel)lv;
+    }
+
+    bool Dispatch::select(const KernelLevel lv)
+    {
+        if (!available(lv))
+            return false;
+        active.store(lv, std::memory_order_release);
+        return true;
+    }
+
+    const KernelTable& Dispatch::kernels()
+    {
+        return tables().table[level()];
+    }
+
+    const char* Dispatch::name(const KernelLevel lv)
+    {
+        switch (lv)
+        {
+        case KL_BASE:
+            return "Base";
+        case KL_SSE41:
+            return "SSE4.1";
+        case KL_AVX2:
+            return "AVX2";
+        case KL_AVX512:
+            return "AVX-512";
+        default:
+            return "Unknown";
+        }
+    }
+
+}  // namespace Rt2::Math
@@ -0,0 +1,60 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include "Math/Kernels/Kernels.h"
+
+namespace Rt2::Math
+{
+    enum KernelLevel
+    {
+        KL_BASE = 0,  // compiler default, SSE2 on x86-64
+        KL_SSE41,
+        KL_AVX2,      // AVX2 + FMA + F16C
+        KL_AVX512,    // AVX-512 F, DQ, BW and VL
+        KL_MAX,
+    };
+
+    // Routes the batch entry points to the variant compiled for the best
+    // instruction set the running processor supports. The selection is
+    // made on first use, so a single binary runs on any x86-64 machine.
+    class Dispatch
+    {
+    public:
+        static const KernelTable& kernels();
+
+        static KernelLevel level();
+
+        // The highest level that is both compiled in and supported.
+        static KernelLevel best();
+
+        // Forces a level, mainly for testing the variants against each
+        // other. Returns false, leaving the selection unchanged, if the
+        // level is not available.
+        static bool select(KernelLevel lv);
+
+        static bool available(KernelLevel lv);
+
+        static const char* name(KernelLevel lv);
+    };
+
+}  // namespace Rt2::Math
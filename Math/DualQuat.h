@@ -0,0 +1,143 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include "Math/Forward.h"
+#include "Math/Mat4.h"
+#include "Math/Quat.h"
+#include "Math/Vec3.h"
+
+namespace Rt2::Math
+{
+    // A rigid transform as a unit dual quaternion, real + e * dual,
+    // where real is the rotation and dual = 0.5 * (0, t) * real for
+    // the translation t. Weighted sums of these stay free of the
+    // shrinking that blending matrices shows, which is what dual
+    // quaternion skinning relies on.
+    template <typename T>
+    class TDualQuat
+    {
+    public:
+        TQuat<T> real{1, 0, 0, 0};
+        TQuat<T> dual{0, 0, 0, 0};
+
+        static const TDualQuat Identity;
+
+    public:
+        TDualQuat() = default;
+
+        TDualQuat(const TDualQuat&) = default;
+
+        constexpr TDualQuat(const TQuat<T>& nr, const TQuat<T>& nd) :
+            real(nr),
+            dual(nd)
+        {
+        }
+
+        constexpr TDualQuat(const TQuat<T>& rot, const TVec3<T>& trans)
+        {
+            makeTransform(rot, trans);
+        }
+
+        constexpr void makeTransform(const TQuat<T>& rot, const TVec3<T>& trans)
+        {
+            real = rot;
+            dual = TQuat<T>(0, trans.x, trans.y, trans.z) * rot * T(0.5);
+        }
+
+        constexpr TDualQuat operator*(const TDualQuat& v) const
+        {
+            return {real * v.real, real * v.dual + dual * v.real};
+        }
+
+        constexpr TDualQuat operator*(const T& v) const
+        {
+            return {real * v, dual * v};
+        }
+
+        constexpr TDualQuat operator+(const TDualQuat& v) const
+        {
+            return {real + v.real, dual + v.dual};
+        }
+
+        // The dot product of the rotations, negative when the two lie
+        // in opposite hemispheres.
+        constexpr T dot(const TDualQuat& v) const
+        {
+            return real.dot(v.real);
+        }
+
+        // Scales both parts so that real has unit length.
+        constexpr void normalize()
+        {
+            if (T len = real.length2();
+                len > Limits<T>::Epsilon)
+            {
+                len = rsqrt<T>(len);
+                real *= len;
+                dual *= len;
+            }
+        }
+
+        constexpr TDualQuat normalized() const
+        {
+            TDualQuat r(*this);
+            r.normalize();
+            return r;
+        }
+
+        // The inverse of a unit dual quaternion.
+        constexpr TDualQuat conjugate() const
+        {
+            return {real.inverse(), dual.inverse()};
+        }
+
+        constexpr TVec3<T> getTrans() const
+        {
+            // 2 * dual * conjugate(real), expanded for the vector part.
+            const TVec3<T> re(real.x, real.y, real.z);
+            const TVec3<T> de(dual.x, dual.y, dual.z);
+            return (de * real.w - re * dual.w + re.cross(de)) * T(2);
+        }
+
+        constexpr TVec3<T> transformPoint(const TVec3<T>& p) const
+        {
+            return real * p + getTrans();
+        }
+
+        constexpr TVec3<T> transformDirection(const TVec3<T>& v) const
+        {
+            return real * v;
+        }
+
+        constexpr TMat4<T> toMat4() const
+        {
+            TMat4<T> r;
+            r.makeTransform(getTrans(), TVec3<T>::Unit, real);
+            return r;
+        }
+    };
+
+    template <typename T>
+    inline constexpr TDualQuat<T> TDualQuat<T>::Identity = TDualQuat<T>(TQuat<T>(1, 0, 0, 0), TQuat<T>(0, 0, 0, 0));
+
+}  // namespace Rt2::Math
@@ -0,0 +1,91 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include "Math/Scalar.h"
+
+namespace Rt2::Math
+{
+    template <typename T>
+    class TVec2;
+
+    template <typename T>
+    class TVec3;
+
+    template <typename T>
+    class TVec4;
+
+    template <typename T>
+    class TQuat;
+
+    template <typename T>
+    class TMat3;
+
+    template <typename T>
+    class TMat4;
+
+    template <typename T>
+    class TBox3d;
+
+    template <typename T>
+    class TAffine3;
+
+    template <typename T>
+    class TDualQuat;
+
+    class PackedQuat32;
+    class PackedQuat48;
+
+    using Vec2  = TVec2<Real>;
+    using Vec3  = TVec3<Real>;
+    using Vec4  = TVec4<Real>;
+    using Quat  = TQuat<Real>;
+    using Mat3  = TMat3<Real>;
+    using Mat4  = TMat4<Real>;
+    using Box3d = TBox3d<Real>;
+
+    using Affine3  = TAffine3<Real>;
+    using DualQuat = TDualQuat<Real>;
+
+    using Vec2f  = TVec2<float>;
+    using Vec3f  = TVec3<float>;
+    using Vec4f  = TVec4<float>;
+    using Quatf  = TQuat<float>;
+    using Mat3f  = TMat3<float>;
+    using Mat4f  = TMat4<float>;
+    using Box3df = TBox3d<float>;
+
+    using Affine3f  = TAffine3<float>;
+    using DualQuatf = TDualQuat<float>;
+
+    using Vec2d  = TVec2<double>;
+    using Vec3d  = TVec3<double>;
+    using Vec4d  = TVec4<double>;
+    using Quatd  = TQuat<double>;
+    using Mat3d  = TMat3<double>;
+    using Mat4d  = TMat4<double>;
+    using Box3dd = TBox3d<double>;
+
+    using Affine3d  = TAffine3<double>;
+    using DualQuatd = TDualQuat<double>;
+
+}  // namespace Rt2::Math
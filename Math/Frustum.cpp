@@ -0,0 +1,150 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Frustum.h"
+#include <utility>
+#include "Math/Dispatch.h"
+
+namespace Rt2::Math
+{
+    namespace
+    {
+        // True when clip space depth falls with distance from the eye.
+        // The eye is where the x, y and w rows are all zero, solved by
+        // their cofactors, and depth is reversed when z is positive
+        // there. Projections without an eye keep the [0, 1] order.
+        bool reversedDepth(const Real(*m)[4])
+        {
+            const auto minor = [m](const int i, const int j, const int k)
+            {
+                return m[0][i] * (m[1][j] * m[3][k] - m[1][k] * m[3][j]) -
+                       m[0][j] * (m[1][i] * m[3][k] - m[1][k] * m[3][i]) +
+                       m[0][k] * (m[1][i] * m[3][j] - m[1][j] * m[3][i]);
+            };
+
+            const Real e[4] = {
+                minor(1, 2, 3),
+                -minor(0, 2, 3),
+                minor(0, 1, 3),
+                -minor(0, 1, 2),
+            };
+
+            const Real z = m[2][0] * e[0] + m[2][1] * e[1] + m[2][2] * e[2] + m[2][3] * e[3];
+            return z * e[3] > 0;
+        }
+    }  // namespace
+
+    Frustum::Frustum(const Mat4& viewProj)
+    {
+        extract(viewProj);
+    }
+
+    void Frustum::extract(const Mat4& viewProj)
+    {
+        const Real(*m)[4] = viewProj.m;
+
+        // -w <= x <= w, -w <= y <= w and 0 <= z <= w in clip space.
+        for (int j = 0; j < 4; ++j)
+        {
+            planes[FP_LEFT][j]   = m[3][j] + m[0][j];
+            planes[FP_RIGHT][j]  = m[3][j] - m[0][j];
+            planes[FP_BOTTOM][j] = m[3][j] + m[1][j];
+            planes[FP_TOP][j]    = m[3][j] - m[1][j];
+            planes[FP_NEAR][j]   = m[2][j];
+            planes[FP_FAR][j]    = m[3][j] - m[2][j];
+        }
+
+        // With reversed depth z = 0 is the far plane and z = w the near.
+        if (reversedDepth(m))
+            std::swap(planes[FP_NEAR], planes[FP_FAR]);
+
+        for (Real* p : planes)
+        {
+            const Real l = Vec3(p[0], p[1], p[2]).length();
+            if (isZero(l))
+            {
+                // The far plane of an infinite projection, which is
+                // 0 <= w and holds for every point in front.
+                p[0] = p[1] = p[2] = 0;
+                p[3]               = 1;
+            }
+            else
+            {
+                const Real r = 1 / l;
+                for (int j = 0; j < 4; ++j)
+                    p[j] *= r;
+            }
+        }
+    }
+
+    Plane Frustum::plane(const FrustumPlane i) const
+    {
+        const Vec3 n(planes[i][0], planes[i][1], planes[i][2]);
+        return Plane(n * -planes[i][3], n);
+    }
+
+    bool Frustum::contains(const Vec3& p) const
+    {
+        for (int i = 0; i < FP_MAX; ++i)
+        {
+            if (distance((FrustumPlane)i, p) < 0)
+                return false;
+        }
+        return true;
+    }
+
+    bool Frustum::intersects(const Box3d& bb) const
+    {
+        const Vec3 c = bb.center();
+        const Vec3 e = bb.extent() * Half;
+
+        for (const Real* p : planes)
+        {
+            const Real r = Abs(p[0]) * e.x + Abs(p[1]) * e.y + Abs(p[2]) * e.z;
+            if (p[0] * c.x + p[1] * c.y + p[2] * c.z + p[3] + r < 0)
+                return false;
+        }
+        return true;
+    }
+
+    bool Frustum::intersects(const Sphere& sp) const
+    {
+        for (int i = 0; i < FP_MAX; ++i)
+        {
+            if (distance((FrustumPlane)i, sp.center) + sp.radius < 0)
+                return false;
+        }
+        return true;
+    }
+
+    void Frustum::cull(uint32_t* visible, const Box3d* bounds, const size_t n) const
+    {
+        static_assert(sizeof(Box3d) == 6 * sizeof(Real));
+        Dispatch::kernels().cullBoxes(visible, planes[0], reinterpret_cast<const Real*>(bounds), n);
+    }
+
+    void Frustum::cull(uint32_t* visible, const Sphere* bounds, const size_t n) const
+    {
+        static_assert(sizeof(Sphere) == 4 * sizeof(Real));
+        Dispatch::kernels().cullSpheres(visible, planes[0], reinterpret_cast<const Real*>(bounds), n);
+    }
+
+}  // namespace Rt2::Math
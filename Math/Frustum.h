@@ -0,0 +1,87 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstdint>
+#include "Math/Box3d.h"
+#include "Math/Mat4.h"
+#include "Math/Plane.h"
+#include "Math/Sphere.h"
+
+namespace Rt2::Math
+{
+    enum FrustumPlane
+    {
+        FP_LEFT = 0,
+        FP_RIGHT,
+        FP_BOTTOM,
+        FP_TOP,
+        FP_NEAR,
+        FP_FAR,
+        FP_MAX,
+    };
+
+    // The six planes bounding the view volume of a view-projection
+    // matrix whose clip space depth is [0, 1], see Mat4::makePerspective.
+    // Reversed depth, as from Mat4::makeInfiniteReverseZ, is detected,
+    // so FP_NEAR is always the plane nearest the eye.
+    // Each plane is stored as a, b, c, d with a unit normal pointing
+    // inside, so a point p is inside when a*x + b*y + c*z + d >= 0.
+    class Frustum
+    {
+    public:
+        Real planes[FP_MAX][4]{};
+
+    public:
+        Frustum() = default;
+
+        explicit Frustum(const Mat4& viewProj);
+
+        void extract(const Mat4& viewProj);
+
+        // Plane i as a point and normal.
+        Plane plane(FrustumPlane i) const;
+
+        Real distance(FrustumPlane i, const Vec3& p) const;
+
+        bool contains(const Vec3& p) const;
+
+        // These are conservative, bounds that straddle two planes
+        // outside a corner of the frustum also pass.
+        bool intersects(const Box3d& bb) const;
+
+        bool intersects(const Sphere& sp) const;
+
+        // Visibility of n bounds as a bitmask. Bit i % 32 of
+        // visible[i / 32] is set when intersects(bounds[i]) is true,
+        // visible must hold (n + 31) / 32 words.
+        void cull(uint32_t* visible, const Box3d* bounds, size_t n) const;
+
+        void cull(uint32_t* visible, const Sphere* bounds, size_t n) const;
+    };
+
+    inline Real Frustum::distance(const FrustumPlane i, const Vec3& p) const
+    {
+        return planes[i][0] * p.x + planes[i][1] * p.y + planes[i][2] * p.z + planes[i][3];
+    }
+
+}  // namespace Rt2::Math
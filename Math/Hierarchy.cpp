@@ -0,0 +1,220 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Hierarchy.h"
+#include <cstring>
+#include "Math/Barrier.h"
+
+namespace Rt2::Math
+{
+    namespace
+    {
+        // Below this many nodes per thread, update(workers) runs serially.
+        constexpr size_t MinNodesPerWorker = 1024;
+    }  // namespace
+
+    void Hierarchy::reserve(const size_t size)
+    {
+        _local.reserve(size);
+        _world.reserve(size);
+        _parent.reserve(size);
+        _dirty.reserve(size);
+    }
+
+    void Hierarchy::clear()
+    {
+        _local.clear();
+        _world.clear();
+        _parent.clear();
+        _dirty.clear();
+        _order.clear();
+        _levelStart.clear();
+
+        _firstDirty  = 0;
+        _levelsValid = false;
+    }
+
+    int32_t Hierarchy::add(const int32_t parent, const Mat4& local)
+    {
+        const size_t i = size();
+        if (parent >= (int32_t)i)
+            return None;
+
+        _local.push_back(local);
+        _world.push_back(local);
+        _parent.push_back(parent < 0 ? None : parent);
+        _dirty.push_back(1);
+
+        if (i < _firstDirty)
+            _firstDirty = i;
+        _levelsValid = false;
+        return (int32_t)i;
+    }
+
+    void Hierarchy::invalidate()
+    {
+        if (!_dirty.empty())
+            std::memset(_dirty.data(), 1, _dirty.size());
+        _firstDirty = 0;
+    }
+
+    void Hierarchy::update()
+    {
+        const size_t n = size();
+
+        const int32_t* parent = _parent.data();
+        uint8_t*       dirty  = _dirty.data();
+
+        // Parents precede their children, so a node's flag is final
+        // once it has been combined with its parent's.
+        const auto test = [&](const size_t k)
+        {
+            if (!dirty[k] && parent[k] >= 0 && dirty[parent[k]])
+                dirty[k] = 1;
+            return dirty[k] != 0;
+        };
+
+        size_t i = _firstDirty;
+        while (i < n)
+        {
+            if (!test(i))
+            {
+                ++i;
+                continue;
+            }
+
+            // Composes each run of dirty nodes in one batch call. Runs
+            // are evaluated in order, so parents inside the run are
+            // ready before their children.
+            size_t j = i + 1;
+            while (j < n && test(j))
+                ++j;
+
+            Mat4::multiplyArrays(_world.data() + i, _world.data(), parent + i, _local.data() + i, j - i);
+            i = j;
+        }
+
+        if (_firstDirty < n)
+            std::memset(dirty + _firstDirty, 0, n - _firstDirty);
+        _firstDirty = n;
+    }
+
+    void Hierarchy::update(unsigned workers)
+    {
+        const size_t n = size();
+        if (_firstDirty >= n)
+            return;
+
+        if (workers > n / MinNodesPerWorker)
+            workers = (unsigned)(n / MinNodesPerWorker);
+        if (workers <= 1)
+        {
+            update();
+            return;
+        }
+
+        buildLevels();
+
+        const int32_t*  order  = _order.data();
+        const uint32_t* start  = _levelStart.data();
+        const size_t    levels = _levelStart.size() - 1;
+
+        const int32_t* parent = _parent.data();
+        const Mat4*    local  = _local.data();
+        Mat4*          world  = _world.data();
+        uint8_t*       dirty  = _dirty.data();
+
+        Barrier barrier(workers);
+
+        // Each level only reads the previous one, which the barrier
+        // guarantees is complete.
+        const auto run = [&](const size_t w)
+        {
+            for (size_t l = 0; l < levels; ++l)
+            {
+                const size_t b = start[l], c = start[l + 1] - b;
+                const size_t e = b + c * (w + 1) / workers;
+
+                for (size_t k = b + c * w / workers; k < e; ++k)
+                {
+                    const int32_t i = order[k], p = parent[i];
+                    if (p < 0)
+                    {
+                        if (dirty[i])
+                            world[i] = local[i];
+                    }
+                    else if (dirty[i] || dirty[p])
+                    {
+                        dirty[i] = 1;
+                        world[i] = world[p] * local[i];
+                    }
+                }
+                barrier.wait();
+            }
+        };
+
+        parallel(workers, run);
+
+        std::memset(dirty + _firstDirty, 0, n - _firstDirty);
+        _firstDirty = n;
+    }
+
+    size_t Hierarchy::levels()
+    {
+        buildLevels();
+        return _levelStart.size() - 1;
+    }
+
+    void Hierarchy::buildLevels()
+    {
+        if (_levelsValid)
+            return;
+
+        const size_t n = size();
+
+        AlignedArray<uint32_t> depth(n);
+        _levelStart.clear();
+        _levelStart.push_back(0);
+
+        // Counts nodes per depth in _levelStart[d + 1].
+        for (size_t i = 0; i < n; ++i)
+        {
+            const int32_t p = _parent[i];
+
+            depth[i] = p < 0 ? 0 : depth[p] + 1;
+            if (depth[i] + 1 >= _levelStart.size())
+                _levelStart.push_back(0);
+            ++_levelStart[depth[i] + 1];
+        }
+
+        for (size_t l = 1; l < _levelStart.size(); ++l)
+            _levelStart[l] += _levelStart[l - 1];
+
+        // Stable counting sort, so each level stays in index order.
+        AlignedArray<uint32_t> next(_levelStart);
+        _order.resize(n);
+        for (size_t i = 0; i < n; ++i)
+            _order[next[depth[i]]++] = (int32_t)i;
+
+        _levelsValid = true;
+    }
+
+}  // namespace Rt2::Math
@@ -0,0 +1,150 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstdint>
+#include "Math/AlignedArray.h"
+#include "Math/Mat4.h"
+
+namespace Rt2::Math
+{
+    // Local to world propagation for a tree of transforms.
+    //
+    // Nodes live in flat arrays ordered parent before child, so that a
+    // single forward pass composes every world matrix. Changing a local
+    // transform marks the node dirty, and update only recomputes dirty
+    // nodes and their descendants.
+    class Hierarchy
+    {
+    public:
+        static constexpr int32_t None = -1;
+
+    private:
+        AlignedArray<Mat4>    _local;
+        AlignedArray<Mat4>    _world;
+        AlignedArray<int32_t> _parent;
+        AlignedArray<uint8_t> _dirty;
+        size_t                _firstDirty{0};
+
+        // Node indices grouped by depth, level l is
+        // _order[_levelStart[l], _levelStart[l + 1]).
+        AlignedArray<int32_t>  _order;
+        AlignedArray<uint32_t> _levelStart;
+        bool                   _levelsValid{false};
+
+    public:
+        Hierarchy() = default;
+
+        void reserve(size_t size);
+
+        void clear();
+
+        // Appends a node and returns its index. parent must be None or
+        // the index of an existing node.
+        int32_t add(int32_t parent, const Mat4& local = Mat4::Identity);
+
+        void setLocal(size_t i, const Mat4& local);
+
+        void setLocal(size_t i, const Vec3& loc, const Vec3& scale, const Quat& rot);
+
+        // Flags i so that it and its descendants are recomputed.
+        void markDirty(size_t i);
+
+        // Flags every node.
+        void invalidate();
+
+        // Recomputes the world matrices of the dirty subtrees.
+        void update();
+
+        // The same, one depth level at a time with each level split
+        // between the given number of threads, the caller included.
+        void update(unsigned workers);
+
+        size_t size() const;
+
+        // The number of depth levels, the roots being level 0.
+        size_t levels();
+
+        bool dirty(size_t i) const;
+
+        int32_t parent(size_t i) const;
+
+        const Mat4& local(size_t i) const;
+
+        const Mat4& world(size_t i) const;
+
+        const Mat4* worlds() const;
+
+    private:
+        void buildLevels();
+    };
+
+    inline size_t Hierarchy::size() const
+    {
+        return _local.size();
+    }
+
+    inline bool Hierarchy::dirty(const size_t i) const
+    {
+        return _dirty[i] != 0;
+    }
+
+    inline int32_t Hierarchy::parent(const size_t i) const
+    {
+        return _parent[i];
+    }
+
+    inline const Mat4& Hierarchy::local(const size_t i) const
+    {
+        return _local[i];
+    }
+
+    inline const Mat4& Hierarchy::world(const size_t i) const
+    {
+        return _world[i];
+    }
+
+    inline const Mat4* Hierarchy::worlds() const
+    {
+        return _world.data();
+    }
+
+    inline void Hierarchy::markDirty(const size_t i)
+    {
+        _dirty[i] = 1;
+        if (i < _firstDirty)
+            _firstDirty = i;
+    }
+
+    inline void Hierarchy::setLocal(const size_t i, const Mat4& local)
+    {
+        _local[i] = local;
+        markDirty(i);
+    }
+
+    inline void Hierarchy::setLocal(const size_t i, const Vec3& loc, const Vec3& scale, const Quat& rot)
+    {
+        _local[i].makeTransform(loc, scale, rot);
+        markDirty(i);
+    }
+
+}  // namespace Rt2::Math
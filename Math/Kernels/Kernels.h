@@ -0,0 +1,203 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Math/Scalar.h"
+
+namespace Rt2::Math
+{
+    struct Vec3Out
+    {
+        Real* x;
+        Real* y;
+        Real* z;
+    };
+
+    struct Vec3In
+    {
+        const Real* x;
+        const Real* y;
+        const Real* z;
+    };
+
+    struct QuatOut
+    {
+        Real* w;
+        Real* x;
+        Real* y;
+        Real* z;
+    };
+
+    struct QuatIn
+    {
+        const Real* w;
+        const Real* x;
+        const Real* y;
+        const Real* z;
+    };
+
+    // Structure of arrays boxes, see Box3dArray.
+    struct Box3dIn
+    {
+        const Real* min[3];
+        const Real* max[3];
+    };
+
+    // Rows of a ray packet, see TRayPacket.
+    enum RayPacketRow
+    {
+        RP_OX = 0,
+        RP_OY,
+        RP_OZ,
+        RP_DX,
+        RP_DY,
+        RP_DZ,
+        RP_IX,
+        RP_IY,
+        RP_IZ,
+        RP_NEAR,
+        RP_FAR,
+        RP_MAX,
+    };
+
+    // Batch entry points. Each instruction set variant in Kernels/
+    // fills in one table; Dispatch selects the table for the running cpu.
+    struct KernelTable
+    {
+        void (*vec3Add)(const Vec3Out& d, const Vec3In& a, const Vec3In& b, size_t n);
+        void (*vec3Sub)(const Vec3Out& d, const Vec3In& a, const Vec3In& b, size_t n);
+        void (*vec3Mul)(const Vec3Out& d, const Vec3In& a, const Vec3In& b, size_t n);
+        void (*vec3Scale)(const Vec3Out& d, const Vec3In& a, Real s, size_t n);
+        void (*vec3Cross)(const Vec3Out& d, const Vec3In& a, const Vec3In& b, size_t n);
+        void (*vec3Dot)(Real* d, const Vec3In& a, const Vec3In& b, size_t n);
+        void (*vec3Length)(Real* d, const Vec3In& a, size_t n);
+        void (*vec3Normalize)(const Vec3Out& d, const Vec3In& a, size_t n);
+
+        // d[i] = a[i] + (b[i] - a[i]) * t[i]
+        void (*realLerp)(Real* d, const Real* a, const Real* b, const Real* t, size_t n);
+
+        // Quaternion arithmetic, see Quat. quatInverse divides the
+        // conjugate by the squared length. For quatRotate, d[i] = q[i] * v[i],
+        // or q[qi[i]] * v[i] when qi is not null.
+        void (*quatMul)(const QuatOut& d, const QuatIn& a, const QuatIn& b, size_t n);
+        void (*quatRotate)(const Vec3Out& d, const QuatIn& q, const uint32_t* qi, const Vec3In& v, size_t n);
+        void (*quatNormalize)(const QuatOut& d, const QuatIn& a, size_t n);
+        void (*quatConjugate)(const QuatOut& d, const QuatIn& a, size_t n);
+        void (*quatInverse)(const QuatOut& d, const QuatIn& a, size_t n);
+
+        // Interpolation of n quaternion pairs, see Quat::nlerp, slerp
+        // and fastSlerp. t holds n factors, or is null to use ts for all.
+        void (*quatNlerp)(const QuatOut& d, const QuatIn& a, const QuatIn& b, const Real* t, Real ts, size_t n);
+        void (*quatSlerp)(const QuatOut& d, const QuatIn& a, const QuatIn& b, const Real* t, Real ts, size_t n);
+        void (*quatFastSlerp)(const QuatOut& d, const QuatIn& a, const QuatIn& b, const Real* t, Real ts, size_t n);
+
+        // rgba holds 4 * n interleaved components.
+        void (*colorToInt)(uint32_t* d, const Real* rgba, size_t n);
+        void (*intToColor)(Real* rgba, const uint32_t* s, size_t n);
+
+        // Precision conversion of n scalars.
+        void (*narrow)(float* d, const double* s, size_t n);
+        void (*widen)(double* d, const float* s, size_t n);
+
+        // Packed storage of n scalars as IEEE halves or as snorm16.
+        void (*toHalf)(uint16_t* d, const Real* s, size_t n);
+        void (*fromHalf)(Real* d, const uint16_t* s, size_t n);
+        void (*toSnorm16)(int16_t* d, const Real* s, size_t n);
+        void (*fromSnorm16)(Real* d, const int16_t* s, size_t n);
+
+        // Smallest three encoding of n unit quaternions, see
+        // PackedQuat32 and PackedQuat48. q holds 4 * n interleaved w, x,
+        // y, z components, the 48-bit form 3 * n words.
+        void (*quatToSmallest32)(uint32_t* d, const Real* q, size_t n);
+        void (*quatFromSmallest32)(Real* q, const uint32_t* s, size_t n);
+        void (*quatToSmallest48)(uint16_t* d, const Real* q, size_t n);
+        void (*quatFromSmallest48)(Real* q, const uint16_t* s, size_t n);
+
+        // Row major 4x4 matrices, 16 scalars each. d[i] = a[i] * b[i], and
+        // for the indexed form d[i] = a[ai[i]] * b[i], or b[i] if ai[i] < 0.
+        void (*mat4Mul)(Real* d, const Real* a, const Real* b, size_t n);
+        void (*mat4MulIndexed)(Real* d, const Real* a, const int32_t* ai, const Real* b, size_t n);
+
+        // d[i] = inverse of s[i], or identity if singular, and the
+        // determinants of s. The inverse may be done in place.
+        void (*mat4Invert)(Real* d, const Real* s, size_t n);
+        void (*mat4Det)(Real* d, const Real* s, size_t n);
+
+        // The same for the 12 scalars of Affine3.
+        void (*affineMul)(Real* d, const Real* a, const Real* b, size_t n);
+        void (*affineMulIndexed)(Real* d, const Real* a, const int32_t* ai, const Real* b, size_t n);
+
+        // n transforms from loc and scale, 3 * n scalars each, and rot,
+        // 4 * n scalars as w, x, y, z. See Mat4::makeTransform and
+        // Mat4::makeInverseTransform.
+        void (*mat4Compose)(Real* d, const Real* loc, const Real* scale, const Real* rot, size_t n);
+        void (*mat4ComposeInverse)(Real* d, const Real* loc, const Real* scale, const Real* rot, size_t n);
+        void (*affineCompose)(Real* d, const Real* loc, const Real* scale, const Real* rot, size_t n);
+
+        // Visibility of n bounds against the 6 planes of a Frustum, 24
+        // scalars as a, b, c, d. Bit i % 32 of d[i / 32] is set when
+        // bounds i is not entirely outside a plane. boxes hold 6 * n
+        // scalars as Box3d, spheres 4 * n as Sphere.
+        void (*cullBoxes)(uint32_t* d, const Real* planes, const Real* boxes, size_t n);
+        void (*cullSpheres)(uint32_t* d, const Real* planes, const Real* spheres, size_t n);
+
+        // Skinning of n vertices with four influences each, see
+        // Skinning. The palette holds stride scalars per joint, of which
+        // the first 12 are the top rows of the joint matrix, or 8 per
+        // joint for DualQuat. Normals are skipped when dn.x is null.
+        void (*skinLinear)(const Vec3Out& dp, const Vec3Out& dn, const Vec3In& p, const Vec3In& nr, const uint16_t* joints, const Real* weights, const Real* palette, size_t stride, size_t n);
+        void (*skinDualQuat)(const Vec3Out& dp, const Vec3Out& dn, const Vec3In& p, const Vec3In& nr, const uint16_t* joints, const Real* weights, const Real* palette, size_t n);
+
+        // Box3dArray tests of n boxes, writing a bit per box to
+        // (n + 31) / 32 words of d. box3dHit tests one ray, given as origin,
+        // inverse direction and sign as in PreparedRay, and writes the
+        // entry distance of each box to t when not null. box3dBounds
+        // writes the merge of all boxes to bMin and bMax.
+        void (*box3dHit)(uint32_t* d, Real* t, const Box3dIn& b, const Real* origin, const Real* invDir, const int* sign, Real tNear, Real tFar, size_t n);
+        void (*box3dContains)(uint32_t* d, const Box3dIn& b, const Real* qMin, const Real* qMax, size_t n);
+        void (*box3dOverlaps)(uint32_t* d, const Box3dIn& b, const Real* qMin, const Real* qMax, size_t n);
+        void (*box3dBounds)(Real* bMin, Real* bMax, const Box3dIn& b, size_t n);
+
+        // Ray packets, see TRayPacket. packet holds RP_MAX rows of width
+        // scalars. Both return a bit per lane that hits. The box form
+        // writes the entry and exit distances to r0 and r1 and the
+        // sphere form the hit distance to d, each when not null.
+        uint32_t (*rayPacketBox)(Real* r0, Real* r1, const Real* packet, size_t width, const Real* bMin, const Real* bMax);
+        uint32_t (*rayPacketSphere)(Real* d, const Real* packet, size_t width, const Real* center, Real radius);
+
+        // Strided Vec3 arrays, see Transform::apply. ds and ss are in bytes.
+        void (*transformPoints)(Real* d, size_t ds, const Real* s, size_t ss, const Real* m, size_t n);
+        void (*transformDirections)(Real* d, size_t ds, const Real* s, size_t ss, const Real* m, size_t n);
+        void (*transformProjective)(Real* d, size_t ds, const Real* s, size_t ss, const Real* m, size_t n);
+    };
+
+    namespace Kernels
+    {
+        void bindBase(KernelTable& table);
+        void bindSse41(KernelTable& table);
+        void bindAvx2(KernelTable& table);
+        void bindAvx512(KernelTable& table);
+    }  // namespace Kernels
+
+}  // namespace Rt2::Math
@@ -0,0 +1,1336 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+
+// Kernel bodies shared by every instruction set variant. Each
+// KernelsXxx.cpp defines Math_KERNEL_BIND and includes this file;
+// the build compiles that file for the matching instruction set.
+//
+// Only Scalar.h, Simd.h and Kernels.h may be included here. Inline
+// functions from the other headers would be compiled for the variant's
+// instruction set and could be picked by the linker for every caller.
+
+#include "Math/Kernels/Kernels.h"
+#include "Math/Simd.h"
+
+#ifndef Math_KERNEL_BIND
+    #error Math_KERNEL_BIND must name the bind function of the variant
+#endif
+
+namespace Rt2::Math::Kernels
+{
+    namespace
+    {
+        using namespace Simd;
+
+        void vec3Add(const Vec3Out& d, const Vec3In& a, const Vec3In& b, const size_t n)
+        {
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       io.st(d.x + i, io.ld(a.x + i) + io.ld(b.x + i));
+                       io.st(d.y + i, io.ld(a.y + i) + io.ld(b.y + i));
+                       io.st(d.z + i, io.ld(a.z + i) + io.ld(b.z + i));
+                   });
+        }
+
+        void vec3Sub(const Vec3Out& d, const Vec3In& a, const Vec3In& b, const size_t n)
+        {
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       io.st(d.x + i, io.ld(a.x + i) - io.ld(b.x + i));
+                       io.st(d.y + i, io.ld(a.y + i) - io.ld(b.y + i));
+                       io.st(d.z + i, io.ld(a.z + i) - io.ld(b.z + i));
+                   });
+        }
+
+        void vec3Mul(const Vec3Out& d, const Vec3In& a, const Vec3In& b, const size_t n)
+        {
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       io.st(d.x + i, io.ld(a.x + i) * io.ld(b.x + i));
+                       io.st(d.y + i, io.ld(a.y + i) * io.ld(b.y + i));
+                       io.st(d.z + i, io.ld(a.z + i) * io.ld(b.z + i));
+                   });
+        }
+
+        void vec3Scale(const Vec3Out& d, const Vec3In& a, const Real s, const size_t n)
+        {
+            const Pack sp = splat(s);
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       io.st(d.x + i, io.ld(a.x + i) * sp);
+                       io.st(d.y + i, io.ld(a.y + i) * sp);
+                       io.st(d.z + i, io.ld(a.z + i) * sp);
+                   });
+        }
+
+        void vec3Cross(const Vec3Out& d, const Vec3In& a, const Vec3In& b, const size_t n)
+        {
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const Pack ax = io.ld(a.x + i), ay = io.ld(a.y + i), az = io.ld(a.z + i);
+                       const Pack bx = io.ld(b.x + i), by = io.ld(b.y + i), bz = io.ld(b.z + i);
+
+                       io.st(d.x + i, nmadd(az, by, ay * bz));
+                       io.st(d.y + i, nmadd(ax, bz, az * bx));
+                       io.st(d.z + i, nmadd(ay, bx, ax * by));
+                   });
+        }
+
+        void vec3Dot(Real* d, const Vec3In& a, const Vec3In& b, const size_t n)
+        {
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       Pack r = io.ld(a.x + i) * io.ld(b.x + i);
+                       r      = madd(io.ld(a.y + i), io.ld(b.y + i), r);
+                       r      = madd(io.ld(a.z + i), io.ld(b.z + i), r);
+                       io.st(d + i, r);
+                   });
+        }
+
+        void vec3Length(Real* d, const Vec3In& a, const size_t n)
+        {
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const Pack x = io.ld(a.x + i), y = io.ld(a.y + i), z = io.ld(a.z + i);
+                       io.st(d + i, sqrt(madd(z, z, madd(y, y, x * x))));
+                   });
+        }
+
+        void vec3Normalize(const Vec3Out& d, const Vec3In& a, const size_t n)
+        {
+            const Pack ep = splat(Epsilon);
+            const Pack on = splat(Real(1));
+
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const Pack x = io.ld(a.x + i), y = io.ld(a.y + i), z = io.ld(a.z + i);
+                       const Pack l = madd(z, z, madd(y, y, x * x));
+
+                       // Matches Vec3::normalize, vectors at or below
+                       // Epsilon squared length are left unchanged.
+                       const Pack rs = select(l > ep, rsqrt(l), on);
+                       io.st(d.x + i, x * rs);
+                       io.st(d.y + i, y * rs);
+                       io.st(d.z + i, z * rs);
+                   });
+        }
+
+        void realLerp(Real* d, const Real* a, const Real* b, const Real* t, const size_t n)
+        {
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const Pack pa = io.ld(a + i);
+                       io.st(d + i, madd(io.ld(b + i) - pa, io.ld(t + i), pa));
+                   });
+        }
+
+        // r = a x b for packed vectors.
+        void cross(Pack* r, const Pack* a, const Pack* b)
+        {
+            r[0] = nmadd(a[2], b[1], a[1] * b[2]);
+            r[1] = nmadd(a[0], b[2], a[2] * b[0]);
+            r[2] = nmadd(a[1], b[0], a[0] * b[1]);
+        }
+
+        void quatMul(const QuatOut& d, const QuatIn& a, const QuatIn& b, const size_t n)
+        {
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const Pack aw = io.ld(a.w + i), ax = io.ld(a.x + i), ay = io.ld(a.y + i), az = io.ld(a.z + i);
+                       const Pack bw = io.ld(b.w + i), bx = io.ld(b.x + i), by = io.ld(b.y + i), bz = io.ld(b.z + i);
+
+                       io.st(d.w + i, nmadd(az, bz, nmadd(ay, by, nmadd(ax, bx, aw * bw))));
+                       io.st(d.x + i, nmadd(az, by, madd(ay, bz, madd(ax, bw, aw * bx))));
+                       io.st(d.y + i, nmadd(ax, bz, madd(az, bx, madd(ay, bw, aw * by))));
+                       io.st(d.z + i, nmadd(ay, bx, madd(ax, by, madd(az, bw, aw * bz))));
+                   });
+        }
+
+        // v + 2 * w * (q x v) + 2 * q x (q x v), as Quat::operator*.
+        void quatRotate(const Vec3Out& d, const QuatIn& q, const uint32_t* qi, const Vec3In& v, const size_t n)
+        {
+            const Pack tw = splat(Real(2));
+
+            Real g[4][Lanes];
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       Pack r[4];
+                       if (qi)
+                       {
+                           const size_t c = n - i < (size_t)Lanes ? n - i : (size_t)Lanes;
+                           for (size_t l = 0; l < (size_t)Lanes; ++l)
+                           {
+                               const uint32_t k = qi[l < c ? i + l : i];
+
+                               g[0][l] = q.w[k];
+                               g[1][l] = q.x[k];
+                               g[2][l] = q.y[k];
+                               g[3][l] = q.z[k];
+                           }
+                           for (int j = 0; j < 4; ++j)
+                               r[j] = load(g[j]);
+                       }
+                       else
+                       {
+                           r[0] = io.ld(q.w + i);
+                           r[1] = io.ld(q.x + i);
+                           r[2] = io.ld(q.y + i);
+                           r[3] = io.ld(q.z + i);
+                       }
+
+                       const Pack p[3] = {io.ld(v.x + i), io.ld(v.y + i), io.ld(v.z + i)};
+
+                       Pack a[3], b[3];
+                       cross(a, r + 1, p);
+                       cross(b, r + 1, a);
+
+                       const Pack ws = tw * r[0];
+                       io.st(d.x + i, madd(tw, b[0], madd(ws, a[0], p[0])));
+                       io.st(d.y + i, madd(tw, b[1], madd(ws, a[1], p[1])));
+                       io.st(d.z + i, madd(tw, b[2], madd(ws, a[2], p[2])));
+                   });
+        }
+
+        // Matches Quat::normalize, quaternions at or below Epsilon
+        // squared length are left unchanged.
+        void quatNormalize(const QuatOut& d, const QuatIn& a, const size_t n)
+        {
+            const Pack ep = splat(Epsilon);
+            const Pack on = splat(Real(1));
+
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const Pack w = io.ld(a.w + i), x = io.ld(a.x + i), y = io.ld(a.y + i), z = io.ld(a.z + i);
+                       const Pack l  = madd(z, z, madd(y, y, madd(x, x, w * w)));
+                       const Pack rs = select(l > ep, rsqrt(l), on);
+                       io.st(d.w + i, w * rs);
+                       io.st(d.x + i, x * rs);
+                       io.st(d.y + i, y * rs);
+                       io.st(d.z + i, z * rs);
+                   });
+        }
+
+        void quatConjugate(const QuatOut& d, const QuatIn& a, const size_t n)
+        {
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       io.st(d.w + i, io.ld(a.w + i));
+                       io.st(d.x + i, -io.ld(a.x + i));
+                       io.st(d.y + i, -io.ld(a.y + i));
+                       io.st(d.z + i, -io.ld(a.z + i));
+                   });
+        }
+
+        // The conjugate over the squared length, or the quaternion
+        // unchanged at or below Epsilon squared length.
+        void quatInverse(const QuatOut& d, const QuatIn& a, const size_t n)
+        {
+            const Pack ep = splat(Epsilon);
+            const Pack on = splat(Real(1));
+
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const Pack w = io.ld(a.w + i), x = io.ld(a.x + i), y = io.ld(a.y + i), z = io.ld(a.z + i);
+                       const Pack l  = madd(z, z, madd(y, y, madd(x, x, w * w)));
+                       const Mask ok = l > ep;
+                       const Pack r  = on / select(ok, l, on);
+                       const Pack rn = select(ok, -r, on);
+                       io.st(d.w + i, w * r);
+                       io.st(d.x + i, x * rn);
+                       io.st(d.y + i, y * rn);
+                       io.st(d.z + i, z * rn);
+                   });
+        }
+
+        enum QuatBlend
+        {
+            QB_NLERP,
+            QB_SLERP,
+            QB_FAST_SLERP,
+        };
+
+        // Blends a and b with weights from Blend, matching the scalar
+        // Quat forms, and normalizes the result.
+        template <QuatBlend Blend>
+        void quatBlend(const QuatOut& d, const QuatIn& a, const QuatIn& b, const Real* t, const Real ts, const size_t n)
+        {
+            // Quat::SlerpLinear, which cannot be included here.
+            constexpr Real SlerpLinear = Real(1e-4);
+
+            const Pack ep = splat(Epsilon);
+            const Pack on = splat(Real(1));
+            const Pack hf = splat(Real(0.5));
+
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const Pack aw = io.ld(a.w + i), ax = io.ld(a.x + i), ay = io.ld(a.y + i), az = io.ld(a.z + i);
+                       const Pack bw = io.ld(b.w + i), bx = io.ld(b.x + i), by = io.ld(b.y + i), bz = io.ld(b.z + i);
+                       const Pack tp = t ? io.ld(t + i) : splat(ts);
+
+                       const Pack ca = madd(az, bz, madd(ay, by, madd(ax, bx, aw * bw)));
+                       const Pack c  = abs(ca);
+
+                       Pack wa, wb;
+                       if constexpr (Blend == QB_NLERP)
+                       {
+                           wa = on - tp;
+                           wb = tp;
+                       }
+                       else if constexpr (Blend == QB_FAST_SLERP)
+                       {
+                           const Pack ka = madd(c, madd(c, nmadd(c, splat(Real(1.43519)), splat(Real(3.55645))), splat(Real(-3.2452))), splat(Real(1.0904)));
+                           const Pack kb = madd(c, madd(c, splat(Real(0.215638)), splat(Real(-1.06021))), splat(Real(0.848013)));
+                           const Pack h  = tp - hf;
+                           const Pack ot = madd(tp * h * (tp - on), madd(ka, h * h, kb), tp);
+
+                           wa = on - ot;
+                           wb = ot;
+                       }
+                       else
+                       {
+                           // No packed acos or sin, the weights are
+                           // found per lane.
+                           Real cl[Lanes], tl[Lanes], al[Lanes], bl[Lanes];
+                           store(cl, c);
+                           store(tl, tp);
+                           for (int l = 0; l < Lanes; ++l)
+                           {
+                               if (cl[l] > Real(1) - SlerpLinear)
+                               {
+                                   al[l] = Real(1) - tl[l];
+                                   bl[l] = tl[l];
+                               }
+                               else
+                               {
+                                   const Real theta = std::acos(cl[l]);
+                                   const Real rs    = Real(1) / std::sin(theta);
+
+                                   al[l] = std::sin((Real(1) - tl[l]) * theta) * rs;
+                                   bl[l] = std::sin(tl[l] * theta) * rs;
+                               }
+                           }
+                           wa = load(al);
+                           wb = load(bl);
+                       }
+                       wb = select(ca < zero(), -wb, wb);
+
+                       const Pack rw = madd(bw, wb, aw * wa);
+                       const Pack rx = madd(bx, wb, ax * wa);
+                       const Pack ry = madd(by, wb, ay * wa);
+                       const Pack rz = madd(bz, wb, az * wa);
+                       const Pack l  = madd(rz, rz, madd(ry, ry, madd(rx, rx, rw * rw)));
+                       const Pack rs = select(l > ep, rsqrt(l), on);
+                       io.st(d.w + i, rw * rs);
+                       io.st(d.x + i, rx * rs);
+                       io.st(d.y + i, ry * rs);
+                       io.st(d.z + i, rz * rs);
+                   });
+        }
+
+        // Same byte layout as ColorUtils::convert(U32&, const Color&),
+        // 0xRRGGBBAA with each channel truncated from [0, 1] * 255.
+        void colorToInt(uint32_t* d, const Real* rgba, const size_t n)
+        {
+            const Pack   sc = splat(Real(255));
+            const size_t nc = 4 * n;
+
+            int32_t t[Lanes < 4 ? 4 : Lanes];
+            stream(nc,
+                   [&](const size_t i, const auto& io)
+                   {
+                       toInt(t, io.ld(rgba + i) * sc);
+
+                       // A pack covers Lanes / 4 colors, or a 2 lane pack
+                       // covers half of one.
+                       for (size_t k = 0; k < (size_t)Lanes && i + k < nc; ++k)
+                       {
+                           const size_t c = (i + k) >> 2;
+                           const size_t s = 24 - ((i + k) & 3) * 8;
+                           if (((i + k) & 3) == 0)
+                               d[c] = 0;
+                           d[c] |= ((uint32_t)t[k] & 0xFF) << s;
+                       }
+                   });
+        }
+
+        void intToColor(Real* rgba, const uint32_t* s, const size_t n)
+        {
+            const Pack   sc = splat(Real(1.0 / 255.0));
+            const size_t nc = 4 * n;
+
+            int32_t t[Lanes];
+            stream(nc,
+                   [&](const size_t i, const auto& io)
+                   {
+                       for (size_t k = 0; k < (size_t)Lanes; ++k)
+                       {
+                           const size_t j = i + k;
+                           t[k]           = j < nc ? (int32_t)(s[j >> 2] >> (24 - (j & 3) * 8) & 0xFF) : 0;
+                       }
+                       io.st(rgba + i, fromInt(t) * sc);
+                   });
+        }
+
+        // Same rounding as Snorm16::encode, the clamped value is scaled
+        // by 32767 and rounded half away from zero.
+        void toSnorm16(int16_t* d, const Real* s, const size_t n)
+        {
+            const Pack lo = splat(Real(-1)), hi = splat(Real(1));
+            const Pack sc = splat(Real(32767));
+            const Pack hn = splat(-Half), hp = splat(Half);
+
+            int32_t t[Lanes];
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const Pack v = min(max(io.ld(s + i), lo), hi) * sc;
+                       toInt(t, v + select(v < zero(), hn, hp));
+
+                       for (size_t k = 0; k < (size_t)Lanes && i + k < n; ++k)
+                           d[i + k] = (int16_t)t[k];
+                   });
+        }
+
+        void fromSnorm16(Real* d, const int16_t* s, const size_t n)
+        {
+            const Pack lo = splat(Real(-1));
+            const Pack sc = splat(Real(1.0 / 32767.0));
+
+            int32_t t[Lanes];
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       for (size_t k = 0; k < (size_t)Lanes; ++k)
+                           t[k] = i + k < n ? s[i + k] : 0;
+                       io.st(d + i, max(fromInt(t) * sc, lo));
+                   });
+        }
+
+        // Smallest three quaternions, see SmallestThree in Packed.h.
+        // S is uint32_t for 10 bits per component, and uint16_t with
+        // three words per quaternion for 15 bits.
+        template <int Bits, typename S>
+        void quatToSmallest(S* d, const Real* q, const size_t n)
+        {
+            constexpr Real Max = Real((1u << Bits) - 1);
+
+            const Pack sc = splat(Max * Real(0.70710678118654752440));
+            const Pack bs = splat(Max * Half + Half);
+            const Pack hi = splat(Max);
+            const Pack on = splat(Real(1));
+
+            Real    c[4][Lanes];
+            int32_t t[4][Lanes];
+            for (size_t i = 0; i < n; i += Lanes)
+            {
+                const size_t cn = n - i < (size_t)Lanes ? n - i : (size_t)Lanes;
+                for (size_t l = 0; l < (size_t)Lanes; ++l)
+                {
+                    for (size_t j = 0; j < 4; ++j)
+                        c[j][l] = l < cn ? q[4 * (i + l) + j] : Real(j == 0);
+                }
+
+                const Pack w = load(c[0]), x = load(c[1]), y = load(c[2]), z = load(c[3]);
+
+                // The largest magnitude, the first one on ties.
+                Pack m = w, mx = abs(w), id = zero();
+                for (int k = 1; k < 4; ++k)
+                {
+                    const Pack v = k == 1 ? x : k == 2 ? y : z;
+                    const Pack a = abs(v);
+                    const Mask g = a > mx;
+
+                    mx = select(g, a, mx);
+                    m  = select(g, v, m);
+                    id = select(g, splat(Real(k)), id);
+                }
+                const Pack sg = select(m < zero(), -on, on);
+
+                const Pack r0 = select(id > splat(Real(0.5)), w, x);
+                const Pack r1 = select(id > splat(Real(1.5)), x, y);
+                const Pack r2 = select(id > splat(Real(2.5)), y, z);
+                toInt(t[0], min(max(r0 * sg * sc + bs, zero()), hi));
+                toInt(t[1], min(max(r1 * sg * sc + bs, zero()), hi));
+                toInt(t[2], min(max(r2 * sg * sc + bs, zero()), hi));
+                toInt(t[3], id);
+
+                for (size_t l = 0; l < cn; ++l)
+                {
+                    const uint64_t v = (uint64_t)t[3][l] << 3 * Bits |
+                                       (uint64_t)t[0][l] << 2 * Bits |
+                                       (uint64_t)t[1][l] << Bits |
+                                       (uint64_t)t[2][l];
+                    if constexpr (sizeof(S) == 4)
+                        d[i + l] = (S)v;
+                    else
+                    {
+                        S* p = d + 3 * (i + l);
+
+                        p[0] = (S)v;
+                        p[1] = (S)(v >> 16);
+                        p[2] = (S)(v >> 32);
+                    }
+                }
+            }
+        }
+
+        template <int Bits, typename S>
+        void quatFromSmallest(Real* q, const S* s, const size_t n)
+        {
+            constexpr uint32_t Max = (1u << Bits) - 1;
+
+            const Pack st = splat(Real(1.41421356237309504880) / Real(Max));
+            const Pack lo = splat(Real(0.70710678118654752440));
+            const Pack on = splat(Real(1));
+
+            Real    c[4][Lanes];
+            int32_t t[4][Lanes];
+            for (size_t i = 0; i < n; i += Lanes)
+            {
+                const size_t cn = n - i < (size_t)Lanes ? n - i : (size_t)Lanes;
+                for (size_t l = 0; l < (size_t)Lanes; ++l)
+                {
+                    uint64_t v = 0;
+                    if (l < cn)
+                    {
+                        if constexpr (sizeof(S) == 4)
+                            v = s[i + l];
+                        else
+                        {
+                            const S* p = s + 3 * (i + l);
+
+                            v = (uint64_t)p[0] | (uint64_t)p[1] << 16 | (uint64_t)p[2] << 32;
+                        }
+                    }
+
+                    t[2][l] = (int32_t)(v & Max);
+                    t[1][l] = (int32_t)(v >> Bits & Max);
+                    t[0][l] = (int32_t)(v >> 2 * Bits & Max);
+                    t[3][l] = (int32_t)(v >> 3 * Bits & 3);
+                }
+
+                const Pack a0 = fromInt(t[0]) * st - lo;
+                const Pack a1 = fromInt(t[1]) * st - lo;
+                const Pack a2 = fromInt(t[2]) * st - lo;
+                const Pack id = fromInt(t[3]);
+                const Pack bg = sqrt(max(on - a0 * a0 - a1 * a1 - a2 * a2, zero()));
+
+                const Mask i0 = id < splat(Real(0.5));
+                const Mask i1 = id < splat(Real(1.5));
+                const Mask i2 = id < splat(Real(2.5));
+                store(c[0], select(i0, bg, a0));
+                store(c[1], select(i0, a0, select(i1, bg, a1)));
+                store(c[2], select(i1, a1, select(i2, bg, a2)));
+                store(c[3], select(i2, a2, bg));
+
+                for (size_t l = 0; l < cn; ++l)
+                {
+                    for (size_t j = 0; j < 4; ++j)
+                        q[4 * (i + l) + j] = c[j][l];
+                }
+            }
+        }
+
+        // Products of n matrices of Size scalars, d[i] = a[i] * b[i].
+        template <size_t Size, void (*Mul)(Real*, const Real*, const Real*)>
+        void mulArrays(Real* d, const Real* a, const Real* b, const size_t n)
+        {
+            for (size_t i = 0; i < n; ++i)
+                Mul(d + Size * i, a + Size * i, b + Size * i);
+        }
+
+        // Runs strictly in order, a may be d with ai[i] < i.
+        template <size_t Size, void (*Mul)(Real*, const Real*, const Real*)>
+        void mulIndexed(Real* d, const Real* a, const int32_t* ai, const Real* b, const size_t n)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                Real* di = d + Size * i;
+                if (ai[i] < 0)
+                {
+                    for (size_t k = 0; k < Size; ++k)
+                        di[k] = b[Size * i + k];
+                }
+                else
+                    Mul(di, a + Size * (size_t)ai[i], b + Size * i);
+            }
+        }
+
+        // Loads Lanes 4x4 matrices starting at s + 16 * i with each
+        // element in its own pack, repeating the first matrix past n.
+        void gather4x4(Pack* a, const Real* s, const size_t i, const size_t n)
+        {
+            Real t[Lanes];
+            for (int j = 0; j < 16; ++j)
+            {
+                for (size_t k = 0; k < (size_t)Lanes; ++k)
+                    t[k] = s[16 * (i + k < n ? i + k : i) + j];
+                a[j] = load(t);
+            }
+        }
+
+        // The 2x2 minors of the top rows, s, and bottom rows, c, of a
+        // row major 4x4 matrix. Mat4::inverted uses the same names.
+        struct Minors
+        {
+            Pack s[6], c[6];
+
+            explicit Minors(const Pack* a)
+            {
+                s[0] = nmadd(a[4], a[1], a[0] * a[5]);
+                s[1] = nmadd(a[4], a[2], a[0] * a[6]);
+                s[2] = nmadd(a[4], a[3], a[0] * a[7]);
+                s[3] = nmadd(a[5], a[2], a[1] * a[6]);
+                s[4] = nmadd(a[5], a[3], a[1] * a[7]);
+                s[5] = nmadd(a[6], a[3], a[2] * a[7]);
+
+                c[0] = nmadd(a[12], a[9], a[8] * a[13]);
+                c[1] = nmadd(a[12], a[10], a[8] * a[14]);
+                c[2] = nmadd(a[12], a[11], a[8] * a[15]);
+                c[3] = nmadd(a[13], a[10], a[9] * a[14]);
+                c[4] = nmadd(a[13], a[11], a[9] * a[15]);
+                c[5] = nmadd(a[14], a[11], a[10] * a[15]);
+            }
+
+            Pack det() const
+            {
+                Pack r = s[0] * c[5];
+                r      = nmadd(s[1], c[4], r);
+                r      = madd(s[2], c[3], r);
+                r      = madd(s[3], c[2], r);
+                r      = nmadd(s[4], c[1], r);
+                return madd(s[5], c[0], r);
+            }
+        };
+
+        void mat4Det(Real* d, const Real* s, const size_t n)
+        {
+            Pack a[16];
+            Real t[Lanes];
+            for (size_t i = 0; i < n; i += Lanes)
+            {
+                gather4x4(a, s, i, n);
+                store(t, Minors(a).det());
+                for (size_t k = 0; k < (size_t)Lanes && i + k < n; ++k)
+                    d[i + k] = t[k];
+            }
+        }
+
+        void mat4Invert(Real* d, const Real* s, const size_t n)
+        {
+            const Pack ep = splat(Epsilon);
+            const Pack on = splat(Real(1));
+            const Pack zr = zero();
+
+            Pack a[16], r[16];
+            Real t[16][Lanes];
+            for (size_t i = 0; i < n; i += Lanes)
+            {
+                gather4x4(a, s, i, n);
+
+                const Minors mi(a);
+                const Pack*  ms = mi.s;
+                const Pack*  mc = mi.c;
+
+                // Matches Mat4::inverted, singular lanes become identity.
+                const Pack det = mi.det();
+                const Mask sg  = abs(det) < ep;
+                const Pack id  = select(sg, zr, on / det);
+
+                r[0]  = madd(a[7], mc[3], nmadd(a[6], mc[4], a[5] * mc[5]));
+                r[1]  = nmadd(a[3], mc[3], madd(a[2], mc[4], zr - a[1] * mc[5]));
+                r[2]  = madd(a[15], ms[3], nmadd(a[14], ms[4], a[13] * ms[5]));
+                r[3]  = nmadd(a[11], ms[3], madd(a[10], ms[4], zr - a[9] * ms[5]));
+                r[4]  = nmadd(a[7], mc[1], madd(a[6], mc[2], zr - a[4] * mc[5]));
+                r[5]  = madd(a[3], mc[1], nmadd(a[2], mc[2], a[0] * mc[5]));
+                r[6]  = nmadd(a[15], ms[1], madd(a[14], ms[2], zr - a[12] * ms[5]));
+                r[7]  = madd(a[11], ms[1], nmadd(a[10], ms[2], a[8] * ms[5]));
+                r[8]  = madd(a[7], mc[0], nmadd(a[5], mc[2], a[4] * mc[4]));
+                r[9]  = nmadd(a[3], mc[0], madd(a[1], mc[2], zr - a[0] * mc[4]));
+                r[10] = madd(a[15], ms[0], nmadd(a[13], ms[2], a[12] * ms[4]));
+                r[11] = nmadd(a[11], ms[0], madd(a[9], ms[2], zr - a[8] * ms[4]));
+                r[12] = nmadd(a[6], mc[0], madd(a[5], mc[1], zr - a[4] * mc[3]));
+                r[13] = madd(a[2], mc[0], nmadd(a[1], mc[1], a[0] * mc[3]));
+                r[14] = nmadd(a[14], ms[0], madd(a[13], ms[1], zr - a[12] * ms[3]));
+                r[15] = madd(a[10], ms[0], nmadd(a[9], ms[1], a[8] * ms[3]));
+
+                for (int j = 0; j < 16; ++j)
+                    store(t[j], j % 5 == 0 ? select(sg, on, r[j] * id) : r[j] * id);
+
+                for (size_t k = 0; k < (size_t)Lanes && i + k < n; ++k)
+                {
+                    Real* m = d + 16 * (i + k);
+                    for (int j = 0; j < 16; ++j)
+                        m[j] = t[j][k];
+                }
+            }
+        }
+
+        // Builds n matrices of Size scalars, 12 for Affine3 or 16 for
+        // Mat4, from Lanes transforms at a time. The inverse uses the
+        // conjugate rotation and the reciprocal scale, as
+        // Mat4::makeInverseTransform does.
+        template <size_t Size, bool Inverse>
+        void compose(Real* d, const Real* loc, const Real* scale, const Real* rot, const size_t n)
+        {
+            const Pack one = splat(Real(1));
+            const Pack two = splat(Real(2));
+
+            // Gathered loc, scale and rot, then the 12 result rows.
+            Real t[10][Lanes], r[12][Lanes];
+            for (size_t i = 0; i < n; i += Lanes)
+            {
+                const size_t c = n - i < (size_t)Lanes ? n - i : (size_t)Lanes;
+                for (size_t k = 0; k < (size_t)Lanes; ++k)
+                {
+                    const size_t e = k < c ? i + k : i;
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        t[j][k]     = loc[3 * e + j];
+                        t[3 + j][k] = scale[3 * e + j];
+                    }
+                    for (int j = 0; j < 4; ++j)
+                        t[6 + j][k] = rot[4 * e + j];
+                }
+
+                Pack sx = load(t[3]), sy = load(t[4]), sz = load(t[5]);
+                Pack qw = load(t[6]);
+
+                const Pack qx = load(t[7]), qy = load(t[8]), qz = load(t[9]);
+                if constexpr (Inverse)
+                {
+                    // Conjugating only flips the sign of the w products.
+                    qw = zero() - qw;
+                    sx = one / sx;
+                    sy = one / sy;
+                    sz = one / sz;
+                }
+
+                const Pack qx2 = qx * qx, qy2 = qy * qy, qz2 = qz * qz;
+                const Pack qxy = qx * qy, qxz = qx * qz, qyz = qy * qz;
+                const Pack qwx = qw * qx, qwy = qw * qy, qwz = qw * qz;
+
+                const Pack rm[3][3] = {
+                    {nmadd(two, qy2 + qz2, one), two * (qxy - qwz), two * (qxz + qwy)},
+                    {two * (qxy + qwz), nmadd(two, qx2 + qz2, one), two * (qyz - qwx)},
+                    {two * (qxz - qwy), two * (qyz + qwx), nmadd(two, qx2 + qy2, one)},
+                };
+                const Pack s[3] = {sx, sy, sz};
+                const Pack l[3] = {load(t[0]), load(t[1]), load(t[2])};
+
+                for (int j = 0; j < 3; ++j)
+                {
+                    if constexpr (Inverse)
+                    {
+                        // S^-1 R^-1 scales the rows, and the location is
+                        // taken back through the result.
+                        const Pack a = rm[j][0] * s[j], b = rm[j][1] * s[j], e = rm[j][2] * s[j];
+                        store(r[4 * j], a);
+                        store(r[4 * j + 1], b);
+                        store(r[4 * j + 2], e);
+                        store(r[4 * j + 3], zero() - madd(a, l[0], madd(b, l[1], e * l[2])));
+                    }
+                    else
+                    {
+                        for (int k = 0; k < 3; ++k)
+                            store(r[4 * j + k], rm[j][k] * s[k]);
+                        store(r[4 * j + 3], l[j]);
+                    }
+                }
+
+                for (size_t k = 0; k < c; ++k)
+                {
+                    Real* m = d + Size * (i + k);
+                    for (int j = 0; j < 12; ++j)
+                        m[j] = r[j][k];
+                    if constexpr (Size == 16)
+                    {
+                        m[12] = m[13] = m[14] = 0;
+                        m[15]                 = 1;
+                    }
+                }
+            }
+        }
+
+        // Lanes divides 32, so the bits of one pack share a word.
+        void setBits(uint32_t* d, const size_t i, const size_t c, const unsigned b)
+        {
+            const uint32_t v = c < 32 ? (uint32_t)b & ((1u << c) - 1) : (uint32_t)b;
+            if ((i & 31) == 0)
+                d[i >> 5] = 0;
+            d[i >> 5] |= v << (i & 31);
+        }
+
+        // Gathers Lanes bounds of Size scalars as center and half extent
+        // per axis, then keeps the lanes that are not entirely outside
+        // any plane, dot(n, c) + d + dot(abs(n), e) >= 0.
+        template <size_t Size>
+        void cull(uint32_t* d, const Real* planes, const Real* bounds, const size_t n)
+        {
+            Pack pl[6][4], pa[6][3];
+            for (int p = 0; p < 6; ++p)
+            {
+                for (int j = 0; j < 4; ++j)
+                    pl[p][j] = splat(planes[4 * p + j]);
+                for (int j = 0; j < 3; ++j)
+                    pa[p][j] = abs(pl[p][j]);
+            }
+
+            const Pack hf = splat(Half);
+            const Pack zr = zero();
+
+            Real t[Size][Lanes];
+            for (size_t i = 0; i < n; i += Lanes)
+            {
+                const size_t c = n - i < (size_t)Lanes ? n - i : (size_t)Lanes;
+                for (size_t k = 0; k < (size_t)Lanes; ++k)
+                {
+                    const size_t e = k < c ? i + k : i;
+                    for (size_t j = 0; j < Size; ++j)
+                        t[j][k] = bounds[Size * e + j];
+                }
+
+                // For spheres ex[0] is the radius.
+                Pack ct[3], ex[3];
+                if constexpr (Size == 6)
+                {
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        const Pack lo = load(t[j]), hi = load(t[3 + j]);
+
+                        ct[j] = (lo + hi) * hf;
+                        ex[j] = (hi - lo) * hf;
+                    }
+                }
+                else
+                {
+                    for (int j = 0; j < 3; ++j)
+                        ct[j] = load(t[j]);
+                    ex[0] = load(t[3]);
+                }
+
+                Mask in = zr <= zr;
+                for (int p = 0; p < 6; ++p)
+                {
+                    Pack r = madd(pl[p][0], ct[0], pl[p][3]);
+                    r      = madd(pl[p][1], ct[1], r);
+                    r      = madd(pl[p][2], ct[2], r);
+                    if constexpr (Size == 6)
+                    {
+                        r = madd(pa[p][0], ex[0], r);
+                        r = madd(pa[p][1], ex[1], r);
+                        r = madd(pa[p][2], ex[2], r);
+                    }
+                    else
+                        r = r + ex[0];
+                    in = in & (r >= zr);
+                }
+                setBits(d, i, c, bits(in));
+            }
+        }
+
+        // Weighted sum of Size palette scalars for influence slot k of
+        // Lanes vertices starting at i, with c of them in range.
+        template <size_t Size>
+        void blendInfluence(Pack* acc, const uint16_t* joints, const Real* weights, const Real* palette, const size_t stride, const size_t i, const size_t c, const int k)
+        {
+            Real t[Size][Lanes], w[Lanes];
+            for (size_t l = 0; l < (size_t)Lanes; ++l)
+            {
+                const size_t e = 4 * (l < c ? i + l : i) + k;
+                const Real*  m = palette + stride * joints[e];
+
+                w[l] = l < c ? weights[e] : 0;
+                for (size_t j = 0; j < Size; ++j)
+                    t[j][l] = m[j];
+            }
+
+            const Pack wp = load(w);
+            for (size_t j = 0; j < Size; ++j)
+                acc[j] = madd(load(t[j]), wp, acc[j]);
+        }
+
+        // Blends the joint matrices of each vertex by weight and applies
+        // the result, the normals by its 3x3 part and renormalized.
+        void skinLinear(const Vec3Out& dp, const Vec3Out& dn, const Vec3In& p, const Vec3In& nr, const uint16_t* joints, const Real* weights, const Real* palette, const size_t stride, const size_t n)
+        {
+            const Pack ep = splat(Epsilon);
+            const Pack on = splat(Real(1));
+
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const size_t c = n - i < (size_t)Lanes ? n - i : (size_t)Lanes;
+
+                       Pack m[12];
+                       for (Pack& v : m)
+                           v = zero();
+                       for (int k = 0; k < 4; ++k)
+                           blendInfluence<12>(m, joints, weights, palette, stride, i, c, k);
+
+                       const Pack x = io.ld(p.x + i), y = io.ld(p.y + i), z = io.ld(p.z + i);
+                       io.st(dp.x + i, madd(m[2], z, madd(m[1], y, madd(m[0], x, m[3]))));
+                       io.st(dp.y + i, madd(m[6], z, madd(m[5], y, madd(m[4], x, m[7]))));
+                       io.st(dp.z + i, madd(m[10], z, madd(m[9], y, madd(m[8], x, m[11]))));
+
+                       if (dn.x != nullptr)
+                       {
+                           const Pack nx = io.ld(nr.x + i), ny = io.ld(nr.y + i), nz = io.ld(nr.z + i);
+
+                           const Pack rx = madd(m[2], nz, madd(m[1], ny, m[0] * nx));
+                           const Pack ry = madd(m[6], nz, madd(m[5], ny, m[4] * nx));
+                           const Pack rz = madd(m[10], nz, madd(m[9], ny, m[8] * nx));
+                           const Pack l  = madd(rz, rz, madd(ry, ry, rx * rx));
+                           const Pack rs = select(l > ep, rsqrt(l), on);
+                           io.st(dn.x + i, rx * rs);
+                           io.st(dn.y + i, ry * rs);
+                           io.st(dn.z + i, rz * rs);
+                       }
+                   });
+        }
+
+        // Blends the dual quaternions of each vertex, flipping those in
+        // the opposite hemisphere of the first influence, normalizes the
+        // sum and applies it as DualQuat::transformPoint does.
+        void skinDualQuat(const Vec3Out& dp, const Vec3Out& dn, const Vec3In& p, const Vec3In& nr, const uint16_t* joints, const Real* weights, const Real* palette, const size_t n)
+        {
+            const Pack ep = splat(Epsilon);
+            const Pack on = splat(Real(1));
+            const Pack tw = splat(Real(2));
+
+            Real sw[4][Lanes];
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const size_t c = n - i < (size_t)Lanes ? n - i : (size_t)Lanes;
+
+                       // Signs the weights against the first rotation.
+                       for (size_t l = 0; l < (size_t)Lanes; ++l)
+                       {
+                           const size_t e  = 4 * (l < c ? i + l : i);
+                           const Real*  q0 = palette + 8 * joints[e];
+                           for (int k = 0; k < 4; ++k)
+                           {
+                               const Real* q = palette + 8 * joints[e + k];
+
+                               const Real d = q0[0] * q[0] + q0[1] * q[1] + q0[2] * q[2] + q0[3] * q[3];
+                               sw[k][l]     = l < c ? (d < 0 ? -weights[e + k] : weights[e + k]) : 0;
+                           }
+                       }
+
+                       Pack b[8];
+                       for (Pack& v : b)
+                           v = zero();
+                       for (int k = 0; k < 4; ++k)
+                       {
+                           Real t[8][Lanes];
+                           for (size_t l = 0; l < (size_t)Lanes; ++l)
+                           {
+                               const Real* q = palette + 8 * joints[4 * (l < c ? i + l : i) + k];
+                               for (int j = 0; j < 8; ++j)
+                                   t[j][l] = q[j];
+                           }
+
+                           const Pack wp = load(sw[k]);
+                           for (int j = 0; j < 8; ++j)
+                               b[j] = madd(load(t[j]), wp, b[j]);
+                       }
+
+                       const Pack l2 = madd(b[3], b[3], madd(b[2], b[2], madd(b[1], b[1], b[0] * b[0])));
+                       const Pack rs = select(l2 > ep, rsqrt(l2), on);
+
+                       const Pack rw = b[0] * rs, dw = b[4] * rs;
+                       const Pack re[3] = {b[1] * rs, b[2] * rs, b[3] * rs};
+                       const Pack de[3] = {b[5] * rs, b[6] * rs, b[7] * rs};
+
+                       // t = 2 * (rw * de - dw * re + re x de)
+                       Pack t[3];
+                       cross(t, re, de);
+                       for (int j = 0; j < 3; ++j)
+                           t[j] = tw * nmadd(dw, re[j], madd(rw, de[j], t[j]));
+
+                       // v + 2 * re x (re x v + rw * v)
+                       const auto rotate = [&](Pack* v)
+                       {
+                           Pack a[3], r[3];
+                           cross(a, re, v);
+                           for (int j = 0; j < 3; ++j)
+                               a[j] = madd(rw, v[j], a[j]);
+                           cross(r, re, a);
+                           for (int j = 0; j < 3; ++j)
+                               v[j] = madd(tw, r[j], v[j]);
+                       };
+
+                       Pack v[3] = {io.ld(p.x + i), io.ld(p.y + i), io.ld(p.z + i)};
+                       rotate(v);
+                       io.st(dp.x + i, v[0] + t[0]);
+                       io.st(dp.y + i, v[1] + t[1]);
+                       io.st(dp.z + i, v[2] + t[2]);
+
+                       if (dn.x != nullptr)
+                       {
+                           Pack u[3] = {io.ld(nr.x + i), io.ld(nr.y + i), io.ld(nr.z + i)};
+                           rotate(u);
+                           io.st(dn.x + i, u[0]);
+                           io.st(dn.y + i, u[1]);
+                           io.st(dn.z + i, u[2]);
+                       }
+                   });
+        }
+
+        // Box3d::hit(r0, r1, PreparedRay, limit) against Lanes boxes at a
+        // time. The sign of each axis is fixed by the ray, so it picks
+        // the entry and exit arrays once for the whole run.
+        void box3dHit(uint32_t* d, Real* t, const Box3dIn& b, const Real* origin, const Real* invDir, const int* sign, const Real tNear, const Real tFar, const size_t n)
+        {
+            const Real* near[3];
+            const Real* far[3];
+            Pack        o[3], id[3];
+            for (int j = 0; j < 3; ++j)
+            {
+                near[j] = sign[j] ? b.max[j] : b.min[j];
+                far[j]  = sign[j] ? b.min[j] : b.max[j];
+                o[j]    = splat(origin[j]);
+                id[j]   = splat(invDir[j]);
+            }
+
+            const Pack pn = splat(tNear), pf = splat(tFar);
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       Pack r0 = pn, r1 = pf;
+                       for (int j = 0; j < 3; ++j)
+                       {
+                           r0 = max(r0, (io.ld(near[j] + i) - o[j]) * id[j]);
+                           r1 = min(r1, (io.ld(far[j] + i) - o[j]) * id[j]);
+                       }
+
+                       if (t)
+                           io.st(t + i, r0);
+                       setBits(d, i, n - i, bits(r1 >= r0));
+                   });
+        }
+
+        // Box3d::contains, box i contains the query.
+        void box3dContains(uint32_t* d, const Box3dIn& b, const Real* qMin, const Real* qMax, const size_t n)
+        {
+            Pack lo[3], hi[3];
+            for (int j = 0; j < 3; ++j)
+            {
+                lo[j] = splat(qMin[j]);
+                hi[j] = splat(qMax[j]);
+            }
+
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       Mask m = io.ld(b.min[0] + i) <= lo[0];
+                       m      = m & (io.ld(b.max[0] + i) >= hi[0]);
+                       for (int j = 1; j < 3; ++j)
+                           m = m & (io.ld(b.min[j] + i) <= lo[j]) & (io.ld(b.max[j] + i) >= hi[j]);
+                       setBits(d, i, n - i, bits(m));
+                   });
+        }
+
+        // Box3d::overlaps, box i and the query share a point.
+        void box3dOverlaps(uint32_t* d, const Box3dIn& b, const Real* qMin, const Real* qMax, const size_t n)
+        {
+            Pack lo[3], hi[3];
+            for (int j = 0; j < 3; ++j)
+            {
+                lo[j] = splat(qMin[j]);
+                hi[j] = splat(qMax[j]);
+            }
+
+            stream(n,
+                   [&](const size_t i, const auto& io)
+                   {
+                       Mask m = io.ld(b.min[0] + i) <= hi[0];
+                       m      = m & (io.ld(b.max[0] + i) >= lo[0]);
+                       for (int j = 1; j < 3; ++j)
+                           m = m & (io.ld(b.min[j] + i) <= hi[j]) & (io.ld(b.max[j] + i) >= lo[j]);
+                       setBits(d, i, n - i, bits(m));
+                   });
+        }
+
+        void box3dBounds(Real* bMin, Real* bMax, const Box3dIn& b, const size_t n)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                Pack lo = splat(Infinity), hi = splat(-Infinity);
+
+                size_t i = 0;
+                for (; i + Lanes <= n; i += Lanes)
+                {
+                    lo = min(lo, load(b.min[j] + i));
+                    hi = max(hi, load(b.max[j] + i));
+                }
+
+                Real tl[Lanes], th[Lanes];
+                store(tl, lo);
+                store(th, hi);
+                for (int k = 1; k < Lanes; ++k)
+                {
+                    tl[0] = tl[k] < tl[0] ? tl[k] : tl[0];
+                    th[0] = th[k] > th[0] ? th[k] : th[0];
+                }
+                for (; i < n; ++i)
+                {
+                    tl[0] = b.min[j][i] < tl[0] ? b.min[j][i] : tl[0];
+                    th[0] = b.max[j][i] > th[0] ? b.max[j][i] : th[0];
+                }
+
+                bMin[j] = tl[0];
+                bMax[j] = th[0];
+            }
+        }
+
+        // Keeps the lanes in the first c of a pack.
+        unsigned laneBits(const Mask& m, const size_t c)
+        {
+            return c < 32 ? bits(m) & ((1u << c) - 1) : bits(m);
+        }
+
+        // Box3d::hit(r0, r1, PreparedRay, limit) for every lane, with the
+        // bounds ordered by min and max rather than by sign.
+        uint32_t rayPacketBox(Real* r0, Real* r1, const Real* packet, const size_t width, const Real* bMin, const Real* bMax)
+        {
+            Pack lo[3], hi[3];
+            for (int j = 0; j < 3; ++j)
+            {
+                lo[j] = splat(bMin[j]);
+                hi[j] = splat(bMax[j]);
+            }
+
+            uint32_t r = 0;
+            stream(width,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const Real* p = packet + i;
+
+                       Pack t0 = io.ld(p + RP_NEAR * width);
+                       Pack t1 = io.ld(p + RP_FAR * width);
+                       for (int j = 0; j < 3; ++j)
+                       {
+                           const Pack o = io.ld(p + (RP_OX + j) * width);
+                           const Pack d = io.ld(p + (RP_IX + j) * width);
+                           const Pack a = (lo[j] - o) * d;
+                           const Pack b = (hi[j] - o) * d;
+
+                           t0 = max(t0, min(a, b));
+                           t1 = min(t1, max(a, b));
+                       }
+
+                       if (r0)
+                           io.st(r0 + i, t0);
+                       if (r1)
+                           io.st(r1 + i, t1);
+                       r |= laneBits(t1 >= t0, width - i) << i;
+                   });
+            return r;
+        }
+
+        // Sphere::hit(RayHitTest&, ray, limit) for every lane, the nearer
+        // root within [near, far], else the farther one within [near, far).
+        uint32_t rayPacketSphere(Real* d, const Real* packet, const size_t width, const Real* center, const Real radius)
+        {
+            const Pack cx = splat(center[0]), cy = splat(center[1]), cz = splat(center[2]);
+            const Pack rr = splat(radius * radius);
+
+            uint32_t r = 0;
+            stream(width,
+                   [&](const size_t i, const auto& io)
+                   {
+                       const Real* p = packet + i;
+
+                       const Pack vx = io.ld(p + RP_OX * width) - cx;
+                       const Pack vy = io.ld(p + RP_OY * width) - cy;
+                       const Pack vz = io.ld(p + RP_OZ * width) - cz;
+                       const Pack dx = io.ld(p + RP_DX * width);
+                       const Pack dy = io.ld(p + RP_DY * width);
+                       const Pack dz = io.ld(p + RP_DZ * width);
+                       const Pack t0 = io.ld(p + RP_NEAR * width);
+                       const Pack t1 = io.ld(p + RP_FAR * width);
+
+                       const Pack a = madd(dz, dz, madd(dy, dy, dx * dx));
+                       const Pack b = madd(vz, dz, madd(vy, dy, vx * dx));
+                       const Pack c = madd(vz, vz, madd(vy, vy, vx * vx)) - rr;
+                       const Pack q = nmadd(a, c, b * b);
+
+                       const Mask ok = q > zero();
+                       const Pack sq = sqrt(max(q, zero()));
+                       const Pack ra = splat(Real(1)) / select(ok, a, splat(Real(1)));
+                       const Pack x0 = (-b - sq) * ra;
+                       const Pack x1 = (sq - b) * ra;
+
+                       const Mask h0 = ok & (x0 >= t0) & (x0 <= t1);
+                       const Mask h1 = ok & (x1 >= t0) & (x1 < t1);
+                       if (d)
+                           io.st(d + i, select(h0, x0, x1));
+                       r |= laneBits(h0 | h1, width - i) << i;
+                   });
+            return r;
+        }
+
+        enum TransformKind
+        {
+            TK_POINT,
+            TK_DIRECTION,
+            TK_PROJECTIVE,
+        };
+
+        // Gathers Lanes strided vectors into x, y and z, transforms them
+        // a pack at a time and scatters the results back.
+        template <TransformKind Kind>
+        void transform(Real* d, const size_t ds, const Real* s, const size_t ss, const Real* m, const size_t n)
+        {
+            constexpr int Rows = Kind == TK_PROJECTIVE ? 4 : 3;
+
+            Pack mp[16];
+            for (int i = 0; i < 4 * Rows; ++i)
+                mp[i] = splat(m[i]);
+
+            Real x[Lanes], y[Lanes], z[Lanes];
+            for (size_t i = 0; i < n; i += Lanes)
+            {
+                const size_t c = n - i < (size_t)Lanes ? n - i : (size_t)Lanes;
+                for (size_t k = 0; k < (size_t)Lanes; ++k)
+                {
+                    if (k < c)
+                    {
+                        const Real* p = (const Real*)((const char*)s + (i + k) * ss);
+
+                        x[k] = p[0];
+                        y[k] = p[1];
+                        z[k] = p[2];
+                    }
+                    else
+                        x[k] = y[k] = z[k] = 0;
+                }
+
+                const Pack px = load(x), py = load(y), pz = load(z);
+
+                Pack rx = madd(mp[2], pz, madd(mp[1], py, mp[0] * px));
+                Pack ry = madd(mp[6], pz, madd(mp[5], py, mp[4] * px));
+                Pack rz = madd(mp[10], pz, madd(mp[9], py, mp[8] * px));
+                if constexpr (Kind != TK_DIRECTION)
+                {
+                    rx += mp[3];
+                    ry += mp[7];
+                    rz += mp[11];
+                }
+                if constexpr (Kind == TK_PROJECTIVE)
+                {
+                    const Pack w = splat(Real(1)) / madd(mp[14], pz, madd(mp[13], py, madd(mp[12], px, mp[15])));
+
+                    rx *= w;
+                    ry *= w;
+                    rz *= w;
+                }
+
+                store(x, rx);
+                store(y, ry);
+                store(z, rz);
+                for (size_t k = 0; k < c; ++k)
+                {
+                    Real* p = (Real*)((char*)d + (i + k) * ds);
+
+                    p[0] = x[k];
+                    p[1] = y[k];
+                    p[2] = z[k];
+                }
+            }
+        }
+
+    }  // namespace
+
+    void Math_KERNEL_BIND(KernelTable& table)
+    {
+        table.vec3Add             = vec3Add;
+        table.vec3Sub             = vec3Sub;
+        table.vec3Mul             = vec3Mul;
+        table.vec3Scale           = vec3Scale;
+        table.vec3Cross           = vec3Cross;
+        table.vec3Dot             = vec3Dot;
+        table.vec3Length          = vec3Length;
+        table.vec3Normalize       = vec3Normalize;
+        table.realLerp            = realLerp;
+        table.quatMul             = quatMul;
+        table.quatRotate          = quatRotate;
+        table.quatNormalize       = quatNormalize;
+        table.quatConjugate       = quatConjugate;
+        table.quatInverse         = quatInverse;
+        table.quatNlerp           = quatBlend<QB_NLERP>;
+        table.quatSlerp           = quatBlend<QB_SLERP>;
+        table.quatFastSlerp       = quatBlend<QB_FAST_SLERP>;
+        table.colorToInt          = colorToInt;
+        table.intToColor          = intToColor;
+        table.narrow              = narrow;
+        table.widen               = widen;
+        table.toHalf              = toHalf;
+        table.fromHalf            = fromHalf;
+        table.toSnorm16           = toSnorm16;
+        table.fromSnorm16         = fromSnorm16;
+        table.quatToSmallest32    = quatToSmallest<10, uint32_t>;
+        table.quatFromSmallest32  = quatFromSmallest<10, uint32_t>;
+        table.quatToSmallest48    = quatToSmallest<15, uint16_t>;
+        table.quatFromSmallest48  = quatFromSmallest<15, uint16_t>;
+        table.mat4Mul             = mulArrays<16, mul4x4>;
+        table.mat4MulIndexed      = mulIndexed<16, mul4x4>;
+        table.mat4Invert          = mat4Invert;
+        table.mat4Det             = mat4Det;
+        table.affineMul           = mulArrays<12, mul3x4>;
+        table.affineMulIndexed    = mulIndexed<12, mul3x4>;
+        table.mat4Compose         = compose<16, false>;
+        table.mat4ComposeInverse  = compose<16, true>;
+        table.affineCompose       = compose<12, false>;
+        table.cullBoxes           = cull<6>;
+        table.cullSpheres         = cull<4>;
+        table.skinLinear          = skinLinear;
+        table.skinDualQuat        = skinDualQuat;
+        table.box3dHit            = box3dHit;
+        table.box3dContains       = box3dContains;
+        table.box3dOverlaps       = box3dOverlaps;
+        table.box3dBounds         = box3dBounds;
+        table.rayPacketBox        = rayPacketBox;
+        table.rayPacketSphere     = rayPacketSphere;
+        table.transformPoints     = transform<TK_POINT>;
+        table.transformDirections = transform<TK_DIRECTION>;
+        table.transformProjective = transform<TK_PROJECTIVE>;
+    }
+
+}  // namespace Rt2::Math::Kernels
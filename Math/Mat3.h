@@ -20,79 +20,384 @@
 -------------------------------------------------------------------------------
 */
 #pragma once
+#include "Math/Forward.h"
 #include "Math/Math.h"
+#include "Math/Quat.h"
+#include "Math/Transform.h"
 #include "Math/Vec3.h"
 
 namespace Rt2::Math
 {
-    class Quat;
-    class Mat4;
-
-    
-    class Mat3
+    template <typename T>
+    class TMat3
     {
     public:
-        static const Mat3 Identity;
-        static const Mat3 Zero;
+        static const TMat3 Identity;
+        static const TMat3 Zero;
 
-        Real m[3][3]{};
+        T m[3][3]{};
 
     public:
-        Mat3() = default;
-        Mat3(const Mat3&) = default;
+        TMat3() = default;
+        TMat3(const TMat3&) = default;
+
+        template <typename U>
+        explicit constexpr TMat3(const TMat3<U>& v);
 
-        explicit Mat3(const Real* v);
+        explicit constexpr TMat3(const T* v);
 
-        explicit Mat3(const Mat4& m4)
+        explicit TMat3(const TMat4<T>& m4)
         {
             this->fromMat4(m4);
         }
 
-        Mat3(Real m00,
-                Real m01,
-                Real m02,
-                Real m10,
-                Real m11,
-                Real m12,
-                Real m20,
-                Real m21,
-                Real m22);
+        constexpr TMat3(T m00,
+                        T m01,
+                        T m02,
+                        T m10,
+                        T m11,
+                        T m12,
+                        T m20,
+                        T m21,
+                        T m22);
+
+        constexpr TMat3 operator*(const TMat3& lhs) const;
+
+        // Components within epsilon of zero are snapped to zero.
+        constexpr TVec3<T> operator*(const TVec3<T>& v) const;
+
+        // operator* without the snapping.
+        constexpr TVec3<T> transform(const TVec3<T>& v) const;
 
-        Mat3 operator*(const Mat3& lhs) const;
+        // Batch forms of transform, see Transform::apply.
+        void transformPoints(TVec3<T>* d, const TVec3<T>* s, size_t n) const;
 
-        Vec3 operator*(const Vec3& v) const;
+        void transformPoints(T* d, size_t dStride, const T* s, size_t sStride, size_t n) const;
 
-        bool operator==(const Mat3& rhs) const;
+        void transformDirections(TVec3<T>* d, const TVec3<T>* s, size_t n) const;
 
+        void transformDirections(T* d, size_t dStride, const T* s, size_t sStride, size_t n) const;
 
-        void transpose()
+        constexpr bool operator==(const TMat3& rhs) const;
+
+
+        constexpr void transpose()
         {
             *this = transposed();
         }
 
-        Mat3 transposed() const;
+        constexpr TMat3 transposed() const;
 
-        Vec3 row(int idx) const;
+        constexpr TVec3<T> row(int idx) const;
 
-        Vec3 col(int idx) const;
+        constexpr TVec3<T> col(int idx) const;
 
-        void makeIdentity();
+        constexpr void makeIdentity();
 
-        void fromAngles(Real pitch, Real yaw, Real roll);
+        constexpr void fromAngles(T pitch, T yaw, T roll);
 
-        void fromAngles(const Vec3& dRot);
+        constexpr void fromAngles(const TVec3<T>& dRot);
 
-        void fromQuaternion(const Quat& q);
+        constexpr void fromQuaternion(const TQuat<T>& q);
 
-        void fromMat4(const Mat4& mat4By4);
+        void fromMat4(const TMat4<T>& mat4By4);
 
-        void makeRotX(Real theta);
+        constexpr void makeRotX(T theta);
 
-        void makeRotY(Real theta);
+        constexpr void makeRotY(T theta);
 
-        void makeRotZ(Real theta);
+        constexpr void makeRotZ(T theta);
 
         void print() const;
     };
 
+    template <typename T>
+    constexpr TMat3<T>::TMat3(const T m00,
+                              const T m01,
+                              const T m02,
+                              const T m10,
+                              const T m11,
+                              const T m12,
+                              const T m20,
+                              const T m21,
+                              const T m22)
+    {
+        m[0][0] = m00;
+        m[0][1] = m01;
+        m[0][2] = m02;
+        m[1][0] = m10;
+        m[1][1] = m11;
+        m[1][2] = m12;
+        m[2][0] = m20;
+        m[2][1] = m21;
+        m[2][2] = m22;
+    }
+
+    template <typename T>
+    template <typename U>
+    constexpr TMat3<T>::TMat3(const TMat3<U>& v)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+                m[i][j] = T(v.m[i][j]);
+        }
+    }
+
+    template <typename T>
+    constexpr TMat3<T>::TMat3(const T* v)
+    {
+        if (v != nullptr)
+        {
+            m[0][0] = *v++;
+            m[0][1] = *v++;
+            m[0][2] = *v++;
+            m[1][0] = *v++;
+            m[1][1] = *v++;
+            m[1][2] = *v++;
+            m[2][0] = *v++;
+            m[2][1] = *v++;
+            m[2][2] = *v;
+        }
+    }
+
+    template <typename T>
+    constexpr TMat3<T> TMat3<T>::operator*(const TMat3& lhs) const
+    {
+        return {
+            m[0][0] * lhs.m[0][0] + m[0][1] * lhs.m[1][0] + m[0][2] * lhs.m[2][0],
+            m[0][0] * lhs.m[0][1] + m[0][1] * lhs.m[1][1] + m[0][2] * lhs.m[2][1],
+            m[0][0] * lhs.m[0][2] + m[0][1] * lhs.m[1][2] + m[0][2] * lhs.m[2][2],
+
+            m[1][0] * lhs.m[0][0] + m[1][1] * lhs.m[1][0] + m[1][2] * lhs.m[2][0],
+            m[1][0] * lhs.m[0][1] + m[1][1] * lhs.m[1][1] + m[1][2] * lhs.m[2][1],
+            m[1][0] * lhs.m[0][2] + m[1][1] * lhs.m[1][2] + m[1][2] * lhs.m[2][2],
+
+            m[2][0] * lhs.m[0][0] + m[2][1] * lhs.m[1][0] + m[2][2] * lhs.m[2][0],
+            m[2][0] * lhs.m[0][1] + m[2][1] * lhs.m[1][1] + m[2][2] * lhs.m[2][1],
+            m[2][0] * lhs.m[0][2] + m[2][1] * lhs.m[1][2] + m[2][2] * lhs.m[2][2],
+        };
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TMat3<T>::operator*(const TVec3<T>& v) const
+    {
+        TVec3<T> r = transform(v);
+
+        if (isZero<T>(r.x, Limits<T>::Epsilon))
+            r.x = 0;
+        if (isZero<T>(r.y, Limits<T>::Epsilon))
+            r.y = 0;
+        if (isZero<T>(r.z, Limits<T>::Epsilon))
+            r.z = 0;
+        return r;
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TMat3<T>::transform(const TVec3<T>& v) const
+    {
+        return {
+            m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+            m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+            m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z,
+        };
+    }
+
+    template <typename T>
+    void TMat3<T>::transformPoints(TVec3<T>* d, const TVec3<T>* s, const size_t n) const
+    {
+        transformPoints(reinterpret_cast<T*>(d), sizeof(TVec3<T>), reinterpret_cast<const T*>(s), sizeof(TVec3<T>), n);
+    }
+
+    template <typename T>
+    void TMat3<T>::transformPoints(T* d, const size_t dStride, const T* s, const size_t sStride, const size_t n) const
+    {
+        const T r[12] = {
+            m[0][0],
+            m[0][1],
+            m[0][2],
+            0,
+            m[1][0],
+            m[1][1],
+            m[1][2],
+            0,
+            m[2][0],
+            m[2][1],
+            m[2][2],
+            0,
+        };
+        Transform::apply(TM_DIRECTION, r, d, dStride, s, sStride, n);
+    }
+
+    template <typename T>
+    void TMat3<T>::transformDirections(TVec3<T>* d, const TVec3<T>* s, const size_t n) const
+    {
+        transformPoints(d, s, n);
+    }
+
+    template <typename T>
+    void TMat3<T>::transformDirections(T* d, const size_t dStride, const T* s, const size_t sStride, const size_t n) const
+    {
+        transformPoints(d, dStride, s, sStride, n);
+    }
+
+    template <typename T>
+    constexpr bool TMat3<T>::operator==(const TMat3& rhs) const
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            for (int j = 0; j < 3; j++)
+            {
+                if (!eq<T>(m[i][j], rhs.m[i][j]))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    constexpr TMat3<T> TMat3<T>::transposed() const
+    {
+        return {
+            m[0][0],
+            m[1][0],
+            m[2][0],
+            m[0][1],
+            m[1][1],
+            m[2][1],
+            m[0][2],
+            m[1][2],
+            m[2][2],
+        };
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TMat3<T>::row(const int idx) const
+    {
+        if (idx < 3 && idx >= 0)
+            return {m[0][idx], m[1][idx], m[2][idx]};
+        return TVec3<T>::Zero;
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TMat3<T>::col(const int idx) const
+    {
+        if (idx < 3 && idx >= 0)
+            return {m[idx][0], m[idx][1], m[idx][2]};
+        return TVec3<T>::Zero;
+    }
+
+    template <typename T>
+    constexpr void TMat3<T>::makeIdentity()
+    {
+        m[0][0] = 1;
+        m[0][1] = 0;
+        m[0][2] = 0;
+        m[1][0] = 0;
+        m[1][1] = 1;
+        m[1][2] = 0;
+        m[2][0] = 0;
+        m[2][1] = 0;
+        m[2][2] = 1;
+    }
+
+    template <typename T>
+    constexpr void TMat3<T>::fromAngles(const T pitch, const T yaw, const T roll)
+    {
+        T s0{}, c0{}, s1{}, c1{}, s2{}, c2{};
+        angles<T>(pitch, s0, c0);
+        angles<T>(yaw, s1, c1);
+        angles<T>(roll, s2, c2);
+
+        const T s2C0 = s2 * c0;
+        const T s2S0 = s2 * s0;
+
+        m[0][0] = c1 * c2;
+        m[0][1] = -c1 * s2C0 + s1 * s0;
+        m[0][2] = c1 * s2S0 + s1 * c0;
+        m[1][0] = s2;
+        m[1][1] = c2 * c0;
+        m[1][2] = -c2 * s0;
+        m[2][0] = -s1 * c2;
+        m[2][1] = s1 * s2C0 + c1 * s0;
+        m[2][2] = -s1 * s2S0 + c1 * c0;
+    }
+
+    template <typename T>
+    constexpr void TMat3<T>::fromAngles(const TVec3<T>& dRot)
+    {
+        fromAngles(dRot.x, dRot.y, dRot.z);
+    }
+
+    template <typename T>
+    constexpr void TMat3<T>::fromQuaternion(const TQuat<T>& q)
+    {
+        const T qx2 = q.x * q.x;
+        const T qy2 = q.y * q.y;
+        const T qz2 = q.z * q.z;
+
+        const T qxy = q.x * q.y;
+        const T qxz = q.x * q.z;
+        const T qyz = q.y * q.z;
+
+        const T qwx = q.w * q.x;
+        const T qwy = q.w * q.y;
+        const T qwz = q.w * q.z;
+
+        m[0][0] = T(1.0) - T(2.0) * (qy2 + qz2);
+        m[0][1] = T(2.0) * (qxy - qwz);
+        m[0][2] = T(2.0) * (qxz + qwy);
+
+        m[1][0] = T(2.0) * (qxy + qwz);
+        m[1][1] = T(1.0) - T(2.0) * (qx2 + qz2);
+        m[1][2] = T(2.0) * (qyz - qwx);
+
+        m[2][0] = T(2.0) * (qxz - qwy);
+        m[2][1] = T(2.0) * (qyz + qwx);
+        m[2][2] = T(1.0) - T(2.0) * (qx2 + qy2);
+    }
+
+    template <typename T>
+    constexpr void TMat3<T>::makeRotZ(const T theta)
+    {
+        T s{}, c{};
+        angles<T>(theta, s, c);
+        makeIdentity();
+
+        m[1][1] = m[0][0] = c;
+
+        m[0][1] = -s;
+        m[1][0] = s;
+    }
+
+    template <typename T>
+    constexpr void TMat3<T>::makeRotY(const T theta)
+    {
+        T s{}, c{};
+        angles<T>(theta, s, c);
+        makeIdentity();
+
+        m[2][2] = m[0][0] = c;
+        m[0][2]           = -s;
+        m[2][0]           = s;
+    }
+
+    template <typename T>
+    constexpr void TMat3<T>::makeRotX(const T theta)
+    {
+        T s{}, c{};
+        angles<T>(theta, s, c);
+        makeIdentity();
+
+        m[1][1] = m[2][2] = c;
+        m[1][2]           = -s;
+        m[2][1]           = s;
+    }
+
+    template <typename T>
+    inline constexpr TMat3<T> TMat3<T>::Identity = TMat3<T>(1, 0, 0, 0, 1, 0, 0, 0, 1);
+
+    template <typename T>
+    inline constexpr TMat3<T> TMat3<T>::Zero = TMat3<T>(0, 0, 0, 0, 0, 0, 0, 0, 0);
+
 }  // namespace Rt2::Math
@@ -21,353 +21,177 @@
 */
 #include "Math/Mat4.h"
 #include <cstdio>
-#include "Math/Mat3.h"
-#include "Quat.h"
+#include "Math/Dispatch.h"
 
 namespace Rt2::Math
 {
-    const Mat4 Mat4::Identity = Mat4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
-    const Mat4 Mat4::Zero     = Mat4(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-
-    Mat4::Mat4(
-        const Real m00,
-        const Real m01,
-        const Real m02,
-        const Real m03,
-        const Real m10,
-        const Real m11,
-        const Real m12,
-        const Real m13,
-        const Real m20,
-        const Real m21,
-        const Real m22,
-        const Real m23,
-        const Real m30,
-        const Real m31,
-        const Real m32,
-        const Real m33)
+    template <typename T>
+    void TMat4<T>::print() const
     {
-        m[0][0] = m00;
-        m[0][1] = m01;
-        m[0][2] = m02;
-        m[0][3] = m03;
-        m[1][0] = m10;
-        m[1][1] = m11;
-        m[1][2] = m12;
-        m[1][3] = m13;
-        m[2][0] = m20;
-        m[2][1] = m21;
-        m[2][2] = m22;
-        m[2][3] = m23;
-        m[3][0] = m30;
-        m[3][1] = m31;
-        m[3][2] = m32;
-        m[3][3] = m33;
+        printf("[ %3.3f, %3.3f, %3.3f, %3.3f ]\n", (double)m[0][0], (double)m[0][1], (double)m[0][2], (double)m[0][3]);
+        printf("[ %3.3f, %3.3f, %3.3f, %3.3f ]\n", (double)m[1][0], (double)m[1][1], (double)m[1][2], (double)m[1][3]);
+        printf("[ %3.3f, %3.3f, %3.3f, %3.3f ]\n", (double)m[2][0], (double)m[2][1], (double)m[2][2], (double)m[2][3]);
+        printf("[ %3.3f, %3.3f, %3.3f, %3.3f ]\n", (double)m[3][0], (double)m[3][1], (double)m[3][2], (double)m[3][3]);
     }
 
-    Mat4::Mat4(const Real* v)
+    template <typename T>
+    void TMat4<T>::multiplyArrays(TMat4* d, const TMat4* a, const TMat4* b, const size_t n)
     {
-        if (v != nullptr)
+        static_assert(sizeof(TMat4) == 16 * sizeof(T));
+
+        if constexpr (std::is_same_v<T, Real>)
         {
-            m[0][0] = *v++;
-            m[0][1] = *v++;
-            m[0][2] = *v++;
-            m[0][3] = *v++;
-            m[1][0] = *v++;
-            m[1][1] = *v++;
-            m[1][2] = *v++;
-            m[1][3] = *v++;
-            m[2][0] = *v++;
-            m[2][1] = *v++;
-            m[2][2] = *v++;
-            m[2][3] = *v++;
-            m[3][0] = *v++;
-            m[3][1] = *v++;
-            m[3][2] = *v++;
-            m[3][3] = *v;
+            Dispatch::kernels().mat4Mul(
+                reinterpret_cast<Real*>(d),
+                reinterpret_cast<const Real*>(a),
+                reinterpret_cast<const Real*>(b),
+                n);
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                d[i] = a[i] * b[i];
         }
     }
 
-    Mat4 Mat4::operator*(const Mat4& lhs) const
-    {
-        return {
-            m[0][0] * lhs.m[0][0] + m[0][1] * lhs.m[1][0] + m[0][2] * lhs.m[2][0] + m[0][3] * lhs.m[3][0],
-            m[0][0] * lhs.m[0][1] + m[0][1] * lhs.m[1][1] + m[0][2] * lhs.m[2][1] + m[0][3] * lhs.m[3][1],
-            m[0][0] * lhs.m[0][2] + m[0][1] * lhs.m[1][2] + m[0][2] * lhs.m[2][2] + m[0][3] * lhs.m[3][2],
-            m[0][0] * lhs.m[0][3] + m[0][1] * lhs.m[1][3] + m[0][2] * lhs.m[2][3] + m[0][3] * lhs.m[3][3],
-
-            m[1][0] * lhs.m[0][0] + m[1][1] * lhs.m[1][0] + m[1][2] * lhs.m[2][0] + m[1][3] * lhs.m[3][0],
-            m[1][0] * lhs.m[0][1] + m[1][1] * lhs.m[1][1] + m[1][2] * lhs.m[2][1] + m[1][3] * lhs.m[3][1],
-            m[1][0] * lhs.m[0][2] + m[1][1] * lhs.m[1][2] + m[1][2] * lhs.m[2][2] + m[1][3] * lhs.m[3][2],
-            m[1][0] * lhs.m[0][3] + m[1][1] * lhs.m[1][3] + m[1][2] * lhs.m[2][3] + m[1][3] * lhs.m[3][3],
-
-            m[2][0] * lhs.m[0][0] + m[2][1] * lhs.m[1][0] + m[2][2] * lhs.m[2][0] + m[2][3] * lhs.m[3][0],
-            m[2][0] * lhs.m[0][1] + m[2][1] * lhs.m[1][1] + m[2][2] * lhs.m[2][1] + m[2][3] * lhs.m[3][1],
-            m[2][0] * lhs.m[0][2] + m[2][1] * lhs.m[1][2] + m[2][2] * lhs.m[2][2] + m[2][3] * lhs.m[3][2],
-            m[2][0] * lhs.m[0][3] + m[2][1] * lhs.m[1][3] + m[2][2] * lhs.m[2][3] + m[2][3] * lhs.m[3][3],
-
-            m[3][0] * lhs.m[0][0] + m[3][1] * lhs.m[1][0] + m[3][2] * lhs.m[2][0] + m[3][3] * lhs.m[3][0],
-            m[3][0] * lhs.m[0][1] + m[3][1] * lhs.m[1][1] + m[3][2] * lhs.m[2][1] + m[3][3] * lhs.m[3][1],
-            m[3][0] * lhs.m[0][2] + m[3][1] * lhs.m[1][2] + m[3][2] * lhs.m[2][2] + m[3][3] * lhs.m[3][2],
-            m[3][0] * lhs.m[0][3] + m[3][1] * lhs.m[1][3] + m[3][2] * lhs.m[2][3] + m[3][3] * lhs.m[3][3],
-        };
-    }
-
-    void Mat4::mulAssign(const Mat4& lhs, const Mat4& rhs)
-    {
-        m[0][0] = lhs.m[0][0] * rhs.m[0][0] + lhs.m[0][1] * rhs.m[1][0] + lhs.m[0][2] * rhs.m[2][0] + lhs.m[0][3] * rhs.m[3][0];
-        m[0][1] = lhs.m[0][0] * rhs.m[0][1] + lhs.m[0][1] * rhs.m[1][1] + lhs.m[0][2] * rhs.m[2][1] + lhs.m[0][3] * rhs.m[3][1];
-        m[0][2] = lhs.m[0][0] * rhs.m[0][2] + lhs.m[0][1] * rhs.m[1][2] + lhs.m[0][2] * rhs.m[2][2] + lhs.m[0][3] * rhs.m[3][2];
-        m[0][3] = lhs.m[0][0] * rhs.m[0][3] + lhs.m[0][1] * rhs.m[1][3] + lhs.m[0][2] * rhs.m[2][3] + lhs.m[0][3] * rhs.m[3][3];
-
-        m[1][0] = lhs.m[1][0] * rhs.m[0][0] + lhs.m[1][1] * rhs.m[1][0] + lhs.m[1][2] * rhs.m[2][0] + lhs.m[1][3] * rhs.m[3][0];
-        m[1][1] = lhs.m[1][0] * rhs.m[0][1] + lhs.m[1][1] * rhs.m[1][1] + lhs.m[1][2] * rhs.m[2][1] + lhs.m[1][3] * rhs.m[3][1];
-        m[1][2] = lhs.m[1][0] * rhs.m[0][2] + lhs.m[1][1] * rhs.m[1][2] + lhs.m[1][2] * rhs.m[2][2] + lhs.m[1][3] * rhs.m[3][2];
-        m[1][3] = lhs.m[1][0] * rhs.m[0][3] + lhs.m[1][1] * rhs.m[1][3] + lhs.m[1][2] * rhs.m[2][3] + lhs.m[1][3] * rhs.m[3][3];
-
-        m[2][0] = lhs.m[2][0] * rhs.m[0][0] + lhs.m[2][1] * rhs.m[1][0] + lhs.m[2][2] * rhs.m[2][0] + lhs.m[2][3] * rhs.m[3][0];
-        m[2][1] = lhs.m[2][0] * rhs.m[0][1] + lhs.m[2][1] * rhs.m[1][1] + lhs.m[2][2] * rhs.m[2][1] + lhs.m[2][3] * rhs.m[3][1];
-        m[2][2] = lhs.m[2][0] * rhs.m[0][2] + lhs.m[2][1] * rhs.m[1][2] + lhs.m[2][2] * rhs.m[2][2] + lhs.m[2][3] * rhs.m[3][2];
-        m[2][3] = lhs.m[2][0] * rhs.m[0][3] + lhs.m[2][1] * rhs.m[1][3] + lhs.m[2][2] * rhs.m[2][3] + lhs.m[2][3] * rhs.m[3][3];
-
-        m[3][0] = lhs.m[3][0] * rhs.m[0][0] + lhs.m[3][1] * rhs.m[1][0] + lhs.m[3][2] * rhs.m[2][0] + lhs.m[3][3] * rhs.m[3][0];
-        m[3][1] = lhs.m[3][0] * rhs.m[0][1] + lhs.m[3][1] * rhs.m[1][1] + lhs.m[3][2] * rhs.m[2][1] + lhs.m[3][3] * rhs.m[3][1];
-        m[3][2] = lhs.m[3][0] * rhs.m[0][2] + lhs.m[3][1] * rhs.m[1][2] + lhs.m[3][2] * rhs.m[2][2] + lhs.m[3][3] * rhs.m[3][2];
-        m[3][3] = lhs.m[3][0] * rhs.m[0][3] + lhs.m[3][1] * rhs.m[1][3] + lhs.m[3][2] * rhs.m[2][3] + lhs.m[3][3] * rhs.m[3][3];
-    }
-
-    void Mat4::merge(Mat4& d, const Mat4& lhs, const Mat4& rhs)
-    {
-        d.m[0][0] = lhs.m[0][0] * rhs.m[0][0] + lhs.m[0][1] * rhs.m[1][0] + lhs.m[0][2] * rhs.m[2][0] + lhs.m[0][3] * rhs.m[3][0];
-        d.m[0][1] = lhs.m[0][0] * rhs.m[0][1] + lhs.m[0][1] * rhs.m[1][1] + lhs.m[0][2] * rhs.m[2][1] + lhs.m[0][3] * rhs.m[3][1];
-        d.m[0][2] = lhs.m[0][0] * rhs.m[0][2] + lhs.m[0][1] * rhs.m[1][2] + lhs.m[0][2] * rhs.m[2][2] + lhs.m[0][3] * rhs.m[3][2];
-        d.m[0][3] = lhs.m[0][0] * rhs.m[0][3] + lhs.m[0][1] * rhs.m[1][3] + lhs.m[0][2] * rhs.m[2][3] + lhs.m[0][3] * rhs.m[3][3];
-
-        d.m[1][0] = lhs.m[1][0] * rhs.m[0][0] + lhs.m[1][1] * rhs.m[1][0] + lhs.m[1][2] * rhs.m[2][0] + lhs.m[1][3] * rhs.m[3][0];
-        d.m[1][1] = lhs.m[1][0] * rhs.m[0][1] + lhs.m[1][1] * rhs.m[1][1] + lhs.m[1][2] * rhs.m[2][1] + lhs.m[1][3] * rhs.m[3][1];
-        d.m[1][2] = lhs.m[1][0] * rhs.m[0][2] + lhs.m[1][1] * rhs.m[1][2] + lhs.m[1][2] * rhs.m[2][2] + lhs.m[1][3] * rhs.m[3][2];
-        d.m[1][3] = lhs.m[1][0] * rhs.m[0][3] + lhs.m[1][1] * rhs.m[1][3] + lhs.m[1][2] * rhs.m[2][3] + lhs.m[1][3] * rhs.m[3][3];
-
-        d.m[2][0] = lhs.m[2][0] * rhs.m[0][0] + lhs.m[2][1] * rhs.m[1][0] + lhs.m[2][2] * rhs.m[2][0] + lhs.m[2][3] * rhs.m[3][0];
-        d.m[2][1] = lhs.m[2][0] * rhs.m[0][1] + lhs.m[2][1] * rhs.m[1][1] + lhs.m[2][2] * rhs.m[2][1] + lhs.m[2][3] * rhs.m[3][1];
-        d.m[2][2] = lhs.m[2][0] * rhs.m[0][2] + lhs.m[2][1] * rhs.m[1][2] + lhs.m[2][2] * rhs.m[2][2] + lhs.m[2][3] * rhs.m[3][2];
-        d.m[2][3] = lhs.m[2][0] * rhs.m[0][3] + lhs.m[2][1] * rhs.m[1][3] + lhs.m[2][2] * rhs.m[2][3] + lhs.m[2][3] * rhs.m[3][3];
-
-        d.m[3][0] = lhs.m[3][0] * rhs.m[0][0] + lhs.m[3][1] * rhs.m[1][0] + lhs.m[3][2] * rhs.m[2][0] + lhs.m[3][3] * rhs.m[3][0];
-        d.m[3][1] = lhs.m[3][0] * rhs.m[0][1] + lhs.m[3][1] * rhs.m[1][1] + lhs.m[3][2] * rhs.m[2][1] + lhs.m[3][3] * rhs.m[3][1];
-        d.m[3][2] = lhs.m[3][0] * rhs.m[0][2] + lhs.m[3][1] * rhs.m[1][2] + lhs.m[3][2] * rhs.m[2][2] + lhs.m[3][3] * rhs.m[3][2];
-        d.m[3][3] = lhs.m[3][0] * rhs.m[0][3] + lhs.m[3][1] * rhs.m[1][3] + lhs.m[3][2] * rhs.m[2][3] + lhs.m[3][3] * rhs.m[3][3];
-    }
-
-    Vec4 Mat4::row(const int idx) const
-    {
-        if (idx < 4 && idx >= 0)
-            return {m[0][idx], m[1][idx], m[2][idx], m[3][idx]};
-        return Vec4{};
-    }
-
-    Vec4 Mat4::col(const int idx) const
-    {
-        if (idx < 3 && idx >= 0)
-            return {m[idx][0], m[idx][1], m[idx][2], m[idx][3]};
-        return Vec4{};
-    }
-
-    Mat4& Mat4::transpose()
-    {
-        *this = transposed();
-        return *this;
-    }
-
-    Mat4 Mat4::transposed() const
-    {
-        return {
-            m[0][0],
-            m[1][0],
-            m[2][0],
-            m[3][0],
-            m[0][1],
-            m[1][1],
-            m[2][1],
-            m[3][1],
-            m[0][2],
-            m[1][2],
-            m[2][2],
-            m[3][2],
-            m[0][3],
-            m[1][3],
-            m[2][3],
-            m[3][3],
-        };
-    }
-
-    void Mat4::setTrans(const Vec3& v)
-    {
-        m[0][3] = v.x;
-        m[1][3] = v.y;
-        m[2][3] = v.z;
-        m[3][3] = 1;
-    }
-
-    void Mat4::setTrans(Real x, Real y, Real z)
-    {
-        m[0][3] = x;
-        m[1][3] = y;
-        m[2][3] = z;
-        m[3][3] = 1;
-    }
-
-    void Mat4::setScale(const Vec3& v)
+    template <typename T>
+    void TMat4<T>::multiplyArrays(TMat4* d, const TMat4* a, const int32_t* parent, const TMat4* b, const size_t n)
     {
-        m[0][0] = v.x;
-        m[1][1] = v.y;
-        m[2][2] = v.z;
-        m[3][3] = 1;
+        if constexpr (std::is_same_v<T, Real>)
+        {
+            Dispatch::kernels().mat4MulIndexed(
+                reinterpret_cast<Real*>(d),
+                reinterpret_cast<const Real*>(a),
+                parent,
+                reinterpret_cast<const Real*>(b),
+                n);
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                d[i] = parent[i] < 0 ? b[i] : a[parent[i]] * b[i];
+        }
     }
 
-    void Mat4::setScale(Real x, Real y, Real z)
+    template <typename T>
+    void TMat4<T>::multiplyHierarchy(TMat4* world, const TMat4* local, const int32_t* parent, const size_t n)
     {
-        m[0][0] = x;
-        m[1][1] = y;
-        m[2][2] = z;
-        m[3][3] = 1;
+        multiplyArrays(world, world, parent, local, n);
     }
 
-    Vec3 Mat4::getTrans() const
+    template <typename T>
+    void TMat4<T>::makeTransforms(TMat4* d, const TVec3<T>* loc, const TVec3<T>* scale, const TQuat<T>* rot, const size_t n)
     {
-        return Vec3(m[0][3], m[1][3], m[2][3]);
-    }
+        static_assert(sizeof(TVec3<T>) == 3 * sizeof(T) && sizeof(TQuat<T>) == 4 * sizeof(T));
 
-    Vec3 Mat4::getScale() const
-    {
-        return Vec3(m[0][0], m[1][1], m[2][2]);
+        if constexpr (std::is_same_v<T, Real>)
+        {
+            Dispatch::kernels().mat4Compose(
+                reinterpret_cast<Real*>(d),
+                reinterpret_cast<const Real*>(loc),
+                reinterpret_cast<const Real*>(scale),
+                reinterpret_cast<const Real*>(rot),
+                n);
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                d[i].makeTransform(loc[i], scale[i], rot[i]);
+        }
     }
 
-    void Mat4::makeIdentity()
+    template <typename T>
+    void TMat4<T>::makeInverseTransforms(TMat4* d, const TVec3<T>* loc, const TVec3<T>* scale, const TQuat<T>* rot, const size_t n)
     {
-        m[0][0] = 1;
-        m[0][1] = 0;
-        m[0][2] = 0;
-        m[0][3] = 0;
-        m[1][0] = 0;
-        m[1][1] = 1;
-        m[1][2] = 0;
-        m[1][3] = 0;
-        m[2][0] = 0;
-        m[2][1] = 0;
-        m[2][2] = 1;
-        m[2][3] = 0;
-        m[3][0] = 0;
-        m[3][1] = 0;
-        m[3][2] = 0;
-        m[3][3] = 1;
+        if constexpr (std::is_same_v<T, Real>)
+        {
+            Dispatch::kernels().mat4ComposeInverse(
+                reinterpret_cast<Real*>(d),
+                reinterpret_cast<const Real*>(loc),
+                reinterpret_cast<const Real*>(scale),
+                reinterpret_cast<const Real*>(rot),
+                n);
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                d[i].makeInverseTransform(loc[i], scale[i], rot[i]);
+        }
     }
 
-    void Mat4::makeTransform(const Vec3& loc, const Vec3& scale, const Quat& rot)
+    template <typename T>
+    void TMat4<T>::invertArrays(TMat4* d, const TMat4* s, const size_t n)
     {
-        Mat3 m3;
-
-        m3.fromQuaternion(rot);
-        makeTransform(loc, scale, m3);
+        if constexpr (std::is_same_v<T, Real>)
+        {
+            Dispatch::kernels().mat4Invert(
+                reinterpret_cast<Real*>(d),
+                reinterpret_cast<const Real*>(s),
+                n);
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                d[i] = s[i].inverted();
+        }
     }
 
-    void Mat4::makeInverseTransform(const Vec3& loc, const Vec3& scale, const Quat& rot)
+    template <typename T>
+    void TMat4<T>::invertArrays(TMat4* d, const TMat4* s, const size_t n, const MatrixKind kind)
     {
-        Mat3 m3;
-        m3.fromQuaternion(rot.inverse());
-        makeInverseTransform(loc, scale, m3);
+        switch (kind)
+        {
+        case MK_RIGID:
+            for (size_t i = 0; i < n; ++i)
+                d[i] = s[i].invertedRigid();
+            break;
+        case MK_AFFINE:
+            for (size_t i = 0; i < n; ++i)
+                d[i] = s[i].invertedAffine();
+            break;
+        default:
+            invertArrays(d, s, n);
+            break;
+        }
     }
 
-    void Mat4::makeTransform(const Vec3& loc, const Vec3& scale, const Mat3& rot)
+    template <typename T>
+    void TMat4<T>::determinants(T* d, const TMat4* s, const size_t n)
     {
-        m[0][0] = scale.x * rot.m[0][0];
-        m[0][1] = scale.y * rot.m[0][1];
-        m[0][2] = scale.z * rot.m[0][2];
-        m[0][3] = loc.x;
-
-        m[1][0] = scale.x * rot.m[1][0];
-        m[1][1] = scale.y * rot.m[1][1];
-        m[1][2] = scale.z * rot.m[1][2];
-        m[1][3] = loc.y;
-
-        m[2][0] = scale.x * rot.m[2][0];
-        m[2][1] = scale.y * rot.m[2][1];
-        m[2][2] = scale.z * rot.m[2][2];
-        m[2][3] = loc.z;
-
-        m[3][0] = m[3][1] = m[3][2] = 0;
-        m[3][3]                     = 1;
+        if constexpr (std::is_same_v<T, Real>)
+            Dispatch::kernels().mat4Det(d, reinterpret_cast<const Real*>(s), n);
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                d[i] = s[i].det();
+        }
     }
 
-    void Mat4::makeInverseTransform(const Vec3& loc, const Vec3& scale, const Mat3& rot)
-    {
-        const Vec3 is = 1.0 / scale;
+    template void TMat4<float>::print() const;
+    template void TMat4<double>::print() const;
 
-        m[0][0] = is.x * rot.m[0][0];
-        m[0][1] = is.y * rot.m[0][1];
-        m[0][2] = is.z * rot.m[0][2];
-        m[0][3] = -loc.x;
+    template void TMat4<float>::multiplyArrays(TMat4*, const TMat4*, const TMat4*, size_t);
+    template void TMat4<double>::multiplyArrays(TMat4*, const TMat4*, const TMat4*, size_t);
 
-        m[1][0] = is.x * rot.m[1][0];
-        m[1][1] = is.y * rot.m[1][1];
-        m[1][2] = is.z * rot.m[1][2];
-        m[1][3] = -loc.y;
+    template void TMat4<float>::multiplyArrays(TMat4*, const TMat4*, const int32_t*, const TMat4*, size_t);
+    template void TMat4<double>::multiplyArrays(TMat4*, const TMat4*, const int32_t*, const TMat4*, size_t);
 
-        m[2][0] = is.x * rot.m[2][0];
-        m[2][1] = is.y * rot.m[2][1];
-        m[2][2] = is.z * rot.m[2][2];
-        m[2][3] = -loc.z;
+    template void TMat4<float>::multiplyHierarchy(TMat4*, const TMat4*, const int32_t*, size_t);
+    template void TMat4<double>::multiplyHierarchy(TMat4*, const TMat4*, const int32_t*, size_t);
 
-        m[3][0] = m[3][1] = m[3][2] = 0;
-        m[3][3]                     = 1;
-    }
+    template void TMat4<float>::makeTransforms(TMat4*, const Vec3f*, const Vec3f*, const Quatf*, size_t);
+    template void TMat4<double>::makeTransforms(TMat4*, const Vec3d*, const Vec3d*, const Quatd*, size_t);
 
-    Real Mat4::det() const
-    {
-        return m[0][3] * m[1][2] * m[2][1] * m[3][0] - m[0][2] * m[1][3] * m[2][1] * m[3][0] - m[0][3] * m[1][1] * m[2][2] * m[3][0] + m[0][1] * m[1][3] * m[2][2] * m[3][0] +
-               m[0][2] * m[1][1] * m[2][3] * m[3][0] - m[0][1] * m[1][2] * m[2][3] * m[3][0] - m[0][3] * m[1][2] * m[2][0] * m[3][1] + m[0][2] * m[1][3] * m[2][0] * m[3][1] +
-               m[0][3] * m[1][0] * m[2][2] * m[3][1] - m[0][0] * m[1][3] * m[2][2] * m[3][1] - m[0][2] * m[1][0] * m[2][3] * m[3][1] + m[0][0] * m[1][2] * m[2][3] * m[3][1] +
-               m[0][3] * m[1][1] * m[2][0] * m[3][2] - m[0][1] * m[1][3] * m[2][0] * m[3][2] - m[0][3] * m[1][0] * m[2][1] * m[3][2] + m[0][0] * m[1][3] * m[2][1] * m[3][2] +
-               m[0][1] * m[1][0] * m[2][3] * m[3][2] - m[0][0] * m[1][1] * m[2][3] * m[3][2] - m[0][2] * m[1][1] * m[2][0] * m[3][3] + m[0][1] * m[1][2] * m[2][0] * m[3][3] +
-               m[0][2] * m[1][0] * m[2][1] * m[3][3] - m[0][0] * m[1][2] * m[2][1] * m[3][3] - m[0][1] * m[1][0] * m[2][2] * m[3][3] + m[0][0] * m[1][1] * m[2][2] * m[3][3];
-    }
+    template void TMat4<float>::makeInverseTransforms(TMat4*, const Vec3f*, const Vec3f*, const Quatf*, size_t);
+    template void TMat4<double>::makeInverseTransforms(TMat4*, const Vec3d*, const Vec3d*, const Quatd*, size_t);
 
-    Mat4 Mat4::inverted() const
-    {
-        Mat4 r;
+    template void TMat4<float>::invertArrays(TMat4*, const TMat4*, size_t);
+    template void TMat4<double>::invertArrays(TMat4*, const TMat4*, size_t);
 
-        Real d = det();
-        if (isZero(d))
-            return Identity;
+    template void TMat4<float>::invertArrays(TMat4*, const TMat4*, size_t, MatrixKind);
+    template void TMat4<double>::invertArrays(TMat4*, const TMat4*, size_t, MatrixKind);
 
-        d = Real(1.0) / d;
-
-        r.m[0][0] = d * (m[1][2] * m[2][3] * m[3][1] - m[1][3] * m[2][2] * m[3][1] + m[1][3] * m[2][1] * m[3][2] - m[1][1] * m[2][3] * m[3][2] - m[1][2] * m[2][1] * m[3][3] + m[1][1] * m[2][2] * m[3][3]);
-        r.m[1][0] = d * (m[0][3] * m[2][2] * m[3][1] - m[0][2] * m[2][3] * m[3][1] - m[0][3] * m[2][1] * m[3][2] + m[0][1] * m[2][3] * m[3][2] + m[0][2] * m[2][1] * m[3][3] - m[0][1] * m[2][2] * m[3][3]);
-        r.m[2][0] = d * (m[0][2] * m[1][3] * m[3][1] - m[0][3] * m[1][2] * m[3][1] + m[0][3] * m[1][1] * m[3][2] - m[0][1] * m[1][3] * m[3][2] - m[0][2] * m[1][1] * m[3][3] + m[0][1] * m[1][2] * m[3][3]);
-        r.m[3][0] = d * (m[0][3] * m[1][2] * m[2][1] - m[0][2] * m[1][3] * m[2][1] - m[0][3] * m[1][1] * m[2][2] + m[0][1] * m[1][3] * m[2][2] + m[0][2] * m[1][1] * m[2][3] - m[0][1] * m[1][2] * m[2][3]);
-        r.m[0][1] = d * (m[1][3] * m[2][2] * m[3][0] - m[1][2] * m[2][3] * m[3][0] - m[1][3] * m[2][0] * m[3][2] + m[1][0] * m[2][3] * m[3][2] + m[1][2] * m[2][0] * m[3][3] - m[1][0] * m[2][2] * m[3][3]);
-        r.m[1][1] = d * (m[0][2] * m[2][3] * m[3][0] - m[0][3] * m[2][2] * m[3][0] + m[0][3] * m[2][0] * m[3][2] - m[0][0] * m[2][3] * m[3][2] - m[0][2] * m[2][0] * m[3][3] + m[0][0] * m[2][2] * m[3][3]);
-        r.m[2][1] = d * (m[0][3] * m[1][2] * m[3][0] - m[0][2] * m[1][3] * m[3][0] - m[0][3] * m[1][0] * m[3][2] + m[0][0] * m[1][3] * m[3][2] + m[0][2] * m[1][0] * m[3][3] - m[0][0] * m[1][2] * m[3][3]);
-        r.m[3][1] = d * (m[0][2] * m[1][3] * m[2][0] - m[0][3] * m[1][2] * m[2][0] + m[0][3] * m[1][0] * m[2][2] - m[0][0] * m[1][3] * m[2][2] - m[0][2] * m[1][0] * m[2][3] + m[0][0] * m[1][2] * m[2][3]);
-        r.m[0][2] = d * (m[1][1] * m[2][3] * m[3][0] - m[1][3] * m[2][1] * m[3][0] + m[1][3] * m[2][0] * m[3][1] - m[1][0] * m[2][3] * m[3][1] - m[1][1] * m[2][0] * m[3][3] + m[1][0] * m[2][1] * m[3][3]);
-        r.m[1][2] = d * (m[0][3] * m[2][1] * m[3][0] - m[0][1] * m[2][3] * m[3][0] - m[0][3] * m[2][0] * m[3][1] + m[0][0] * m[2][3] * m[3][1] + m[0][1] * m[2][0] * m[3][3] - m[0][0] * m[2][1] * m[3][3]);
-        r.m[2][2] = d * (m[0][1] * m[1][3] * m[3][0] - m[0][3] * m[1][1] * m[3][0] + m[0][3] * m[1][0] * m[3][1] - m[0][0] * m[1][3] * m[3][1] - m[0][1] * m[1][0] * m[3][3] + m[0][0] * m[1][1] * m[3][3]);
-        r.m[3][2] = d * (m[0][3] * m[1][1] * m[2][0] - m[0][1] * m[1][3] * m[2][0] - m[0][3] * m[1][0] * m[2][1] + m[0][0] * m[1][3] * m[2][1] + m[0][1] * m[1][0] * m[2][3] - m[0][0] * m[1][1] * m[2][3]);
-        r.m[0][3] = d * (m[1][2] * m[2][1] * m[3][0] - m[1][1] * m[2][2] * m[3][0] - m[1][2] * m[2][0] * m[3][1] + m[1][0] * m[2][2] * m[3][1] + m[1][1] * m[2][0] * m[3][2] - m[1][0] * m[2][1] * m[3][2]);
-        r.m[1][3] = d * (m[0][1] * m[2][2] * m[3][0] - m[0][2] * m[2][1] * m[3][0] + m[0][2] * m[2][0] * m[3][1] - m[0][0] * m[2][2] * m[3][1] - m[0][1] * m[2][0] * m[3][2] + m[0][0] * m[2][1] * m[3][2]);
-        r.m[2][3] = d * (m[0][2] * m[1][1] * m[3][0] - m[0][1] * m[1][2] * m[3][0] - m[0][2] * m[1][0] * m[3][1] + m[0][0] * m[1][2] * m[3][1] + m[0][1] * m[1][0] * m[3][2] - m[0][0] * m[1][1] * m[3][2]);
-        r.m[3][3] = d * (m[0][1] * m[1][2] * m[2][0] - m[0][2] * m[1][1] * m[2][0] + m[0][2] * m[1][0] * m[2][1] - m[0][0] * m[1][2] * m[2][1] - m[0][1] * m[1][0] * m[2][2] + m[0][0] * m[1][1] * m[2][2]);
-
-        return r;
-    }
-
-    void Mat4::print() const
-    {
-        printf("[ %3.3f, %3.3f, %3.3f, %3.3f ]\n", (double)m[0][0], (double)m[0][1], (double)m[0][2], (double)m[0][3]);
-        printf("[ %3.3f, %3.3f, %3.3f, %3.3f ]\n", (double)m[1][0], (double)m[1][1], (double)m[1][2], (double)m[1][3]);
-        printf("[ %3.3f, %3.3f, %3.3f, %3.3f ]\n", (double)m[2][0], (double)m[2][1], (double)m[2][2], (double)m[2][3]);
-        printf("[ %3.3f, %3.3f, %3.3f, %3.3f ]\n", (double)m[3][0], (double)m[3][1], (double)m[3][2], (double)m[3][3]);
-    }
+    template void TMat4<float>::determinants(float*, const TMat4*, size_t);
+    template void TMat4<double>::determinants(double*, const TMat4*, size_t);
 
 }  // namespace Rt2::Math
@@ -21,86 +21,725 @@
 */
 #pragma once
 
+#include <cstdint>
 #include "Vec4.h"
+#include "Math/Forward.h"
+#include "Math/Mat3.h"
+#include "Math/Quat.h"
+#include "Math/Simd.h"
+#include "Math/Transform.h"
 #include "Math/Vec3.h"
 
 namespace Rt2::Math
 {
-    class Mat3;
-    class Quat;
+    // The cheapest inverse that is valid for a matrix, see Mat4::classify.
+    enum MatrixKind
+    {
+        MK_GENERAL = 0,
+        MK_AFFINE,  // bottom row [0 0 0 1]
+        MK_RIGID,   // affine with an orthonormal 3x3 part
+    };
 
-    class Mat4
+    template <typename T>
+    class TMat4
     {
     public:
-        Real m[4][4]{};
+        T m[4][4]{};
 
-        static const Mat4 Identity;
-        static const Mat4 Zero;
+        static const TMat4 Identity;
+        static const TMat4 Zero;
 
     public:
-        Mat4() = default;
+        TMat4() = default;
+
+        TMat4(const TMat4& v) = default;
+
+        constexpr TMat4(T m00,
+                        T m01,
+                        T m02,
+                        T m03,
+                        T m10,
+                        T m11,
+                        T m12,
+                        T m13,
+                        T m20,
+                        T m21,
+                        T m22,
+                        T m23,
+                        T m30,
+                        T m31,
+                        T m32,
+                        T m33);
+
+        template <typename U>
+        explicit constexpr TMat4(const TMat4<U>& v);
+
+        explicit constexpr TMat4(const T* v);
+
+        constexpr TMat4 operator*(const TMat4& lhs) const;
+
+        constexpr TMat4& transpose();
+
+        constexpr TMat4 transposed() const;
+
+        constexpr void setTrans(const TVec3<T>& v);
+
+        constexpr void setTrans(T x, T y, T z);
+
+        constexpr void setScale(const TVec3<T>& v);
+
+        constexpr void setScale(T x, T y, T z);
+
+        constexpr TVec3<T> getScale() const;
+
+        constexpr TVec3<T> getTrans() const;
+
+        constexpr void makeIdentity();
+
+        constexpr T det() const;
+
+        // General inverse. Returns Identity if the matrix is singular.
+        constexpr TMat4 inverted() const;
+
+        // The inverse for a matrix of the given kind, or at least that
+        // kind, as returned by classify.
+        constexpr TMat4 inverted(MatrixKind kind) const;
+
+        // Inverts only the 3x3 part, valid for MK_AFFINE.
+        constexpr TMat4 invertedAffine() const;
+
+        // The transposed rotation with the translation rotated back,
+        // valid for MK_RIGID.
+        constexpr TMat4 invertedRigid() const;
+
+        // Tests the bottom row and the 3x3 part against tolerance.
+        constexpr MatrixKind classify(T tolerance = T(1e-5)) const;
 
-        Mat4(const Mat4& v) = default;
+        constexpr void mulAssign(const TMat4& lhs, const TMat4& rhs);
 
-        Mat4(Real m00,
-             Real m01,
-             Real m02,
-             Real m03,
-             Real m10,
-             Real m11,
-             Real m12,
-             Real m13,
-             Real m20,
-             Real m21,
-             Real m22,
-             Real m23,
-             Real m30,
-             Real m31,
-             Real m32,
-             Real m33);
+        constexpr void makeTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TQuat<T>& rot);
 
-        explicit Mat4(const Real* v);
+        constexpr void makeTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TMat3<T>& rot);
 
-        Mat4 operator*(const Mat4& lhs) const;
+        // The inverse of makeTransform(loc, scale, rot).
+        constexpr void makeInverseTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TQuat<T>& rot);
 
-        Mat4& transpose();
+        // The same, with rot already inverted.
+        constexpr void makeInverseTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TMat3<T>& rot);
 
-        Mat4 transposed() const;
+        // Right handed projections looking down -z. Clip space depth is
+        // [0, 1], near to far. fovY is the vertical field of view in
+        // radians and aspect is width / height.
+        constexpr void makePerspective(T fovY, T aspect, T zNear, T zFar);
 
-        void setTrans(const Vec3& v);
+        constexpr void makeOrthographic(T left, T right, T bottom, T top, T zNear, T zFar);
 
-        void setTrans(Real x, Real y, Real z);
+        // Perspective with the far plane at infinity and depth reversed,
+        // 1 at zNear falling to 0 at infinity.
+        constexpr void makeInfiniteReverseZ(T fovY, T aspect, T zNear);
 
-        void setScale(const Vec3& v);
+        static constexpr void merge(TMat4& d, const TMat4& lhs, const TMat4& rhs);
 
-        void setScale(Real x, Real y, Real z);
+        // d[i] = a[i] * b[i] for n matrices. d may alias a or b.
+        static void multiplyArrays(TMat4* d, const TMat4* a, const TMat4* b, size_t n);
 
-        Vec3 getScale() const;
+        // d[i] = a[parent[i]] * b[i], or b[i] where parent[i] is negative.
+        // Matrices are visited in order, so with a == d and parent[i] < i
+        // this composes local transforms into world transforms.
+        static void multiplyArrays(TMat4* d, const TMat4* a, const int32_t* parent, const TMat4* b, size_t n);
 
-        Vec3 getTrans() const;
+        // Shorthand for multiplyArrays(world, world, parent, local, n).
+        static void multiplyHierarchy(TMat4* world, const TMat4* local, const int32_t* parent, size_t n);
 
-        void makeIdentity();
+        // Batch forms of makeTransform and makeInverseTransform, d[i] is
+        // built from loc[i], scale[i] and rot[i].
+        static void makeTransforms(TMat4* d, const TVec3<T>* loc, const TVec3<T>* scale, const TQuat<T>* rot, size_t n);
 
-        Real det() const;
+        static void makeInverseTransforms(TMat4* d, const TVec3<T>* loc, const TVec3<T>* scale, const TQuat<T>* rot, size_t n);
 
-        Mat4 inverted() const;
+        // d[i] = s[i].inverted(). d may alias s.
+        static void invertArrays(TMat4* d, const TMat4* s, size_t n);
 
-        void mulAssign(const Mat4& lhs, const Mat4& rhs);
+        // d[i] = s[i].inverted(kind), for arrays known to be of one kind.
+        static void invertArrays(TMat4* d, const TMat4* s, size_t n, MatrixKind kind);
 
-        void makeTransform(const Vec3& loc, const Vec3& scale, const Quat& rot);
+        // d[i] = s[i].det().
+        static void determinants(T* d, const TMat4* s, size_t n);
 
-        void makeTransform(const Vec3& loc, const Vec3& scale, const Mat3& rot);
+        constexpr TVec3<T> transformPoint(const TVec3<T>& p) const;
 
-        void makeInverseTransform(const Vec3& loc, const Vec3& scale, const Quat& rot);
+        constexpr TVec3<T> transformDirection(const TVec3<T>& v) const;
 
-        void makeInverseTransform(const Vec3& loc, const Vec3& scale, const Mat3& rot);
+        // Transforms p and divides by the resulting w.
+        constexpr TVec3<T> transformPointProjective(const TVec3<T>& p) const;
 
-        static void merge(Mat4& d, const Mat4& lhs, const Mat4& rhs);
+        // Batch forms of the above, see Transform::apply for the strided forms.
+        void transformPoints(TVec3<T>* d, const TVec3<T>* s, size_t n) const;
 
-        Vec4 row(const int idx) const;
+        void transformPoints(T* d, size_t dStride, const T* s, size_t sStride, size_t n) const;
 
-        Vec4 col(const int idx) const;
+        void transformDirections(TVec3<T>* d, const TVec3<T>* s, size_t n) const;
+
+        void transformDirections(T* d, size_t dStride, const T* s, size_t sStride, size_t n) const;
+
+        void transformPointsProjective(TVec3<T>* d, const TVec3<T>* s, size_t n) const;
+
+        void transformPointsProjective(T* d, size_t dStride, const T* s, size_t sStride, size_t n) const;
+
+        constexpr TVec4<T> row(const int idx) const;
+
+        constexpr TVec4<T> col(const int idx) const;
 
         void print() const;
     };
+
+    template <typename T>
+    constexpr TMat4<T>::TMat4(
+        const T m00,
+        const T m01,
+        const T m02,
+        const T m03,
+        const T m10,
+        const T m11,
+        const T m12,
+        const T m13,
+        const T m20,
+        const T m21,
+        const T m22,
+        const T m23,
+        const T m30,
+        const T m31,
+        const T m32,
+        const T m33)
+    {
+        m[0][0] = m00;
+        m[0][1] = m01;
+        m[0][2] = m02;
+        m[0][3] = m03;
+        m[1][0] = m10;
+        m[1][1] = m11;
+        m[1][2] = m12;
+        m[1][3] = m13;
+        m[2][0] = m20;
+        m[2][1] = m21;
+        m[2][2] = m22;
+        m[2][3] = m23;
+        m[3][0] = m30;
+        m[3][1] = m31;
+        m[3][2] = m32;
+        m[3][3] = m33;
+    }
+
+    template <typename T>
+    template <typename U>
+    constexpr TMat4<T>::TMat4(const TMat4<U>& v)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+                m[i][j] = T(v.m[i][j]);
+        }
+    }
+
+    template <typename T>
+    constexpr TMat4<T>::TMat4(const T* v)
+    {
+        if (v != nullptr)
+        {
+            m[0][0] = *v++;
+            m[0][1] = *v++;
+            m[0][2] = *v++;
+            m[0][3] = *v++;
+            m[1][0] = *v++;
+            m[1][1] = *v++;
+            m[1][2] = *v++;
+            m[1][3] = *v++;
+            m[2][0] = *v++;
+            m[2][1] = *v++;
+            m[2][2] = *v++;
+            m[2][3] = *v++;
+            m[3][0] = *v++;
+            m[3][1] = *v++;
+            m[3][2] = *v++;
+            m[3][3] = *v;
+        }
+    }
+
+    template <typename T>
+    constexpr TMat4<T> TMat4<T>::operator*(const TMat4& lhs) const
+    {
+        TMat4 r;
+#if defined(Math_SIMD_QUAD) && defined(Math_HAS_CONSTANT_EVALUATED)
+        if constexpr (std::is_same_v<T, Real>)
+        {
+            if (!isConstantEvaluated())
+            {
+                Simd::mul4x4(r.m[0], m[0], lhs.m[0]);
+                return r;
+            }
+        }
+#endif
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+                r.m[i][j] = m[i][0] * lhs.m[0][j] + m[i][1] * lhs.m[1][j] + m[i][2] * lhs.m[2][j] + m[i][3] * lhs.m[3][j];
+        }
+        return r;
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::mulAssign(const TMat4& lhs, const TMat4& rhs)
+    {
+        *this = lhs * rhs;
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::merge(TMat4& d, const TMat4& lhs, const TMat4& rhs)
+    {
+        d = lhs * rhs;
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TMat4<T>::transformPoint(const TVec3<T>& p) const
+    {
+        return {
+            m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+            m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+            m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3],
+        };
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TMat4<T>::transformDirection(const TVec3<T>& v) const
+    {
+        return {
+            m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+            m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+            m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z,
+        };
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TMat4<T>::transformPointProjective(const TVec3<T>& p) const
+    {
+        const T w = T(1) / (m[3][0] * p.x + m[3][1] * p.y + m[3][2] * p.z + m[3][3]);
+        return transformPoint(p) * w;
+    }
+
+    template <typename T>
+    void TMat4<T>::transformPoints(TVec3<T>* d, const TVec3<T>* s, const size_t n) const
+    {
+        transformPoints(reinterpret_cast<T*>(d), sizeof(TVec3<T>), reinterpret_cast<const T*>(s), sizeof(TVec3<T>), n);
+    }
+
+    template <typename T>
+    void TMat4<T>::transformPoints(T* d, const size_t dStride, const T* s, const size_t sStride, const size_t n) const
+    {
+        Transform::apply(TM_POINT, m[0], d, dStride, s, sStride, n);
+    }
+
+    template <typename T>
+    void TMat4<T>::transformDirections(TVec3<T>* d, const TVec3<T>* s, const size_t n) const
+    {
+        transformDirections(reinterpret_cast<T*>(d), sizeof(TVec3<T>), reinterpret_cast<const T*>(s), sizeof(TVec3<T>), n);
+    }
+
+    template <typename T>
+    void TMat4<T>::transformDirections(T* d, const size_t dStride, const T* s, const size_t sStride, const size_t n) const
+    {
+        Transform::apply(TM_DIRECTION, m[0], d, dStride, s, sStride, n);
+    }
+
+    template <typename T>
+    void TMat4<T>::transformPointsProjective(TVec3<T>* d, const TVec3<T>* s, const size_t n) const
+    {
+        transformPointsProjective(reinterpret_cast<T*>(d), sizeof(TVec3<T>), reinterpret_cast<const T*>(s), sizeof(TVec3<T>), n);
+    }
+
+    template <typename T>
+    void TMat4<T>::transformPointsProjective(T* d, const size_t dStride, const T* s, const size_t sStride, const size_t n) const
+    {
+        Transform::apply(TM_PROJECTIVE, m[0], d, dStride, s, sStride, n);
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TMat4<T>::row(const int idx) const
+    {
+        if (idx < 4 && idx >= 0)
+            return {m[0][idx], m[1][idx], m[2][idx], m[3][idx]};
+        return TVec4<T>{};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TMat4<T>::col(const int idx) const
+    {
+        if (idx < 4 && idx >= 0)
+            return {m[idx][0], m[idx][1], m[idx][2], m[idx][3]};
+        return TVec4<T>{};
+    }
+
+    template <typename T>
+    constexpr TMat4<T>& TMat4<T>::transpose()
+    {
+        *this = transposed();
+        return *this;
+    }
+
+    template <typename T>
+    constexpr TMat4<T> TMat4<T>::transposed() const
+    {
+        return {
+            m[0][0],
+            m[1][0],
+            m[2][0],
+            m[3][0],
+            m[0][1],
+            m[1][1],
+            m[2][1],
+            m[3][1],
+            m[0][2],
+            m[1][2],
+            m[2][2],
+            m[3][2],
+            m[0][3],
+            m[1][3],
+            m[2][3],
+            m[3][3],
+        };
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::setTrans(const TVec3<T>& v)
+    {
+        m[0][3] = v.x;
+        m[1][3] = v.y;
+        m[2][3] = v.z;
+        m[3][3] = 1;
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::setTrans(T x, T y, T z)
+    {
+        m[0][3] = x;
+        m[1][3] = y;
+        m[2][3] = z;
+        m[3][3] = 1;
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::setScale(const TVec3<T>& v)
+    {
+        m[0][0] = v.x;
+        m[1][1] = v.y;
+        m[2][2] = v.z;
+        m[3][3] = 1;
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::setScale(T x, T y, T z)
+    {
+        m[0][0] = x;
+        m[1][1] = y;
+        m[2][2] = z;
+        m[3][3] = 1;
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TMat4<T>::getTrans() const
+    {
+        return TVec3<T>(m[0][3], m[1][3], m[2][3]);
+    }
+
+    template <typename T>
+    constexpr TVec3<T> TMat4<T>::getScale() const
+    {
+        return TVec3<T>(m[0][0], m[1][1], m[2][2]);
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::makeIdentity()
+    {
+        m[0][0] = 1;
+        m[0][1] = 0;
+        m[0][2] = 0;
+        m[0][3] = 0;
+        m[1][0] = 0;
+        m[1][1] = 1;
+        m[1][2] = 0;
+        m[1][3] = 0;
+        m[2][0] = 0;
+        m[2][1] = 0;
+        m[2][2] = 1;
+        m[2][3] = 0;
+        m[3][0] = 0;
+        m[3][1] = 0;
+        m[3][2] = 0;
+        m[3][3] = 1;
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::makeTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TQuat<T>& rot)
+    {
+        TMat3<T> m3;
+
+        m3.fromQuaternion(rot);
+        makeTransform(loc, scale, m3);
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::makeInverseTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TQuat<T>& rot)
+    {
+        TMat3<T> m3;
+        m3.fromQuaternion(rot.inverse());
+        makeInverseTransform(loc, scale, m3);
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::makeTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TMat3<T>& rot)
+    {
+        m[0][0] = scale.x * rot.m[0][0];
+        m[0][1] = scale.y * rot.m[0][1];
+        m[0][2] = scale.z * rot.m[0][2];
+        m[0][3] = loc.x;
+
+        m[1][0] = scale.x * rot.m[1][0];
+        m[1][1] = scale.y * rot.m[1][1];
+        m[1][2] = scale.z * rot.m[1][2];
+        m[1][3] = loc.y;
+
+        m[2][0] = scale.x * rot.m[2][0];
+        m[2][1] = scale.y * rot.m[2][1];
+        m[2][2] = scale.z * rot.m[2][2];
+        m[2][3] = loc.z;
+
+        m[3][0] = m[3][1] = m[3][2] = 0;
+        m[3][3]                     = 1;
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::makeInverseTransform(const TVec3<T>& loc, const TVec3<T>& scale, const TMat3<T>& rot)
+    {
+        // rot is the inverse rotation. S^-1 R^-1 scales its rows, and
+        // the location is taken back through the result.
+        const TVec3<T> is = T(1.0) / scale;
+
+        const T s[3] = {is.x, is.y, is.z};
+        for (int r = 0; r < 3; ++r)
+        {
+            m[r][0] = s[r] * rot.m[r][0];
+            m[r][1] = s[r] * rot.m[r][1];
+            m[r][2] = s[r] * rot.m[r][2];
+            m[r][3] = -(m[r][0] * loc.x + m[r][1] * loc.y + m[r][2] * loc.z);
+        }
+
+        m[3][0] = m[3][1] = m[3][2] = 0;
+        m[3][3]                     = 1;
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::makePerspective(const T fovY, const T aspect, const T zNear, const T zFar)
+    {
+        T s{}, c{};
+        angles<T>(fovY * T(0.5), s, c);
+
+        const T f  = c / s;
+        const T rd = T(1) / (zNear - zFar);
+
+        *this   = Zero;
+        m[0][0] = f / aspect;
+        m[1][1] = f;
+        m[2][2] = zFar * rd;
+        m[2][3] = zNear * zFar * rd;
+        m[3][2] = -1;
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::makeOrthographic(const T left, const T right, const T bottom, const T top, const T zNear, const T zFar)
+    {
+        const T rw = T(1) / (right - left);
+        const T rh = T(1) / (top - bottom);
+        const T rd = T(1) / (zNear - zFar);
+
+        *this   = Zero;
+        m[0][0] = T(2) * rw;
+        m[0][3] = -(right + left) * rw;
+        m[1][1] = T(2) * rh;
+        m[1][3] = -(top + bottom) * rh;
+        m[2][2] = rd;
+        m[2][3] = zNear * rd;
+        m[3][3] = 1;
+    }
+
+    template <typename T>
+    constexpr void TMat4<T>::makeInfiniteReverseZ(const T fovY, const T aspect, const T zNear)
+    {
+        T s{}, c{};
+        angles<T>(fovY * T(0.5), s, c);
+
+        const T f = c / s;
+
+        *this   = Zero;
+        m[0][0] = f / aspect;
+        m[1][1] = f;
+        m[2][3] = zNear;
+        m[3][2] = -1;
+    }
+
+    template <typename T>
+    constexpr T TMat4<T>::det() const
+    {
+        // Expands along the top two rows, pairing each 2x2 minor of the
+        // top rows with the complementary minor of the bottom rows.
+        const T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+        const T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+        const T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+        const T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+        const T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+        const T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+        const T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+        const T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+        const T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+        const T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+        const T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+        const T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+
+    template <typename T>
+    constexpr TMat4<T> TMat4<T>::inverted() const
+    {
+        // The same twelve minors as det, each shared by four cofactors.
+        const T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+        const T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+        const T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+        const T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+        const T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+        const T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+        const T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+        const T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+        const T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+        const T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+        const T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+        const T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+
+        T d = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        if (isZero<T>(d))
+            return Identity;
+
+        d = T(1.0) / d;
+
+        TMat4 r;
+        r.m[0][0] = d * (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3);
+        r.m[0][1] = d * (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3);
+        r.m[0][2] = d * (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3);
+        r.m[0][3] = d * (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3);
+
+        r.m[1][0] = d * (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1);
+        r.m[1][1] = d * (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1);
+        r.m[1][2] = d * (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1);
+        r.m[1][3] = d * (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1);
+
+        r.m[2][0] = d * (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0);
+        r.m[2][1] = d * (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0);
+        r.m[2][2] = d * (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0);
+        r.m[2][3] = d * (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0);
+
+        r.m[3][0] = d * (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0);
+        r.m[3][1] = d * (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0);
+        r.m[3][2] = d * (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0);
+        r.m[3][3] = d * (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0);
+        return r;
+    }
+
+    template <typename T>
+    constexpr TMat4<T> TMat4<T>::inverted(const MatrixKind kind) const
+    {
+        switch (kind)
+        {
+        case MK_RIGID:
+            return invertedRigid();
+        case MK_AFFINE:
+            return invertedAffine();
+        default:
+            return inverted();
+        }
+    }
+
+    template <typename T>
+    constexpr TMat4<T> TMat4<T>::invertedAffine() const
+    {
+        // The columns of the 3x3 inverse are the cross products of the rows.
+        const T c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+        const T c10 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+        const T c20 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+
+        T d = m[0][0] * c00 + m[0][1] * c10 + m[0][2] * c20;
+        if (isZero<T>(d))
+            return Identity;
+
+        d = T(1.0) / d;
+
+        TMat4 r;
+        r.m[0][0] = d * c00;
+        r.m[1][0] = d * c10;
+        r.m[2][0] = d * c20;
+        r.m[0][1] = d * (m[2][1] * m[0][2] - m[2][2] * m[0][1]);
+        r.m[1][1] = d * (m[2][2] * m[0][0] - m[2][0] * m[0][2]);
+        r.m[2][1] = d * (m[2][0] * m[0][1] - m[2][1] * m[0][0]);
+        r.m[0][2] = d * (m[0][1] * m[1][2] - m[0][2] * m[1][1]);
+        r.m[1][2] = d * (m[0][2] * m[1][0] - m[0][0] * m[1][2]);
+        r.m[2][2] = d * (m[0][0] * m[1][1] - m[0][1] * m[1][0]);
+
+        for (int i = 0; i < 3; ++i)
+            r.m[i][3] = -(r.m[i][0] * m[0][3] + r.m[i][1] * m[1][3] + r.m[i][2] * m[2][3]);
+
+        r.m[3][3] = 1;
+        return r;
+    }
+
+    template <typename T>
+    constexpr TMat4<T> TMat4<T>::invertedRigid() const
+    {
+        TMat4 r;
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+                r.m[i][j] = m[j][i];
+            r.m[i][3] = -(m[0][i] * m[0][3] + m[1][i] * m[1][3] + m[2][i] * m[2][3]);
+        }
+        r.m[3][3] = 1;
+        return r;
+    }
+
+    template <typename T>
+    constexpr MatrixKind TMat4<T>::classify(const T tolerance) const
+    {
+        if (!isZero<T>(m[3][0], tolerance) ||
+            !isZero<T>(m[3][1], tolerance) ||
+            !isZero<T>(m[3][2], tolerance) ||
+            !isZero<T>(m[3][3] - 1, tolerance))
+            return MK_GENERAL;
+
+        // Orthonormal when the rows are unit length and perpendicular.
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = i; j < 3; ++j)
+            {
+                const T d = m[i][0] * m[j][0] + m[i][1] * m[j][1] + m[i][2] * m[j][2];
+                if (!isZero<T>(i == j ? d - 1 : d, tolerance))
+                    return MK_AFFINE;
+            }
+        }
+        return MK_RIGID;
+    }
+
+    template <typename T>
+    inline constexpr TMat4<T> TMat4<T>::Identity = TMat4<T>(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+
+    template <typename T>
+    inline constexpr TMat4<T> TMat4<T>::Zero = TMat4<T>(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
 }  // namespace Rt2::Math
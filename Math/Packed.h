@@ -0,0 +1,270 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstdint>
+#include "Math/Quat.h"
+#include "Math/Simd.h"
+#include "Math/Vec2.h"
+#include "Math/Vec3.h"
+#include "Math/Vec4.h"
+
+namespace Rt2::Math
+{
+    // IEEE 754 half precision. Keeps about three significant digits over
+    // [6.1e-5, 65504]. Doubles are rounded through float.
+    struct Float16
+    {
+        using Storage = uint16_t;
+
+        static Storage encode(const Real v)
+        {
+            return Simd::toHalf(float(v));
+        }
+
+        static Real decode(const Storage v)
+        {
+            return Real(Simd::fromHalf(v));
+        }
+    };
+
+    // Signed normalized, [-1, 1] in steps of 1 / 32767. Suits unit
+    // vectors and rotations. Values outside the range are clamped.
+    struct Snorm16
+    {
+        using Storage = int16_t;
+
+        static Storage encode(const Real v)
+        {
+            const Real c = clamp(v, Real(-1), Real(1)) * Real(32767);
+            return (Storage)(c + (c < 0 ? -Half : Half));
+        }
+
+        static Real decode(const Storage v)
+        {
+            return Max(Real(v) * Real(1.0 / 32767.0), Real(-1));
+        }
+    };
+
+    // Storage only counterparts of Vec2, Vec3 and Vec4. They hold the
+    // encoded components of E and are unpacked for any arithmetic.
+    // Arrays of them are converted in bulk with Precision::convert.
+    template <typename E>
+    class TPackedVec2
+    {
+    public:
+        using Storage  = typename E::Storage;
+        using Unpacked = Vec2;
+
+        static constexpr size_t Size = 2;
+
+        Storage x{}, y{};
+
+    public:
+        TPackedVec2() = default;
+
+        explicit TPackedVec2(const Vec2& v) :
+            x(E::encode(v.x)),
+            y(E::encode(v.y))
+        {
+        }
+
+        Vec2 unpack() const
+        {
+            return {E::decode(x), E::decode(y)};
+        }
+    };
+
+    template <typename E>
+    class TPackedVec3
+    {
+    public:
+        using Storage  = typename E::Storage;
+        using Unpacked = Vec3;
+
+        static constexpr size_t Size = 3;
+
+        Storage x{}, y{}, z{};
+
+    public:
+        TPackedVec3() = default;
+
+        explicit TPackedVec3(const Vec3& v) :
+            x(E::encode(v.x)),
+            y(E::encode(v.y)),
+            z(E::encode(v.z))
+        {
+        }
+
+        Vec3 unpack() const
+        {
+            return {E::decode(x), E::decode(y), E::decode(z)};
+        }
+    };
+
+    template <typename E>
+    class TPackedVec4
+    {
+    public:
+        using Storage  = typename E::Storage;
+        using Unpacked = Vec4;
+
+        static constexpr size_t Size = 4;
+
+        Storage x{}, y{}, z{}, w{};
+
+    public:
+        TPackedVec4() = default;
+
+        explicit TPackedVec4(const Vec4& v) :
+            x(E::encode(v.x)),
+            y(E::encode(v.y)),
+            z(E::encode(v.z)),
+            w(E::encode(v.w))
+        {
+        }
+
+        Vec4 unpack() const
+        {
+            return {E::decode(x), E::decode(y), E::decode(z), E::decode(w)};
+        }
+    };
+
+    // Smallest three encoding of a unit Quat. The component with the
+    // largest magnitude is dropped, after negating the quaternion so
+    // that it is positive, and rebuilt from the other three on decode.
+    // Those lie in [-1 / sqrt(2), 1 / sqrt(2)] and are quantized to Bits
+    // each, below a 2-bit index of the dropped one, highest bits first.
+    template <int Bits>
+    struct SmallestThree
+    {
+        static constexpr uint32_t Max = (1u << Bits) - 1;
+
+        static constexpr Real Scale = Real(Max) * Real(0.70710678118654752440);
+        static constexpr Real Bias  = Real(Max) * Half + Half;
+        static constexpr Real Step  = Real(1.41421356237309504880) / Real(Max);
+        static constexpr Real Low   = Real(0.70710678118654752440);
+
+        static uint64_t encode(const Quat& q)
+        {
+            const Real* c = q.ptr();
+
+            int m = 0;
+            for (int k = 1; k < 4; ++k)
+            {
+                if (Abs(c[k]) > Abs(c[m]))
+                    m = k;
+            }
+
+            const Real sg = c[m] < 0 ? Real(-1) : Real(1);
+
+            uint64_t v = (uint64_t)m;
+            for (int k = 0; k < 4; ++k)
+            {
+                if (k != m)
+                    v = v << Bits | (uint64_t)clamp(c[k] * sg * Scale + Bias, Real(0), Real(Max));
+            }
+            return v;
+        }
+
+        static Quat decode(uint64_t v)
+        {
+            Real c[3];
+            for (int k = 2; k >= 0; --k)
+            {
+                c[k] = Real(v & Max) * Step - Low;
+                v >>= Bits;
+            }
+
+            const int  m = (int)(v & 3);
+            const Real l = 1 - c[0] * c[0] - c[1] * c[1] - c[2] * c[2];
+
+            Quat  q;
+            Real* p = q.ptr();
+            for (int k = 0, j = 0; k < 4; ++k)
+                p[k] = k == m ? std::sqrt(l > 0 ? l : Real(0)) : c[j++];
+            return q;
+        }
+    };
+
+    // A unit Quat in 32 bits, 10 per stored component. The angle
+    // between the decoded and the source rotation stays below 4.4e-3
+    // radians, about 0.25 degrees.
+    class PackedQuat32
+    {
+    public:
+        using Codec = SmallestThree<10>;
+
+        uint32_t v{};
+
+    public:
+        PackedQuat32() = default;
+
+        explicit PackedQuat32(const Quat& q) :
+            v((uint32_t)Codec::encode(q))
+        {
+        }
+
+        Quat unpack() const
+        {
+            return Codec::decode(v);
+        }
+    };
+
+    // A unit Quat in 48 bits, 15 per stored component and one unused.
+    // The angle between the decoded and the source rotation stays below
+    // 1.4e-4 radians, about 0.008 degrees.
+    class PackedQuat48
+    {
+    public:
+        using Codec = SmallestThree<15>;
+
+        // Low word first.
+        uint16_t v[3]{};
+
+    public:
+        PackedQuat48() = default;
+
+        explicit PackedQuat48(const Quat& q)
+        {
+            const uint64_t e = Codec::encode(q);
+
+            v[0] = (uint16_t)e;
+            v[1] = (uint16_t)(e >> 16);
+            v[2] = (uint16_t)(e >> 32);
+        }
+
+        Quat unpack() const
+        {
+            return Codec::decode((uint64_t)v[0] | (uint64_t)v[1] << 16 | (uint64_t)v[2] << 32);
+        }
+    };
+
+    using Vec2h = TPackedVec2<Float16>;
+    using Vec3h = TPackedVec3<Float16>;
+    using Vec4h = TPackedVec4<Float16>;
+
+    using Vec2sn16 = TPackedVec2<Snorm16>;
+    using Vec3sn16 = TPackedVec3<Snorm16>;
+    using Vec4sn16 = TPackedVec4<Snorm16>;
+
+}  // namespace Rt2::Math
@@ -0,0 +1,80 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Precision.h"
+#include "Math/Dispatch.h"
+#include "Math/Packed.h"
+
+namespace Rt2::Math
+{
+    void Precision::convert(float* dst, const double* src, const size_t n)
+    {
+        Dispatch::kernels().narrow(dst, src, n);
+    }
+
+    void Precision::convert(double* dst, const float* src, const size_t n)
+    {
+        Dispatch::kernels().widen(dst, src, n);
+    }
+
+    void Precision::convert(uint16_t* dst, const Real* src, const size_t n)
+    {
+        Dispatch::kernels().toHalf(dst, src, n);
+    }
+
+    void Precision::convert(Real* dst, const uint16_t* src, const size_t n)
+    {
+        Dispatch::kernels().fromHalf(dst, src, n);
+    }
+
+    void Precision::convert(int16_t* dst, const Real* src, const size_t n)
+    {
+        Dispatch::kernels().toSnorm16(dst, src, n);
+    }
+
+    void Precision::convert(Real* dst, const int16_t* src, const size_t n)
+    {
+        Dispatch::kernels().fromSnorm16(dst, src, n);
+    }
+
+    void Precision::convert(PackedQuat32* dst, const Quat* src, const size_t n)
+    {
+        static_assert(sizeof(PackedQuat32) == 4 && sizeof(Quat) == 4 * sizeof(Real));
+        Dispatch::kernels().quatToSmallest32(reinterpret_cast<uint32_t*>(dst), reinterpret_cast<const Real*>(src), n);
+    }
+
+    void Precision::convert(Quat* dst, const PackedQuat32* src, const size_t n)
+    {
+        Dispatch::kernels().quatFromSmallest32(reinterpret_cast<Real*>(dst), reinterpret_cast<const uint32_t*>(src), n);
+    }
+
+    void Precision::convert(PackedQuat48* dst, const Quat* src, const size_t n)
+    {
+        static_assert(sizeof(PackedQuat48) == 6);
+        Dispatch::kernels().quatToSmallest48(reinterpret_cast<uint16_t*>(dst), reinterpret_cast<const Real*>(src), n);
+    }
+
+    void Precision::convert(Quat* dst, const PackedQuat48* src, const size_t n)
+    {
+        Dispatch::kernels().quatFromSmallest48(reinterpret_cast<Real*>(dst), reinterpret_cast<const uint16_t*>(src), n);
+    }
+
+}  // namespace Rt2::Math
@@ -0,0 +1,111 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "Math/Forward.h"
+
+namespace Rt2::Math
+{
+    // Bulk conversion between float and double storage. Large world
+    // coordinates can stay in double while the inner loops run on a
+    // float copy, and the results are widened back afterwards.
+    class Precision
+    {
+    public:
+        static void convert(float* dst, const double* src, size_t n);
+
+        static void convert(double* dst, const float* src, size_t n);
+
+        // Converts n elements of any of the value types, for example
+        // Precision::convert(Vec3f*, const Vec3d*, n), as one run of
+        // scalars.
+        template <template <typename> class V, typename To, typename From>
+        static void convert(V<To>* dst, const V<From>* src, size_t n);
+
+        // Packed storage, see Packed.h. uint16_t runs hold IEEE halves
+        // and int16_t runs hold snorm16 values.
+        static void convert(uint16_t* dst, const Real* src, size_t n);
+
+        static void convert(Real* dst, const uint16_t* src, size_t n);
+
+        static void convert(int16_t* dst, const Real* src, size_t n);
+
+        static void convert(Real* dst, const int16_t* src, size_t n);
+
+        // Smallest three quaternions, see PackedQuat32 and PackedQuat48.
+        static void convert(PackedQuat32* dst, const Quat* src, size_t n);
+
+        static void convert(Quat* dst, const PackedQuat32* src, size_t n);
+
+        static void convert(PackedQuat48* dst, const Quat* src, size_t n);
+
+        static void convert(Quat* dst, const PackedQuat48* src, size_t n);
+
+        // Encodes or decodes n packed vectors, for example
+        // Precision::convert(Vec3h*, const Vec3*, n).
+        template <typename P>
+        static void convert(P* dst, const typename P::Unpacked* src, size_t n);
+
+        template <typename P>
+        static void convert(typename P::Unpacked* dst, const P* src, size_t n);
+    };
+
+    template <template <typename> class V, typename To, typename From>
+    void Precision::convert(V<To>* dst, const V<From>* src, const size_t n)
+    {
+        constexpr size_t Scalars = sizeof(V<From>) / sizeof(From);
+
+        static_assert(std::is_trivially_copyable_v<V<To>> && std::is_trivially_copyable_v<V<From>>);
+        static_assert(sizeof(V<To>) == Scalars * sizeof(To) && sizeof(V<From>) == Scalars * sizeof(From),
+                      "only tightly packed types can be converted as a run of scalars");
+
+        if constexpr (std::is_same_v<To, From>)
+            std::copy_n(src, n, dst);
+        else
+            convert(reinterpret_cast<To*>(dst), reinterpret_cast<const From*>(src), n * Scalars);
+    }
+
+    template <typename P>
+    void Precision::convert(P* dst, const typename P::Unpacked* src, const size_t n)
+    {
+        using S = typename P::Storage;
+        static_assert(sizeof(P) == P::Size * sizeof(S) && sizeof(*src) == P::Size * sizeof(Real),
+                      "only tightly packed types can be converted as a run of scalars");
+
+        convert(reinterpret_cast<S*>(dst), reinterpret_cast<const Real*>(src), n * P::Size);
+    }
+
+    template <typename P>
+    void Precision::convert(typename P::Unpacked* dst, const P* src, const size_t n)
+    {
+        using S = typename P::Storage;
+        static_assert(sizeof(P) == P::Size * sizeof(S) && sizeof(*dst) == P::Size * sizeof(Real),
+                      "only tightly packed types can be converted as a run of scalars");
+
+        convert(reinterpret_cast<Real*>(dst), reinterpret_cast<const S*>(src), n * P::Size);
+    }
+
+}  // namespace Rt2::Math
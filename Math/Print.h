@@ -21,6 +21,7 @@
 */
 #pragma once
 
+#include "Math/Forward.h"
 #include "Math/Scalar.h"
 #include "Utils/StackStream.h"
 #include "Utils/StreamConverters/Set.h"
@@ -58,13 +59,7 @@ namespace Rt2::Math
 #endif
 
     class Box2d;
-    class Vec2;
-    class Vec4;
-    class Vec3;
     class Rect;
-    class Mat3;
-    class Quat;
-    class Mat4;
 
     class Printer
     {
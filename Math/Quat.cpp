@@ -22,16 +22,29 @@
 #include "Math/Quat.h"
 #include <cstdio>
 
+#include "Math/Mat3.h"
 #include "Print.h"
 
 
 namespace Rt2::Math
 {
-    const Quat Quat::Identity = Quat(1, 0, 0, 0);
-    const Quat Quat::Zero     = Quat(0, 0, 0, 0);
+    template <typename T>
+    void TQuat<T>::print() const
+    {
+        Printer::print(Quat(*this));
+    }
 
-    void Quat::print() const
+    template <typename T>
+    void TQuat<T>::transformPoints(T* d, const size_t dStride, const T* s, const size_t sStride, const size_t n) const
     {
-        Printer::print(*this);
+        TMat3<T> r;
+        r.fromQuaternion(*this);
+        r.transformPoints(d, dStride, s, sStride, n);
     }
+
+    template void TQuat<float>::print() const;
+    template void TQuat<double>::print() const;
+
+    template void TQuat<float>::transformPoints(float*, size_t, const float*, size_t, size_t) const;
+    template void TQuat<double>::transformPoints(double*, size_t, const double*, size_t, size_t) const;
 }  // namespace Rt2::Math
@@ -21,25 +21,33 @@
 */
 #pragma once
 
+#include "Math/Forward.h"
 #include "Math/Math.h"
+#include "Math/Transform.h"
 #include "Math/Vec3.h"
 
 namespace Rt2::Math
 {
-    class Quat
+    template <typename T>
+    class TQuat
     {
     public:
-        static const Quat Identity;
-        static const Quat Zero;
+        static const TQuat Identity;
+        static const TQuat Zero;
 
-        Real w{1}, x{}, y{}, z{};
+        // slerp falls back to nlerp when the cosine between the two
+        // quaternions is within this of one, where they agree to well
+        // under 1e-6 radians and the sine ratio loses precision.
+        static constexpr T SlerpLinear = T(1e-4);
+
+        T w{1}, x{}, y{}, z{};
 
     public:
-        Quat() = default;
+        TQuat() = default;
 
-        Quat(const Quat& v) = default;
+        TQuat(const TQuat& v) = default;
 
-        Quat(const Real nw, const Real nx, const Real ny, const Real nz) :
+        constexpr TQuat(const T nw, const T nx, const T ny, const T nz) :
             w(nw),
             x(nx),
             y(ny),
@@ -47,17 +55,26 @@ namespace Rt2::Math
         {
         }
 
-        Quat(const Real xRad, const Real yRad, const Real zRad)
+        template <typename U>
+        explicit constexpr TQuat(const TQuat<U>& q) :
+            w(T(q.w)),
+            x(T(q.x)),
+            y(T(q.y)),
+            z(T(q.z))
+        {
+        }
+
+        constexpr TQuat(const T xRad, const T yRad, const T zRad)
         {
             (*this).makeRotXyz(xRad, yRad, zRad);
         }
 
-        explicit Quat(const Vec3& vec)
+        explicit constexpr TQuat(const TVec3<T>& vec)
         {
             (*this).makeRotXyz(vec.x, vec.y, vec.z);
         }
 
-        explicit Quat(const Real* p)
+        explicit constexpr TQuat(const T* p)
         {
             if (p != nullptr)
             {
@@ -68,15 +85,15 @@ namespace Rt2::Math
             }
         }
 
-        void makeIdentity()
+        constexpr void makeIdentity()
         {
             w = 1;
             x = y = z = 0;
         }
 
-        void makeRotXyz(const Real xRad, const Real yRad, const Real zRad)
+        constexpr void makeRotXyz(const T xRad, const T yRad, const T zRad)
         {
-            Quat q0, q1, q2;
+            TQuat q0, q1, q2;
             q0.makeRotX(xRad);
             q1.makeRotY(yRad);
             q2.makeRotZ(zRad);
@@ -85,31 +102,31 @@ namespace Rt2::Math
             this->normalize();
         }
 
-        void makeRotX(const Real v)
+        constexpr void makeRotX(const T v)
         {
-            angles(v * Real(0.5), x, w);
+            angles<T>(v * T(0.5), x, w);
             y = z = 0;
         }
 
-        void makeRotY(const Real v)
+        constexpr void makeRotY(const T v)
         {
-            angles(v * Real(0.5), y, w);
+            angles<T>(v * T(0.5), y, w);
             x = z = 0;
         }
 
-        void makeRotZ(const Real v)
+        constexpr void makeRotZ(const T v)
         {
-            angles(v * Real(0.5), z, w);
+            angles<T>(v * T(0.5), z, w);
             x = y = 0;
         }
 
-        Vec3 toAxis() const
+        constexpr TVec3<T> toAxis() const
         {
-            Real wSq = Real(1.0) - w * w;
-            if (wSq < Epsilon)
-                return Vec3::UnitZ;
+            T wSq = T(1.0) - w * w;
+            if (wSq < Limits<T>::Epsilon)
+                return TVec3<T>::UnitZ;
 
-            wSq = Real(1.0) / wSq;
+            wSq = T(1.0) / wSq;
             return {
                 x * wSq,
                 y * wSq,
@@ -117,20 +134,20 @@ namespace Rt2::Math
             };
         }
 
-        Real length() const
+        constexpr T length() const
         {
-            if (const Real len = length2();
-                len > Epsilon)
-                return RtSqrt(len);
-            return Real(0.0);
+            if (const T len = length2();
+                len > Limits<T>::Epsilon)
+                return squareRoot<T>(len);
+            return T(0.0);
         }
 
-        void normalize()
+        constexpr void normalize()
         {
-            if (Real len = length2();
-                len > Epsilon)
+            if (T len = length2();
+                len > Limits<T>::Epsilon)
             {
-                len = RtRSqrt(len);
+                len = rsqrt<T>(len);
                 w *= len;
                 x *= len;
                 y *= len;
@@ -138,24 +155,24 @@ namespace Rt2::Math
             }
         }
 
-        Quat normalized() const
+        constexpr TQuat normalized() const
         {
-            Quat q(w, x, y, z);
+            TQuat q(w, x, y, z);
             q.normalize();
             return q;
         }
 
-        Quat inverse() const
+        constexpr TQuat inverse() const
         {
             return {w, -x, -y, -z};
         }
 
-        Quat operator-() const
+        constexpr TQuat operator-() const
         {
             return {w, -x, -y, -z};
         }
 
-        Quat& invert()
+        constexpr TQuat& invert()
         {
             x = -x;
             y = -y;
@@ -163,12 +180,12 @@ namespace Rt2::Math
             return *this;
         }
 
-        Quat operator*(const Real& v) const
+        constexpr TQuat operator*(const T& v) const
         {
             return {w * v, x * v, y * v, z * v};
         }
 
-        Quat& operator*=(const Real& v)
+        constexpr TQuat& operator*=(const T& v)
         {
             w *= v;
             x *= v;
@@ -177,16 +194,13 @@ namespace Rt2::Math
             return *this;
         }
 
-        Quat& operator*=(const Quat& v)
+        constexpr TQuat& operator*=(const TQuat& v)
         {
-            w = w * v.w - x * v.x - y * v.y - z * v.z;
-            x = w * v.x + x * v.w + y * v.z - z * v.y;
-            y = w * v.y + y * v.w + z * v.x - x * v.z;
-            z = w * v.z + z * v.w + x * v.y - y * v.x;
+            *this = *this * v;
             return *this;
         }
 
-        Quat operator*(const Quat& v) const
+        constexpr TQuat operator*(const TQuat& v) const
         {
             return {
                 w * v.w - x * v.x - y * v.y - z * v.z,
@@ -196,62 +210,132 @@ namespace Rt2::Math
             };
         }
 
-        Vec3 operator*(const Vec3& v) const
+        constexpr TVec3<T> operator*(const TVec3<T>& v) const
         {
-            const Vec3 c(x, y, z);
+            const TVec3<T> c(x, y, z);
 
-            Vec3 a = c.cross(v);
-            Vec3 b = c.cross(a);
-            a *= Real(2) * w;
-            b *= Real(2);
+            TVec3<T> a = c.cross(v);
+            TVec3<T> b = c.cross(a);
+            a *= T(2) * w;
+            b *= T(2);
             return v + a + b;
         }
 
-        Quat operator+(const Real& v) const
+        constexpr TQuat operator+(const T& v) const
         {
             return {w + v, x + v, y + v, z + v};
         }
 
-        Quat operator+(const Quat& v) const
+        constexpr TQuat operator+(const TQuat& v) const
         {
             return {w + v.w, x + v.x, y + v.y, z + v.z};
         }
 
-        Quat operator-(const Real& v) const
+        constexpr TQuat operator-(const T& v) const
         {
             return {w - v, x - v, y - v, z - v};
         }
 
-        Quat operator-(const Quat& v) const
+        constexpr TQuat operator-(const TQuat& v) const
         {
             return {w - v.w, x - v.x, y - v.y, z - v.z};
         }
 
-        bool operator==(const Quat& v) const
+        constexpr bool operator==(const TQuat& v) const
         {
-            return eq(x, v.x) && eq(y, v.y) && eq(z, v.z) && eq(w, v.w);
+            return eq<T>(x, v.x) && eq<T>(y, v.y) && eq<T>(z, v.z) && eq<T>(w, v.w);
         }
 
-        bool operator!=(const Quat& v) const
+        constexpr bool operator!=(const TQuat& v) const
         {
-            return neq(x, v.x) && neq(y, v.y) && neq(z, v.z) && neq(w, v.w);
+            return neq<T>(x, v.x) && neq<T>(y, v.y) && neq<T>(z, v.z) && neq<T>(w, v.w);
         }
 
-        Real length2() const
+        constexpr T length2() const
         {
             return w * w + x * x + y * y + z * z;
         }
 
-        Real* ptr()
+        constexpr T dot(const TQuat& v) const
+        {
+            return w * v.w + x * v.x + y * v.y + z * v.z;
+        }
+
+        // Interpolation from this at t = 0 to v at t = 1 along the
+        // shorter arc, for unit quaternions.
+        //
+        // nlerp normalizes the linear blend, its angular speed peaks
+        // at t = 0.5. slerp keeps the speed constant. fastSlerp warps t
+        // with a polynomial fit of the slerp speed before the nlerp,
+        // which keeps it within 1e-3 radians of slerp.
+        constexpr TQuat nlerp(const TQuat& v, const T t) const
+        {
+            const T b = dot(v) < T(0) ? -t : t;
+            return TQuat(w + (v.w * b - w * t),
+                         x + (v.x * b - x * t),
+                         y + (v.y * b - y * t),
+                         z + (v.z * b - z * t))
+                .normalized();
+        }
+
+        TQuat slerp(const TQuat& v, const T t) const
+        {
+            const T d = dot(v), c = Abs<T>(d);
+            if (c > T(1) - SlerpLinear)
+                return nlerp(v, t);
+
+            const T theta = std::acos(c);
+            const T rs    = T(1) / std::sin(theta);
+
+            const T a = std::sin((T(1) - t) * theta) * rs;
+            const T b = std::sin(t * theta) * rs;
+            return *this * a + v * (d < T(0) ? -b : b);
+        }
+
+        constexpr TQuat fastSlerp(const TQuat& v, const T t) const
+        {
+            const T d = Abs<T>(dot(v));
+            const T a = T(1.0904) + d * (T(-3.2452) + d * (T(3.55645) - d * T(1.43519)));
+            const T b = T(0.848013) + d * (T(-1.06021) + d * T(0.215638));
+            const T h = t - T(0.5);
+            return nlerp(v, t + t * h * (t - T(1)) * (a * h * h + b));
+        }
+
+        constexpr T* ptr()
         {
             return &w;
         }
 
-        const Real* ptr() const
+        constexpr const T* ptr() const
         {
             return &w;
         }
 
+        // Batch forms of rotation, expanding it to a matrix once, see
+        // Transform::apply.
+        void transformPoints(TVec3<T>* d, const TVec3<T>* s, size_t n) const
+        {
+            transformPoints(reinterpret_cast<T*>(d), sizeof(TVec3<T>), reinterpret_cast<const T*>(s), sizeof(TVec3<T>), n);
+        }
+
+        void transformPoints(T* d, size_t dStride, const T* s, size_t sStride, size_t n) const;
+
+        void transformDirections(TVec3<T>* d, const TVec3<T>* s, const size_t n) const
+        {
+            transformPoints(d, s, n);
+        }
+
+        void transformDirections(T* d, const size_t dStride, const T* s, const size_t sStride, const size_t n) const
+        {
+            transformPoints(d, dStride, s, sStride, n);
+        }
+
         void print() const;
     };
+
+    template <typename T>
+    inline constexpr TQuat<T> TQuat<T>::Identity = TQuat<T>(1, 0, 0, 0);
+
+    template <typename T>
+    inline constexpr TQuat<T> TQuat<T>::Zero = TQuat<T>(0, 0, 0, 0);
 }  // namespace Rt2::Math
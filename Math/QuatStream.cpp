@@ -0,0 +1,208 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/QuatStream.h"
+#include "Math/Dispatch.h"
+
+namespace Rt2::Math
+{
+    namespace
+    {
+        size_t common(const QuatStream& a, const QuatStream& b)
+        {
+            return a.size() < b.size() ? a.size() : b.size();
+        }
+
+        size_t common(const QuatStream& a, const QuatStream& b, const RealArray& t)
+        {
+            const size_t n = common(a, b);
+            return n < t.size() ? n : t.size();
+        }
+
+        QuatOut out(QuatStream& s)
+        {
+            return {s.w(), s.x(), s.y(), s.z()};
+        }
+
+        QuatIn in(const QuatStream& s)
+        {
+            return {s.w(), s.x(), s.y(), s.z()};
+        }
+
+        Vec3Out out(Vec3Stream& s)
+        {
+            return {s.x(), s.y(), s.z()};
+        }
+
+        Vec3In in(const Vec3Stream& s)
+        {
+            return {s.x(), s.y(), s.z()};
+        }
+    }  // namespace
+
+    QuatStream::QuatStream(const size_t size)
+    {
+        resize(size);
+    }
+
+    QuatStream::QuatStream(const Quat* src, const size_t size)
+    {
+        assign(src, size);
+    }
+
+    void QuatStream::reserve(const size_t size)
+    {
+        _w.reserve(size);
+        _x.reserve(size);
+        _y.reserve(size);
+        _z.reserve(size);
+    }
+
+    void QuatStream::resize(const size_t size)
+    {
+        _w.resize(size);
+        _x.resize(size);
+        _y.resize(size);
+        _z.resize(size);
+    }
+
+    void QuatStream::clear()
+    {
+        _w.clear();
+        _x.clear();
+        _y.clear();
+        _z.clear();
+    }
+
+    void QuatStream::push(const Quat& q)
+    {
+        _w.push_back(q.w);
+        _x.push_back(q.x);
+        _y.push_back(q.y);
+        _z.push_back(q.z);
+    }
+
+    void QuatStream::assign(const Quat* src, const size_t size)
+    {
+        resize(size);
+        if (src)
+        {
+            for (size_t i = 0; i < size; ++i)
+                set(i, src[i]);
+        }
+    }
+
+    void QuatStream::copy(Quat* dest) const
+    {
+        if (dest)
+        {
+            const size_t n = size();
+            for (size_t i = 0; i < n; ++i)
+                dest[i] = at(i);
+        }
+    }
+
+    void QuatStream::normalize()
+    {
+        Dispatch::kernels().quatNormalize(out(*this), in(*this), size());
+    }
+
+    void QuatStream::mul(QuatStream& dest, const QuatStream& a, const QuatStream& b)
+    {
+        const size_t n = common(a, b);
+        dest.resize(n);
+        Dispatch::kernels().quatMul(out(dest), in(a), in(b), n);
+    }
+
+    void QuatStream::rotate(Vec3Stream& dest, const QuatStream& q, const Vec3Stream& v)
+    {
+        const size_t n = q.size() < v.size() ? q.size() : v.size();
+        dest.resize(n);
+        Dispatch::kernels().quatRotate(out(dest), in(q), nullptr, in(v), n);
+    }
+
+    void QuatStream::rotate(Vec3Stream& dest, const QuatStream& q, const uint32_t* index, const Vec3Stream& v)
+    {
+        dest.resize(v.size());
+        Dispatch::kernels().quatRotate(out(dest), in(q), index, in(v), v.size());
+    }
+
+    void QuatStream::normalize(QuatStream& dest, const QuatStream& a)
+    {
+        dest.resize(a.size());
+        Dispatch::kernels().quatNormalize(out(dest), in(a), a.size());
+    }
+
+    void QuatStream::conjugate(QuatStream& dest, const QuatStream& a)
+    {
+        dest.resize(a.size());
+        Dispatch::kernels().quatConjugate(out(dest), in(a), a.size());
+    }
+
+    void QuatStream::inverse(QuatStream& dest, const QuatStream& a)
+    {
+        dest.resize(a.size());
+        Dispatch::kernels().quatInverse(out(dest), in(a), a.size());
+    }
+
+    void QuatStream::nlerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, const RealArray& t)
+    {
+        const size_t n = common(a, b, t);
+        dest.resize(n);
+        Dispatch::kernels().quatNlerp(out(dest), in(a), in(b), t.data(), 0, n);
+    }
+
+    void QuatStream::nlerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, const Real t)
+    {
+        const size_t n = common(a, b);
+        dest.resize(n);
+        Dispatch::kernels().quatNlerp(out(dest), in(a), in(b), nullptr, t, n);
+    }
+
+    void QuatStream::slerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, const RealArray& t)
+    {
+        const size_t n = common(a, b, t);
+        dest.resize(n);
+        Dispatch::kernels().quatSlerp(out(dest), in(a), in(b), t.data(), 0, n);
+    }
+
+    void QuatStream::slerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, const Real t)
+    {
+        const size_t n = common(a, b);
+        dest.resize(n);
+        Dispatch::kernels().quatSlerp(out(dest), in(a), in(b), nullptr, t, n);
+    }
+
+    void QuatStream::fastSlerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, const RealArray& t)
+    {
+        const size_t n = common(a, b, t);
+        dest.resize(n);
+        Dispatch::kernels().quatFastSlerp(out(dest), in(a), in(b), t.data(), 0, n);
+    }
+
+    void QuatStream::fastSlerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, const Real t)
+    {
+        const size_t n = common(a, b);
+        dest.resize(n);
+        Dispatch::kernels().quatFastSlerp(out(dest), in(a), in(b), nullptr, t, n);
+    }
+
+}  // namespace Rt2::Math
@@ -0,0 +1,172 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstdint>
+#include "Math/Quat.h"
+#include "Math/Vec3Stream.h"
+
+namespace Rt2::Math
+{
+    // Structure of arrays storage for Quat, see Vec3Stream.
+    class QuatStream
+    {
+    private:
+        RealArray _w, _x, _y, _z;
+
+    public:
+        QuatStream() = default;
+
+        explicit QuatStream(size_t size);
+
+        QuatStream(const Quat* src, size_t size);
+
+        void reserve(size_t size);
+
+        void resize(size_t size);
+
+        void clear();
+
+        void push(const Quat& q);
+
+        void set(size_t i, const Quat& q);
+
+        Quat at(size_t i) const;
+
+        void assign(const Quat* src, size_t size);
+
+        void copy(Quat* dest) const;
+
+        size_t size() const;
+
+        Real* w();
+
+        Real* x();
+
+        Real* y();
+
+        Real* z();
+
+        const Real* w() const;
+
+        const Real* x() const;
+
+        const Real* y() const;
+
+        const Real* z() const;
+
+        void normalize();
+
+        // d[i] = a[i] * b[i]
+        static void mul(QuatStream& dest, const QuatStream& a, const QuatStream& b);
+
+        // d[i] = q[i] * v[i], rotating each vector by its quaternion.
+        static void rotate(Vec3Stream& dest, const QuatStream& q, const Vec3Stream& v);
+
+        // d[i] = q[index[i]] * v[i], for example the local points of many
+        // bodies rotated by the orientation of the body each belongs to.
+        // index holds v.size() entries below q.size().
+        static void rotate(Vec3Stream& dest, const QuatStream& q, const uint32_t* index, const Vec3Stream& v);
+
+        static void normalize(QuatStream& dest, const QuatStream& a);
+
+        // Negates the vector part, the inverse of unit quaternions.
+        static void conjugate(QuatStream& dest, const QuatStream& a);
+
+        // The conjugate over the squared length, which unlike
+        // Quat::inverse also holds for quaternions of any length.
+        static void inverse(QuatStream& dest, const QuatStream& a);
+
+        // Element wise Quat::nlerp, slerp and fastSlerp from a to b,
+        // either with a factor per element or one for all.
+        static void nlerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, const RealArray& t);
+
+        static void nlerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, Real t);
+
+        static void slerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, const RealArray& t);
+
+        static void slerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, Real t);
+
+        static void fastSlerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, const RealArray& t);
+
+        static void fastSlerp(QuatStream& dest, const QuatStream& a, const QuatStream& b, Real t);
+    };
+
+    inline size_t QuatStream::size() const
+    {
+        return _w.size();
+    }
+
+    inline Real* QuatStream::w()
+    {
+        return _w.data();
+    }
+
+    inline Real* QuatStream::x()
+    {
+        return _x.data();
+    }
+
+    inline Real* QuatStream::y()
+    {
+        return _y.data();
+    }
+
+    inline Real* QuatStream::z()
+    {
+        return _z.data();
+    }
+
+    inline const Real* QuatStream::w() const
+    {
+        return _w.data();
+    }
+
+    inline const Real* QuatStream::x() const
+    {
+        return _x.data();
+    }
+
+    inline const Real* QuatStream::y() const
+    {
+        return _y.data();
+    }
+
+    inline const Real* QuatStream::z() const
+    {
+        return _z.data();
+    }
+
+    inline void QuatStream::set(const size_t i, const Quat& q)
+    {
+        _w[i] = q.w;
+        _x[i] = q.x;
+        _y[i] = q.y;
+        _z[i] = q.z;
+    }
+
+    inline Quat QuatStream::at(const size_t i) const
+    {
+        return {_w[i], _x[i], _y[i], _z[i]};
+    }
+
+}  // namespace Rt2::Math
@@ -55,6 +55,11 @@ namespace Rt2::Math
 #endif
     }
 
+    void Rand::init(const U32 seed)
+    {
+        srand(seed);
+    }
+
     Real Rand::real()
     {
         return Real(rand()) / Real(RAND_MAX);
@@ -30,6 +30,9 @@ namespace Rt2::Math
     {
     public:
         static void init();
+
+        // Seeds the generator with a fixed value, for repeatable runs.
+        static void init(U32 seed);
         static Real real();
         static Real unit();
         static U8   u8();
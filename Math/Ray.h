@@ -75,4 +75,56 @@ namespace Rt2::Math
 
         void print() const;
     };
+
+    // A Ray with the per axis terms of the box slab test computed once,
+    // for testing one ray against many boxes, see TBox3d::hit.
+    class PreparedRay
+    {
+    public:
+        Vec3 origin;
+        Vec3 direction;
+
+        // 1 / direction. Components that compare equal to zero, where
+        // the ray runs parallel to the slab, hold the largest float of
+        // their sign so that the slab test stays free of NaN.
+        Vec3 invDir;
+
+        // 1 where the direction is negative, in which case the ray
+        // enters the slab of that axis through bMax.
+        int sign[3]{};
+
+    public:
+        PreparedRay() = default;
+
+        explicit PreparedRay(const Ray& ray)
+        {
+            prepare(ray);
+        }
+
+        void prepare(const Ray& ray)
+        {
+            origin    = ray.origin;
+            direction = ray.direction;
+
+            const Real* dp = direction.ptr();
+            Real*       ip = invDir.ptr();
+            for (int i = 0; i < 3; ++i)
+            {
+                sign[i] = dp[i] < 0 ? 1 : 0;
+                if (eq(dp[i], 0))
+                    ip[i] = sign[i] ? -Real(Limits<float>::Infinity) : Real(Limits<float>::Infinity);
+                else
+                    ip[i] = 1 / dp[i];
+            }
+        }
+
+        Vec3 at(const Real& t) const
+        {
+            return {
+                origin.x + direction.x * t,
+                origin.y + direction.y * t,
+                origin.z + direction.z * t,
+            };
+        }
+    };
 }  // namespace Rt2::Math
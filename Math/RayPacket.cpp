@@ -0,0 +1,102 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/RayPacket.h"
+#include "Math/Dispatch.h"
+
+namespace Rt2::Math
+{
+    template <size_t Width>
+    TRayPacket<Width>::TRayPacket()
+    {
+        clear();
+    }
+
+    template <size_t Width>
+    void TRayPacket<Width>::clear()
+    {
+        for (int r = 0; r < RP_MAX; ++r)
+        {
+            for (size_t i = 0; i < Width; ++i)
+                rows[r][i] = 0;
+        }
+
+        // An empty limit, near above far.
+        for (size_t i = 0; i < Width; ++i)
+            rows[RP_NEAR][i] = 1;
+    }
+
+    template <size_t Width>
+    void TRayPacket<Width>::set(const size_t lane, const Ray& ray, const Vec2& limit)
+    {
+        const PreparedRay pr(ray);
+
+        rows[RP_OX][lane]   = pr.origin.x;
+        rows[RP_OY][lane]   = pr.origin.y;
+        rows[RP_OZ][lane]   = pr.origin.z;
+        rows[RP_DX][lane]   = pr.direction.x;
+        rows[RP_DY][lane]   = pr.direction.y;
+        rows[RP_DZ][lane]   = pr.direction.z;
+        rows[RP_IX][lane]   = pr.invDir.x;
+        rows[RP_IY][lane]   = pr.invDir.y;
+        rows[RP_IZ][lane]   = pr.invDir.z;
+        rows[RP_NEAR][lane] = limit.x;
+        rows[RP_FAR][lane]  = limit.y;
+    }
+
+    template <size_t Width>
+    Ray TRayPacket<Width>::ray(const size_t lane) const
+    {
+        return {
+            {rows[RP_OX][lane], rows[RP_OY][lane], rows[RP_OZ][lane]},
+            {rows[RP_DX][lane], rows[RP_DY][lane], rows[RP_DZ][lane]},
+        };
+    }
+
+    template <size_t Width>
+    uint32_t TRayPacket<Width>::hit(Real* r0, Real* r1, const Box3d& box) const
+    {
+        return Dispatch::kernels().rayPacketBox(r0, r1, rows[0], Width, box.bMin, box.bMax);
+    }
+
+    template <size_t Width>
+    uint32_t TRayPacket<Width>::hit(const Box3d& box) const
+    {
+        return Dispatch::kernels().rayPacketBox(nullptr, nullptr, rows[0], Width, box.bMin, box.bMax);
+    }
+
+    template <size_t Width>
+    uint32_t TRayPacket<Width>::hit(Real* distance, const Sphere& sphere) const
+    {
+        return Dispatch::kernels().rayPacketSphere(distance, rows[0], Width, sphere.center.ptr(), sphere.radius);
+    }
+
+    template <size_t Width>
+    uint32_t TRayPacket<Width>::hit(const Sphere& sphere) const
+    {
+        return Dispatch::kernels().rayPacketSphere(nullptr, rows[0], Width, sphere.center.ptr(), sphere.radius);
+    }
+
+    template class TRayPacket<4>;
+    template class TRayPacket<8>;
+    template class TRayPacket<16>;
+
+}  // namespace Rt2::Math
@@ -0,0 +1,79 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstdint>
+#include "Math/Box3d.h"
+#include "Math/Kernels/Kernels.h"
+#include "Math/Ray.h"
+#include "Math/Sphere.h"
+
+namespace Rt2::Math
+{
+    // Width rays in structure of arrays form, tested against one box or
+    // sphere at a time. Each lane carries its own [near, far] limit,
+    // the limit argument of the single ray tests.
+    //
+    // The hit methods return a mask with bit i set when lane i hits,
+    // and give the same answers as Box3d::hit with a PreparedRay and
+    // Sphere::hit with the lane's ray. Lanes that were never set hold
+    // an empty limit and never hit.
+    template <size_t Width>
+    class TRayPacket
+    {
+    public:
+        static_assert(Width == 4 || Width == 8 || Width == 16);
+
+        static constexpr size_t   Size = Width;
+        static constexpr uint32_t All  = (uint32_t)((1ull << Width) - 1);
+
+        // See RayPacketRow.
+        alignas(64) Real rows[RP_MAX][Width];
+
+    public:
+        TRayPacket();
+
+        // Makes every lane miss.
+        void clear();
+
+        void set(size_t lane, const Ray& ray, const Vec2& limit);
+
+        Ray ray(size_t lane) const;
+
+        // The entry and exit distances of the hit lanes go to r0 and r1,
+        // which hold Width scalars.
+        uint32_t hit(Real* r0, Real* r1, const Box3d& box) const;
+
+        uint32_t hit(const Box3d& box) const;
+
+        // The hit distance of the hit lanes goes to distance, which
+        // holds Width scalars.
+        uint32_t hit(Real* distance, const Sphere& sphere) const;
+
+        uint32_t hit(const Sphere& sphere) const;
+    };
+
+    using RayPacket4  = TRayPacket<4>;
+    using RayPacket8  = TRayPacket<8>;
+    using RayPacket16 = TRayPacket<16>;
+
+}  // namespace Rt2::Math
@@ -52,4 +52,32 @@ namespace Rt2::Math
     constexpr Real One255    = One / Real(255.0);
     constexpr Real One256    = One / Real(256.0);
 
+    template <typename T>
+    struct Limits;
+
+    template <>
+    struct Limits<float>
+    {
+        static constexpr float Epsilon  = FLT_EPSILON;
+        static constexpr float Infinity = FLT_MAX;
+    };
+
+    template <>
+    struct Limits<double>
+    {
+        static constexpr double Epsilon  = DBL_EPSILON;
+        static constexpr double Infinity = DBL_MAX;
+    };
+
+    template <typename T>
+    struct NoDeduceT
+    {
+        using Type = T;
+    };
+
+    // Wraps a parameter type so that it does not take part in template
+    // argument deduction.
+    template <typename T>
+    using NoDeduce = typename NoDeduceT<T>::Type;
+
 }  // namespace Rt2::Math
@@ -0,0 +1,1178 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include "Math/Scalar.h"
+
+// Selects the widest register file the current translation unit is
+// compiled for. Every type and function declared here lives in an inline
+// namespace named after that selection, and after each option below
+// that changes an inline body, so that translation units built with
+// different instruction sets never share (and never link against) each
+// other's inline definitions.
+#if defined(__AVX512F__)
+    #define Math_SIMD_AVX512
+    #define Math_SIMD_BASE Avx512
+#elif defined(__AVX__)
+    #define Math_SIMD_AVX
+    #define Math_SIMD_BASE Avx
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define Math_SIMD_SSE2
+    #define Math_SIMD_BASE Sse2
+#else
+    #define Math_SIMD_SCALAR
+    #define Math_SIMD_BASE Generic
+#endif
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+    #define Math_SIMD_SSE41
+#endif
+
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+    #define Math_SIMD_FMA
+#endif
+
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+    #define Math_SIMD_F16C
+#endif
+
+#if defined(Math_SIMD_AVX512) && defined(__AVX512DQ__)
+    #define Math_SIMD_AVX512DQ
+#endif
+
+// AVX implies SSE 4.1, so only SSE2 builds name it.
+#if defined(Math_SIMD_SSE2) && defined(Math_SIMD_SSE41)
+    #define Math_SIMD_TAG_SSE41 Sse41
+#else
+    #define Math_SIMD_TAG_SSE41
+#endif
+#ifdef Math_SIMD_FMA
+    #define Math_SIMD_TAG_FMA Fma
+#else
+    #define Math_SIMD_TAG_FMA
+#endif
+#ifdef Math_SIMD_F16C
+    #define Math_SIMD_TAG_F16C F16c
+#else
+    #define Math_SIMD_TAG_F16C
+#endif
+#ifdef Math_SIMD_AVX512DQ
+    #define Math_SIMD_TAG_AVX512DQ Dq
+#else
+    #define Math_SIMD_TAG_AVX512DQ
+#endif
+
+#define Math_SIMD_JOIN_(a, b, c, d, e) a##b##c##d##e
+#define Math_SIMD_JOIN(a, b, c, d, e) Math_SIMD_JOIN_(a, b, c, d, e)
+#define Math_SIMD_NS Math_SIMD_JOIN(Math_SIMD_BASE, Math_SIMD_TAG_SSE41, Math_SIMD_TAG_FMA, Math_SIMD_TAG_F16C, Math_SIMD_TAG_AVX512DQ)
+
+#ifndef Math_SIMD_SCALAR
+    #include <immintrin.h>
+#endif
+
+namespace Rt2::Math::Simd
+{
+    inline namespace Math_SIMD_NS
+    {
+#if defined(Math_SIMD_AVX512)
+    #ifdef Math_USE_DOUBLE
+        using Native     = __m512d;
+        using NativeMask = __mmask8;
+        constexpr int Lanes = 8;
+        #define Math_SIMD_OP(op) _mm512_##op##_pd
+        #define Math_SIMD_CMP _mm512_cmp_pd_mask
+        #define Math_SIMD_AND _mm512_and_pd
+        #define Math_SIMD_OR _mm512_or_pd
+        #define Math_SIMD_XOR _mm512_xor_pd
+    #else
+        using Native     = __m512;
+        using NativeMask = __mmask16;
+        constexpr int Lanes = 16;
+        #define Math_SIMD_OP(op) _mm512_##op##_ps
+        #define Math_SIMD_CMP _mm512_cmp_ps_mask
+        #define Math_SIMD_AND _mm512_and_ps
+        #define Math_SIMD_OR _mm512_or_ps
+        #define Math_SIMD_XOR _mm512_xor_ps
+    #endif
+#elif defined(Math_SIMD_AVX)
+    #ifdef Math_USE_DOUBLE
+        using Native     = __m256d;
+        using NativeMask = __m256d;
+        constexpr int Lanes = 4;
+        #define Math_SIMD_OP(op) _mm256_##op##_pd
+        #define Math_SIMD_AND _mm256_and_pd
+        #define Math_SIMD_OR _mm256_or_pd
+        #define Math_SIMD_XOR _mm256_xor_pd
+    #else
+        using Native     = __m256;
+        using NativeMask = __m256;
+        constexpr int Lanes = 8;
+        #define Math_SIMD_OP(op) _mm256_##op##_ps
+        #define Math_SIMD_AND _mm256_and_ps
+        #define Math_SIMD_OR _mm256_or_ps
+        #define Math_SIMD_XOR _mm256_xor_ps
+    #endif
+#elif defined(Math_SIMD_SSE2)
+    #ifdef Math_USE_DOUBLE
+        using Native     = __m128d;
+        using NativeMask = __m128d;
+        constexpr int Lanes = 2;
+        #define Math_SIMD_OP(op) _mm_##op##_pd
+        #define Math_SIMD_AND _mm_and_pd
+        #define Math_SIMD_OR _mm_or_pd
+        #define Math_SIMD_XOR _mm_xor_pd
+    #else
+        using Native     = __m128;
+        using NativeMask = __m128;
+        constexpr int Lanes = 4;
+        #define Math_SIMD_OP(op) _mm_##op##_ps
+        #define Math_SIMD_AND _mm_and_ps
+        #define Math_SIMD_OR _mm_or_ps
+        #define Math_SIMD_XOR _mm_xor_ps
+    #endif
+#else
+        using Native     = Real;
+        using NativeMask = bool;
+        constexpr int Lanes = 1;
+#endif
+
+        struct Pack
+        {
+            Native v;
+        };
+
+        struct Mask
+        {
+            NativeMask m;
+        };
+
+#ifndef Math_SIMD_SCALAR
+
+        inline Pack splat(const Real v)
+        {
+            return {Math_SIMD_OP(set1)(v)};
+        }
+
+        inline Pack zero()
+        {
+            return {Math_SIMD_OP(setzero)()};
+        }
+
+        inline Pack load(const Real* p)
+        {
+            return {Math_SIMD_OP(loadu)(p)};
+        }
+
+        inline void store(Real* p, const Pack& a)
+        {
+            Math_SIMD_OP(storeu)(p, a.v);
+        }
+
+        inline Pack operator+(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(add)(a.v, b.v)};
+        }
+
+        inline Pack operator-(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(sub)(a.v, b.v)};
+        }
+
+        inline Pack operator*(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(mul)(a.v, b.v)};
+        }
+
+        inline Pack operator/(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(div)(a.v, b.v)};
+        }
+
+        inline Pack min(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(min)(a.v, b.v)};
+        }
+
+        inline Pack max(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(max)(a.v, b.v)};
+        }
+
+        inline Pack sqrt(const Pack& a)
+        {
+            return {Math_SIMD_OP(sqrt)(a.v)};
+        }
+
+        // a * b + c
+        inline Pack madd(const Pack& a, const Pack& b, const Pack& c)
+        {
+    #ifdef Math_SIMD_FMA
+            return {Math_SIMD_OP(fmadd)(a.v, b.v, c.v)};
+    #else
+            return {Math_SIMD_OP(add)(Math_SIMD_OP(mul)(a.v, b.v), c.v)};
+    #endif
+        }
+
+        // c - a * b
+        inline Pack nmadd(const Pack& a, const Pack& b, const Pack& c)
+        {
+    #ifdef Math_SIMD_FMA
+            return {Math_SIMD_OP(fnmadd)(a.v, b.v, c.v)};
+    #else
+            return {Math_SIMD_OP(sub)(c.v, Math_SIMD_OP(mul)(a.v, b.v))};
+    #endif
+        }
+
+        inline Pack abs(const Pack& a)
+        {
+    #if defined(Math_SIMD_AVX512) && !defined(Math_SIMD_AVX512DQ)
+            return {Math_SIMD_OP(max)(a.v, Math_SIMD_OP(sub)(Math_SIMD_OP(setzero)(), a.v))};
+    #else
+            return {Math_SIMD_OP(andnot)(Math_SIMD_OP(set1)(Real(-0.0)), a.v)};
+    #endif
+        }
+
+        inline Pack operator-(const Pack& a)
+        {
+            return {Math_SIMD_OP(sub)(Math_SIMD_OP(setzero)(), a.v)};
+        }
+
+    #if defined(Math_SIMD_AVX512)
+        inline Mask operator<(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_CMP(a.v, b.v, _CMP_LT_OQ)};
+        }
+
+        inline Mask operator<=(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_CMP(a.v, b.v, _CMP_LE_OQ)};
+        }
+
+        inline Mask operator>(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_CMP(a.v, b.v, _CMP_GT_OQ)};
+        }
+
+        inline Mask operator>=(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_CMP(a.v, b.v, _CMP_GE_OQ)};
+        }
+
+        inline Mask operator&(const Mask& a, const Mask& b)
+        {
+            return {NativeMask(a.m & b.m)};
+        }
+
+        inline Mask operator|(const Mask& a, const Mask& b)
+        {
+            return {NativeMask(a.m | b.m)};
+        }
+
+        inline Mask operator~(const Mask& a)
+        {
+            return {NativeMask(~a.m)};
+        }
+
+        // Per lane: m ? a : b
+        inline Pack select(const Mask& m, const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(mask_blend)(m.m, b.v, a.v)};
+        }
+
+        inline unsigned bits(const Mask& m)
+        {
+            return (unsigned)m.m;
+        }
+    #else
+        #if defined(Math_SIMD_AVX)
+        inline Mask operator<(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(cmp)(a.v, b.v, _CMP_LT_OQ)};
+        }
+
+        inline Mask operator<=(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(cmp)(a.v, b.v, _CMP_LE_OQ)};
+        }
+
+        inline Mask operator>(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(cmp)(a.v, b.v, _CMP_GT_OQ)};
+        }
+
+        inline Mask operator>=(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(cmp)(a.v, b.v, _CMP_GE_OQ)};
+        }
+        #else
+        inline Mask operator<(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(cmplt)(a.v, b.v)};
+        }
+
+        inline Mask operator<=(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(cmple)(a.v, b.v)};
+        }
+
+        inline Mask operator>(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(cmpgt)(a.v, b.v)};
+        }
+
+        inline Mask operator>=(const Pack& a, const Pack& b)
+        {
+            return {Math_SIMD_OP(cmpge)(a.v, b.v)};
+        }
+        #endif
+
+        inline Mask operator&(const Mask& a, const Mask& b)
+        {
+            return {Math_SIMD_AND(a.m, b.m)};
+        }
+
+        inline Mask operator|(const Mask& a, const Mask& b)
+        {
+            return {Math_SIMD_OR(a.m, b.m)};
+        }
+
+        inline Mask operator~(const Mask& a)
+        {
+            const Pack z = zero();
+            return {Math_SIMD_XOR(a.m, (z <= z).m)};
+        }
+
+        // Per lane: m ? a : b
+        inline Pack select(const Mask& m, const Pack& a, const Pack& b)
+        {
+        #if defined(Math_SIMD_SSE41)
+            return {Math_SIMD_OP(blendv)(b.v, a.v, m.m)};
+        #else
+            return {Math_SIMD_OR(Math_SIMD_AND(m.m, a.v),
+                                     Math_SIMD_OP(andnot)(m.m, b.v))};
+        #endif
+        }
+
+        inline unsigned bits(const Mask& m)
+        {
+            return (unsigned)Math_SIMD_OP(movemask)(m.m);
+        }
+    #endif
+
+#else
+
+        inline Pack splat(const Real v)
+        {
+            return {v};
+        }
+
+        inline Pack zero()
+        {
+            return {Real(0)};
+        }
+
+        inline Pack load(const Real* p)
+        {
+            return {*p};
+        }
+
+        inline void store(Real* p, const Pack& a)
+        {
+            *p = a.v;
+        }
+
+        inline Pack operator+(const Pack& a, const Pack& b)
+        {
+            return {a.v + b.v};
+        }
+
+        inline Pack operator-(const Pack& a, const Pack& b)
+        {
+            return {a.v - b.v};
+        }
+
+        inline Pack operator*(const Pack& a, const Pack& b)
+        {
+            return {a.v * b.v};
+        }
+
+        inline Pack operator/(const Pack& a, const Pack& b)
+        {
+            return {a.v / b.v};
+        }
+
+        inline Pack min(const Pack& a, const Pack& b)
+        {
+            return {a.v < b.v ? a.v : b.v};
+        }
+
+        inline Pack max(const Pack& a, const Pack& b)
+        {
+            return {a.v > b.v ? a.v : b.v};
+        }
+
+        inline Pack sqrt(const Pack& a)
+        {
+            return {std::sqrt(a.v)};
+        }
+
+        inline Pack madd(const Pack& a, const Pack& b, const Pack& c)
+        {
+            return {a.v * b.v + c.v};
+        }
+
+        inline Pack nmadd(const Pack& a, const Pack& b, const Pack& c)
+        {
+            return {c.v - a.v * b.v};
+        }
+
+        inline Pack abs(const Pack& a)
+        {
+            return {a.v < Real(0) ? -a.v : a.v};
+        }
+
+        inline Pack operator-(const Pack& a)
+        {
+            return {-a.v};
+        }
+
+        inline Mask operator<(const Pack& a, const Pack& b)
+        {
+            return {a.v < b.v};
+        }
+
+        inline Mask operator<=(const Pack& a, const Pack& b)
+        {
+            return {a.v <= b.v};
+        }
+
+        inline Mask operator>(const Pack& a, const Pack& b)
+        {
+            return {a.v > b.v};
+        }
+
+        inline Mask operator>=(const Pack& a, const Pack& b)
+        {
+            return {a.v >= b.v};
+        }
+
+        inline Mask operator&(const Mask& a, const Mask& b)
+        {
+            return {a.m && b.m};
+        }
+
+        inline Mask operator|(const Mask& a, const Mask& b)
+        {
+            return {a.m || b.m};
+        }
+
+        inline Mask operator~(const Mask& a)
+        {
+            return {!a.m};
+        }
+
+        inline Pack select(const Mask& m, const Pack& a, const Pack& b)
+        {
+            return m.m ? a : b;
+        }
+
+        inline unsigned bits(const Mask& m)
+        {
+            return m.m ? 1u : 0u;
+        }
+#endif
+
+        inline Pack operator+=(Pack& a, const Pack& b)
+        {
+            return a = a + b;
+        }
+
+        inline Pack operator-=(Pack& a, const Pack& b)
+        {
+            return a = a - b;
+        }
+
+        inline Pack operator*=(Pack& a, const Pack& b)
+        {
+            return a = a * b;
+        }
+
+        inline bool any(const Mask& m)
+        {
+            return bits(m) != 0;
+        }
+
+        inline bool none(const Mask& m)
+        {
+            return bits(m) == 0;
+        }
+
+        inline Pack rsqrtExact(const Pack& x)
+        {
+            return splat(Real(1)) / sqrt(x);
+        }
+
+        // One Newton-Raphson refinement of an estimate y of 1 / sqrt(x).
+        inline Pack rsqrtStep(const Pack& x, const Pack& y)
+        {
+            return y * nmadd(x * y, y * splat(Real(0.5)), splat(Real(1.5)));
+        }
+
+        // Lane wise counterpart of Math::rsqrtFast. The float estimate
+        // (12 bits, or 14 with AVX-512) takes one refinement step and
+        // has a maximum relative error of 2.8e-7. The double estimate is
+        // only available with AVX-512 and takes two steps, for a maximum
+        // relative error of 3.3e-16. Other configurations use rsqrtExact.
+        // Lanes must be greater than zero.
+        inline Pack rsqrtFast(const Pack& x)
+        {
+#if defined(Math_SIMD_AVX512)
+    #ifdef Math_USE_DOUBLE
+            return rsqrtStep(x, rsqrtStep(x, {Math_SIMD_OP(rsqrt14)(x.v)}));
+    #else
+            return rsqrtStep(x, {Math_SIMD_OP(rsqrt14)(x.v)});
+    #endif
+#elif !defined(Math_SIMD_SCALAR) && !defined(Math_USE_DOUBLE)
+            return rsqrtStep(x, {Math_SIMD_OP(rsqrt)(x.v)});
+#else
+            return rsqrtExact(x);
+#endif
+        }
+
+        inline Pack rsqrt(const Pack& x)
+        {
+#ifdef Math_USE_FAST_RSQRT
+            return rsqrtFast(x);
+#else
+            return rsqrtExact(x);
+#endif
+        }
+
+        // Truncates each lane to an integer, storing Lanes values.
+        inline void toInt(int32_t* p, const Pack& a)
+        {
+#if defined(Math_SIMD_AVX512)
+    #ifdef Math_USE_DOUBLE
+            _mm256_storeu_si256((__m256i*)p, _mm512_cvttpd_epi32(a.v));
+    #else
+            _mm512_storeu_si512(p, _mm512_cvttps_epi32(a.v));
+    #endif
+#elif defined(Math_SIMD_AVX)
+    #ifdef Math_USE_DOUBLE
+            _mm_storeu_si128((__m128i*)p, _mm256_cvttpd_epi32(a.v));
+    #else
+            _mm256_storeu_si256((__m256i*)p, _mm256_cvttps_epi32(a.v));
+    #endif
+#elif defined(Math_SIMD_SSE2)
+    #ifdef Math_USE_DOUBLE
+            _mm_storel_epi64((__m128i*)p, _mm_cvttpd_epi32(a.v));
+    #else
+            _mm_storeu_si128((__m128i*)p, _mm_cvttps_epi32(a.v));
+    #endif
+#else
+            *p = (int32_t)a.v;
+#endif
+        }
+
+        // Converts Lanes integers to a pack.
+        inline Pack fromInt(const int32_t* p)
+        {
+#if defined(Math_SIMD_AVX512)
+    #ifdef Math_USE_DOUBLE
+            return {_mm512_cvtepi32_pd(_mm256_loadu_si256((const __m256i*)p))};
+    #else
+            return {_mm512_cvtepi32_ps(_mm512_loadu_si512(p))};
+    #endif
+#elif defined(Math_SIMD_AVX)
+    #ifdef Math_USE_DOUBLE
+            return {_mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)p))};
+    #else
+            return {_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)p))};
+    #endif
+#elif defined(Math_SIMD_SSE2)
+    #ifdef Math_USE_DOUBLE
+            return {_mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*)p))};
+    #else
+            return {_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)p))};
+    #endif
+#else
+            return {(Real)*p};
+#endif
+        }
+
+        // Number of elements in [0, n) that can be visited a full pack at a time.
+        inline size_t packed(const size_t n)
+        {
+            return n - n % Lanes;
+        }
+
+        // Pack access for the body of stream.
+        struct Full
+        {
+            static Pack ld(const Real* p)
+            {
+                return load(p);
+            }
+
+            static void st(Real* p, const Pack& a)
+            {
+                store(p, a);
+            }
+        };
+
+        // Access to the first n < Lanes elements of a pack. Lanes past n
+        // load as zero and are discarded on store.
+        struct Partial
+        {
+            size_t n;
+
+            Pack ld(const Real* p) const
+            {
+                Real t[Lanes]{};
+                for (size_t i = 0; i < n; ++i)
+                    t[i] = p[i];
+                return load(t);
+            }
+
+            void st(Real* p, const Pack& a) const
+            {
+                Real t[Lanes];
+                store(t, a);
+                for (size_t i = 0; i < n; ++i)
+                    p[i] = t[i];
+            }
+        };
+
+        // Calls body(i, io) for each pack starting at i in [0, n), where io
+        // is Full, or Partial for the remainder, so a kernel is written once
+        // in terms of io.ld and io.st.
+        template <typename Body>
+        void stream(const size_t n, Body&& body)
+        {
+            size_t i = 0;
+            for (; i + Lanes <= n; i += Lanes)
+                body(i, Full{});
+            if (i < n)
+                body(i, Partial{n - i});
+        }
+
+        // Rounds n doubles to the nearest float.
+        inline void narrow(float* d, const double* s, const size_t n)
+        {
+            size_t i = 0;
+#if defined(Math_SIMD_AVX512)
+            for (; i + 8 <= n; i += 8)
+                _mm256_storeu_ps(d + i, _mm512_cvtpd_ps(_mm512_loadu_pd(s + i)));
+#elif defined(Math_SIMD_AVX)
+            for (; i + 4 <= n; i += 4)
+                _mm_storeu_ps(d + i, _mm256_cvtpd_ps(_mm256_loadu_pd(s + i)));
+#elif defined(Math_SIMD_SSE2)
+            for (; i + 2 <= n; i += 2)
+                _mm_storel_pi((__m64*)(d + i), _mm_cvtpd_ps(_mm_loadu_pd(s + i)));
+#endif
+            for (; i < n; ++i)
+                d[i] = float(s[i]);
+        }
+
+        // Widens n floats to doubles. This is exact.
+        inline void widen(double* d, const float* s, const size_t n)
+        {
+            size_t i = 0;
+#if defined(Math_SIMD_AVX512)
+            for (; i + 8 <= n; i += 8)
+                _mm512_storeu_pd(d + i, _mm512_cvtps_pd(_mm256_loadu_ps(s + i)));
+#elif defined(Math_SIMD_AVX)
+            for (; i + 4 <= n; i += 4)
+                _mm256_storeu_pd(d + i, _mm256_cvtps_pd(_mm_loadu_ps(s + i)));
+#elif defined(Math_SIMD_SSE2)
+            for (; i + 2 <= n; i += 2)
+                _mm_storeu_pd(d + i, _mm_cvtps_pd(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(s + i))));
+#endif
+            for (; i < n; ++i)
+                d[i] = double(s[i]);
+        }
+
+        // Rounds v to the nearest IEEE half, ties to even. Magnitudes
+        // past the half range become infinity and NaN stays NaN.
+        inline uint16_t toHalf(const float v)
+        {
+#if defined(Math_SIMD_F16C)
+            return (uint16_t)_cvtss_sh(v, _MM_FROUND_TO_NEAREST_INT);
+#else
+            uint32_t u;
+            std::memcpy(&u, &v, sizeof u);
+
+            const uint32_t sign = u >> 16 & 0x8000;
+            u &= 0x7FFFFFFF;
+
+            uint32_t h;
+            if (u >= 0x47800000)
+                h = u > 0x7F800000 ? 0x7E00 | (u >> 13 & 0x3FF) : 0x7C00;
+            else if (u < 0x38800000)
+            {
+                // Below 2^-14 the result is subnormal. Adding 0.5 lines the
+                // half mantissa up with the low float mantissa bits, and
+                // the addition itself does the rounding.
+                float f;
+                std::memcpy(&f, &u, sizeof f);
+                f += 0.5f;
+                std::memcpy(&h, &f, sizeof h);
+                h -= 0x3F000000;
+            }
+            else
+            {
+                // Rebias the exponent from 127 to 15 and round to even.
+                h = (u + 0xC8000FFF + (u >> 13 & 1)) >> 13;
+            }
+            return (uint16_t)(sign | h);
+#endif
+        }
+
+        // Widens a half to float. This is exact.
+        inline float fromHalf(const uint16_t v)
+        {
+#if defined(Math_SIMD_F16C)
+            return _cvtsh_ss(v);
+#else
+            uint32_t       u = uint32_t(v & 0x7FFF) << 13;
+            const uint32_t e = u & 0x0F800000;
+
+            u += 0x38000000;
+            if (e == 0x0F800000)
+            {
+                // Infinity or NaN, NaNs are quieted as by the hardware.
+                u += 0x38000000;
+                if (u & 0x007FFFFF)
+                    u |= 0x00400000;
+            }
+            else if (e == 0)
+            {
+                // Subnormal, renormalize by subtracting the implicit 2^-14.
+                float f;
+                u += 0x00800000;
+                std::memcpy(&f, &u, sizeof f);
+                f -= 6.103515625e-05f;
+                std::memcpy(&u, &f, sizeof u);
+            }
+            u |= uint32_t(v & 0x8000) << 16;
+
+            float r;
+            std::memcpy(&r, &u, sizeof r);
+            return r;
+#endif
+        }
+
+        // Converts n values to halves. Doubles are rounded to float
+        // first, so every variant produces the same bits.
+        inline void toHalf(uint16_t* d, const Real* s, const size_t n)
+        {
+            size_t i = 0;
+#if defined(Math_SIMD_F16C)
+    #if defined(Math_SIMD_AVX512)
+        #ifdef Math_USE_DOUBLE
+            for (; i + 8 <= n; i += 8)
+                _mm_storeu_si128((__m128i*)(d + i), _mm256_cvtps_ph(_mm512_cvtpd_ps(_mm512_loadu_pd(s + i)), _MM_FROUND_TO_NEAREST_INT));
+        #else
+            for (; i + 16 <= n; i += 16)
+                _mm256_storeu_si256((__m256i*)(d + i), _mm512_cvtps_ph(_mm512_loadu_ps(s + i), _MM_FROUND_TO_NEAREST_INT));
+        #endif
+    #else
+        #ifdef Math_USE_DOUBLE
+            for (; i + 4 <= n; i += 4)
+                _mm_storel_epi64((__m128i*)(d + i), _mm_cvtps_ph(_mm256_cvtpd_ps(_mm256_loadu_pd(s + i)), _MM_FROUND_TO_NEAREST_INT));
+        #else
+            for (; i + 8 <= n; i += 8)
+                _mm_storeu_si128((__m128i*)(d + i), _mm256_cvtps_ph(_mm256_loadu_ps(s + i), _MM_FROUND_TO_NEAREST_INT));
+        #endif
+    #endif
+#endif
+            for (; i < n; ++i)
+                d[i] = toHalf(float(s[i]));
+        }
+
+        // Converts n halves back to Real.
+        inline void fromHalf(Real* d, const uint16_t* s, const size_t n)
+        {
+            size_t i = 0;
+#if defined(Math_SIMD_F16C)
+    #if defined(Math_SIMD_AVX512)
+        #ifdef Math_USE_DOUBLE
+            for (; i + 8 <= n; i += 8)
+                _mm512_storeu_pd(d + i, _mm512_cvtps_pd(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(s + i)))));
+        #else
+            for (; i + 16 <= n; i += 16)
+                _mm512_storeu_ps(d + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(s + i))));
+        #endif
+    #else
+        #ifdef Math_USE_DOUBLE
+            for (; i + 4 <= n; i += 4)
+                _mm256_storeu_pd(d + i, _mm256_cvtps_pd(_mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(s + i)))));
+        #else
+            for (; i + 8 <= n; i += 8)
+                _mm256_storeu_ps(d + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(s + i))));
+        #endif
+    #endif
+#endif
+            for (; i < n; ++i)
+                d[i] = Real(fromHalf(s[i]));
+        }
+
+        // Quad holds exactly four Real lanes regardless of the
+        // register width selected above. It backs the Vec4 storage mode.
+#if !defined(Math_SIMD_SCALAR)
+    #define Math_SIMD_QUAD
+    #if !defined(Math_USE_DOUBLE)
+        constexpr size_t QuadAlignment = 16;
+
+        struct Quad
+        {
+            __m128 v;
+        };
+
+        inline Quad loadQuad(const Real* p)
+        {
+            return {_mm_load_ps(p)};
+        }
+
+        inline void storeQuad(Real* p, const Quad& a)
+        {
+            _mm_store_ps(p, a.v);
+        }
+
+        inline Quad loadQuadU(const Real* p)
+        {
+            return {_mm_loadu_ps(p)};
+        }
+
+        inline void storeQuadU(Real* p, const Quad& a)
+        {
+            _mm_storeu_ps(p, a.v);
+        }
+
+        inline Quad splatQuad(const Real v)
+        {
+            return {_mm_set1_ps(v)};
+        }
+
+        inline Quad operator+(const Quad& a, const Quad& b)
+        {
+            return {_mm_add_ps(a.v, b.v)};
+        }
+
+        inline Quad operator-(const Quad& a, const Quad& b)
+        {
+            return {_mm_sub_ps(a.v, b.v)};
+        }
+
+        inline Quad operator*(const Quad& a, const Quad& b)
+        {
+            return {_mm_mul_ps(a.v, b.v)};
+        }
+
+        // a * b + c
+        inline Quad madd(const Quad& a, const Quad& b, const Quad& c)
+        {
+        #ifdef Math_SIMD_FMA
+            return {_mm_fmadd_ps(a.v, b.v, c.v)};
+        #else
+            return {_mm_add_ps(_mm_mul_ps(a.v, b.v), c.v)};
+        #endif
+        }
+
+        inline Quad min(const Quad& a, const Quad& b)
+        {
+            return {_mm_min_ps(a.v, b.v)};
+        }
+
+        inline Quad max(const Quad& a, const Quad& b)
+        {
+            return {_mm_max_ps(a.v, b.v)};
+        }
+
+        inline Quad abs(const Quad& a)
+        {
+            return {_mm_andnot_ps(_mm_set1_ps(-0.f), a.v)};
+        }
+
+        // Per lane reciprocal with the same zero tolerance as Math::reciprocal.
+        inline Quad reciprocal(const Quad& a)
+        {
+            const __m128 ep = _mm_set1_ps(Epsilon);
+            const __m128 m  = _mm_cmplt_ps(abs(a).v, ep);
+            const __m128 r  = _mm_div_ps(_mm_set1_ps(1.f), a.v);
+            return {_mm_or_ps(_mm_and_ps(m, ep), _mm_andnot_ps(m, r))};
+        }
+
+        inline Real dot(const Quad& a, const Quad& b)
+        {
+        #if defined(Math_SIMD_SSE41)
+            return _mm_cvtss_f32(_mm_dp_ps(a.v, b.v, 0xF1));
+        #else
+            const __m128 m = _mm_mul_ps(a.v, b.v);
+            const __m128 h = _mm_add_ps(m, _mm_movehl_ps(m, m));
+            return _mm_cvtss_f32(_mm_add_ss(h, _mm_shuffle_ps(h, h, 1)));
+        #endif
+        }
+    #elif defined(Math_SIMD_AVX) || defined(Math_SIMD_AVX512)
+        constexpr size_t QuadAlignment = 32;
+
+        struct Quad
+        {
+            __m256d v;
+        };
+
+        inline Quad loadQuad(const Real* p)
+        {
+            return {_mm256_load_pd(p)};
+        }
+
+        inline void storeQuad(Real* p, const Quad& a)
+        {
+            _mm256_store_pd(p, a.v);
+        }
+
+        inline Quad loadQuadU(const Real* p)
+        {
+            return {_mm256_loadu_pd(p)};
+        }
+
+        inline void storeQuadU(Real* p, const Quad& a)
+        {
+            _mm256_storeu_pd(p, a.v);
+        }
+
+        inline Quad splatQuad(const Real v)
+        {
+            return {_mm256_set1_pd(v)};
+        }
+
+        inline Quad operator+(const Quad& a, const Quad& b)
+        {
+            return {_mm256_add_pd(a.v, b.v)};
+        }
+
+        inline Quad operator-(const Quad& a, const Quad& b)
+        {
+            return {_mm256_sub_pd(a.v, b.v)};
+        }
+
+        inline Quad operator*(const Quad& a, const Quad& b)
+        {
+            return {_mm256_mul_pd(a.v, b.v)};
+        }
+
+        inline Quad madd(const Quad& a, const Quad& b, const Quad& c)
+        {
+        #ifdef Math_SIMD_FMA
+            return {_mm256_fmadd_pd(a.v, b.v, c.v)};
+        #else
+            return {_mm256_add_pd(_mm256_mul_pd(a.v, b.v), c.v)};
+        #endif
+        }
+
+        inline Quad min(const Quad& a, const Quad& b)
+        {
+            return {_mm256_min_pd(a.v, b.v)};
+        }
+
+        inline Quad max(const Quad& a, const Quad& b)
+        {
+            return {_mm256_max_pd(a.v, b.v)};
+        }
+
+        inline Quad abs(const Quad& a)
+        {
+            return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)};
+        }
+
+        inline Quad reciprocal(const Quad& a)
+        {
+            const __m256d ep = _mm256_set1_pd(Epsilon);
+            const __m256d m  = _mm256_cmp_pd(abs(a).v, ep, _CMP_LT_OQ);
+            const __m256d r  = _mm256_div_pd(_mm256_set1_pd(1.0), a.v);
+            return {_mm256_blendv_pd(r, ep, m)};
+        }
+
+        inline Real dot(const Quad& a, const Quad& b)
+        {
+            const __m256d m = _mm256_mul_pd(a.v, b.v);
+            const __m128d h = _mm_add_pd(_mm256_castpd256_pd128(m), _mm256_extractf128_pd(m, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+        }
+    #else
+        constexpr size_t QuadAlignment = 16;
+
+        struct Quad
+        {
+            __m128d lo, hi;
+        };
+
+        inline Quad loadQuad(const Real* p)
+        {
+            return {_mm_load_pd(p), _mm_load_pd(p + 2)};
+        }
+
+        inline void storeQuad(Real* p, const Quad& a)
+        {
+            _mm_store_pd(p, a.lo);
+            _mm_store_pd(p + 2, a.hi);
+        }
+
+        inline Quad loadQuadU(const Real* p)
+        {
+            return {_mm_loadu_pd(p), _mm_loadu_pd(p + 2)};
+        }
+
+        inline void storeQuadU(Real* p, const Quad& a)
+        {
+            _mm_storeu_pd(p, a.lo);
+            _mm_storeu_pd(p + 2, a.hi);
+        }
+
+        inline Quad splatQuad(const Real v)
+        {
+            return {_mm_set1_pd(v), _mm_set1_pd(v)};
+        }
+
+        inline Quad operator+(const Quad& a, const Quad& b)
+        {
+            return {_mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi)};
+        }
+
+        inline Quad operator-(const Quad& a, const Quad& b)
+        {
+            return {_mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi)};
+        }
+
+        inline Quad operator*(const Quad& a, const Quad& b)
+        {
+            return {_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi)};
+        }
+
+        inline Quad madd(const Quad& a, const Quad& b, const Quad& c)
+        {
+            return {_mm_add_pd(_mm_mul_pd(a.lo, b.lo), c.lo), _mm_add_pd(_mm_mul_pd(a.hi, b.hi), c.hi)};
+        }
+
+        inline Quad min(const Quad& a, const Quad& b)
+        {
+            return {_mm_min_pd(a.lo, b.lo), _mm_min_pd(a.hi, b.hi)};
+        }
+
+        inline Quad max(const Quad& a, const Quad& b)
+        {
+            return {_mm_max_pd(a.lo, b.lo), _mm_max_pd(a.hi, b.hi)};
+        }
+
+        inline Quad abs(const Quad& a)
+        {
+            const __m128d s = _mm_set1_pd(-0.0);
+            return {_mm_andnot_pd(s, a.lo), _mm_andnot_pd(s, a.hi)};
+        }
+
+        inline Quad reciprocal(const Quad& a)
+        {
+            const __m128d ep = _mm_set1_pd(Epsilon);
+            const __m128d on = _mm_set1_pd(1.0);
+            const Quad    ab = abs(a);
+
+            const __m128d ml = _mm_cmplt_pd(ab.lo, ep);
+            const __m128d mh = _mm_cmplt_pd(ab.hi, ep);
+            return {
+                _mm_or_pd(_mm_and_pd(ml, ep), _mm_andnot_pd(ml, _mm_div_pd(on, a.lo))),
+                _mm_or_pd(_mm_and_pd(mh, ep), _mm_andnot_pd(mh, _mm_div_pd(on, a.hi))),
+            };
+        }
+
+        inline Real dot(const Quad& a, const Quad& b)
+        {
+            const __m128d h = _mm_add_pd(_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi));
+            return _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+        }
+    #endif
+#endif
+
+        // d = a * b for row major 4x4 matrices. d may alias a or b.
+        inline void mul4x4(Real* d, const Real* a, const Real* b)
+        {
+#if defined(Math_SIMD_QUAD)
+            const Quad b0 = loadQuadU(b);
+            const Quad b1 = loadQuadU(b + 4);
+            const Quad b2 = loadQuadU(b + 8);
+            const Quad b3 = loadQuadU(b + 12);
+
+            for (int r = 0; r < 16; r += 4)
+            {
+                Quad v = splatQuad(a[r]) * b0;
+                v      = madd(splatQuad(a[r + 1]), b1, v);
+                v      = madd(splatQuad(a[r + 2]), b2, v);
+                v      = madd(splatQuad(a[r + 3]), b3, v);
+                storeQuadU(d + r, v);
+            }
+#else
+            Real t[16];
+            for (int r = 0; r < 16; r += 4)
+            {
+                for (int c = 0; c < 4; ++c)
+                    t[r + c] = a[r] * b[c] + a[r + 1] * b[4 + c] + a[r + 2] * b[8 + c] + a[r + 3] * b[12 + c];
+            }
+            for (int i = 0; i < 16; ++i)
+                d[i] = t[i];
+#endif
+        }
+
+        // d = a * b for the top three rows of 4x4 matrices whose bottom
+        // row is [0 0 0 1]. d may alias a or b.
+        inline void mul3x4(Real* d, const Real* a, const Real* b)
+        {
+#if defined(Math_SIMD_QUAD)
+            const Quad b0 = loadQuadU(b);
+            const Quad b1 = loadQuadU(b + 4);
+            const Quad b2 = loadQuadU(b + 8);
+
+            for (int r = 0; r < 12; r += 4)
+            {
+                const Real t = a[r + 3];
+
+                Quad v = splatQuad(a[r]) * b0;
+                v      = madd(splatQuad(a[r + 1]), b1, v);
+                v      = madd(splatQuad(a[r + 2]), b2, v);
+                storeQuadU(d + r, v);
+                d[r + 3] += t;
+            }
+#else
+            Real t[12];
+            for (int r = 0; r < 12; r += 4)
+            {
+                for (int c = 0; c < 4; ++c)
+                    t[r + c] = a[r] * b[c] + a[r + 1] * b[4 + c] + a[r + 2] * b[8 + c];
+                t[r + 3] += a[r + 3];
+            }
+            for (int i = 0; i < 12; ++i)
+                d[i] = t[i];
+#endif
+        }
+
+    }  // namespace Math_SIMD_NS
+}  // namespace Rt2::Math::Simd
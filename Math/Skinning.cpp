@@ -0,0 +1,167 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Skinning.h"
+#include "Math/Barrier.h"
+#include "Math/Dispatch.h"
+
+namespace Rt2::Math
+{
+    namespace
+    {
+        // Below this many vertices per thread, fewer threads are used.
+        constexpr size_t MinVerticesPerWorker = 1024;
+
+        // Calls fn(first, count) once per worker over disjoint ranges
+        // of [0, n).
+        template <typename Fn>
+        void split(const size_t n, unsigned workers, const Fn& fn)
+        {
+            if (workers > n / MinVerticesPerWorker)
+                workers = (unsigned)(n / MinVerticesPerWorker);
+            if (workers <= 1)
+            {
+                fn(0, n);
+                return;
+            }
+
+            // Range boundaries are rounded to 16 so that no two threads
+            // share a cache line of the output.
+            const auto first = [&](const size_t w)
+            {
+                return w == workers ? n : (n * w / workers) & ~size_t(15);
+            };
+
+            parallel(workers, [&](const unsigned w) { fn(first(w), first(w + 1) - first(w)); });
+        }
+
+        struct Streams
+        {
+            Vec3Out dp{};
+            Vec3Out dn{};
+            Vec3In  p{};
+            Vec3In  n{};
+
+            Streams offset(const size_t i) const
+            {
+                if (dn.x == nullptr)
+                    return {
+                        {dp.x + i, dp.y + i, dp.z + i},
+                        {},
+                        {p.x + i, p.y + i, p.z + i},
+                        {},
+                    };
+                return {
+                    {dp.x + i, dp.y + i, dp.z + i},
+                    {dn.x + i, dn.y + i, dn.z + i},
+                    {p.x + i, p.y + i, p.z + i},
+                    {n.x + i, n.y + i, n.z + i},
+                };
+            }
+        };
+
+        Streams prepare(Vec3Stream&       dPositions,
+                        Vec3Stream*       dNormals,
+                        const Vec3Stream& positions,
+                        const Vec3Stream* normals)
+        {
+            Streams s;
+
+            dPositions.resize(positions.size());
+            s.dp = {dPositions.x(), dPositions.y(), dPositions.z()};
+            s.p  = {positions.x(), positions.y(), positions.z()};
+
+            if (dNormals && normals)
+            {
+                dNormals->resize(positions.size());
+                s.dn = {dNormals->x(), dNormals->y(), dNormals->z()};
+                s.n  = {normals->x(), normals->y(), normals->z()};
+            }
+            return s;
+        }
+
+        void skinLinear(Vec3Stream&           dPositions,
+                        Vec3Stream*           dNormals,
+                        const Vec3Stream&     positions,
+                        const Vec3Stream*     normals,
+                        const SkinInfluences& influences,
+                        const Real*           palette,
+                        const size_t          stride,
+                        const unsigned        workers)
+        {
+            const Streams      s = prepare(dPositions, dNormals, positions, normals);
+            const KernelTable& k = Dispatch::kernels();
+
+            split(positions.size(),
+                  workers,
+                  [&](const size_t i, const size_t c)
+                  {
+                      const Streams r = s.offset(i);
+                      k.skinLinear(r.dp, r.dn, r.p, r.n, influences.joints + 4 * i, influences.weights + 4 * i, palette, stride, c);
+                  });
+        }
+    }  // namespace
+
+    void Skinning::linear(Vec3Stream&           dPositions,
+                          Vec3Stream*           dNormals,
+                          const Vec3Stream&     positions,
+                          const Vec3Stream*     normals,
+                          const SkinInfluences& influences,
+                          const Mat4*           palette,
+                          const unsigned        workers)
+    {
+        skinLinear(dPositions, dNormals, positions, normals, influences, palette->m[0], 16, workers);
+    }
+
+    void Skinning::linear(Vec3Stream&           dPositions,
+                          Vec3Stream*           dNormals,
+                          const Vec3Stream&     positions,
+                          const Vec3Stream*     normals,
+                          const SkinInfluences& influences,
+                          const Affine3*        palette,
+                          const unsigned        workers)
+    {
+        skinLinear(dPositions, dNormals, positions, normals, influences, palette->m[0], 12, workers);
+    }
+
+    void Skinning::dualQuat(Vec3Stream&           dPositions,
+                            Vec3Stream*           dNormals,
+                            const Vec3Stream&     positions,
+                            const Vec3Stream*     normals,
+                            const SkinInfluences& influences,
+                            const DualQuat*       palette,
+                            const unsigned        workers)
+    {
+        static_assert(sizeof(DualQuat) == 8 * sizeof(Real));
+
+        const Streams      s = prepare(dPositions, dNormals, positions, normals);
+        const KernelTable& k = Dispatch::kernels();
+
+        split(positions.size(),
+              workers,
+              [&](const size_t i, const size_t c)
+              {
+                  const Streams r = s.offset(i);
+                  k.skinDualQuat(r.dp, r.dn, r.p, r.n, influences.joints + 4 * i, influences.weights + 4 * i, &palette->real.w, c);
+              });
+    }
+
+}  // namespace Rt2::Math
@@ -0,0 +1,82 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstdint>
+#include "Math/Affine3.h"
+#include "Math/DualQuat.h"
+#include "Math/Mat4.h"
+#include "Math/Vec3Stream.h"
+
+namespace Rt2::Math
+{
+    // Per vertex joint influences, four to a vertex. Influence k of
+    // vertex i is joints[4 * i + k] with weights[4 * i + k]. Weights of
+    // a vertex are expected to sum to one, unused slots carry a zero
+    // weight and any valid joint.
+    struct SkinInfluences
+    {
+        const uint16_t* joints{nullptr};
+        const Real*     weights{nullptr};
+    };
+
+    // Batched vertex skinning against a joint palette.
+    //
+    // Each call writes positions.size() skinned positions to dPositions,
+    // and when both normal streams are given, the skinned normals to
+    // dNormals. The vertex range is split between the given number of
+    // threads, the caller included.
+    class Skinning
+    {
+    public:
+        // Linear blend skinning, the weighted sum of the joint matrices
+        // applied to each vertex. Normals use the 3x3 part of the sum
+        // and are renormalized.
+        static void linear(Vec3Stream&           dPositions,
+                           Vec3Stream*           dNormals,
+                           const Vec3Stream&     positions,
+                           const Vec3Stream*     normals,
+                           const SkinInfluences& influences,
+                           const Mat4*           palette,
+                           unsigned              workers = 1);
+
+        static void linear(Vec3Stream&           dPositions,
+                           Vec3Stream*           dNormals,
+                           const Vec3Stream&     positions,
+                           const Vec3Stream*     normals,
+                           const SkinInfluences& influences,
+                           const Affine3*        palette,
+                           unsigned              workers = 1);
+
+        // Dual quaternion skinning, the normalized weighted sum of the
+        // joint dual quaternions applied to each vertex. The palette
+        // must be free of scale.
+        static void dualQuat(Vec3Stream&           dPositions,
+                             Vec3Stream*           dNormals,
+                             const Vec3Stream&     positions,
+                             const Vec3Stream*     normals,
+                             const SkinInfluences& influences,
+                             const DualQuat*       palette,
+                             unsigned              workers = 1);
+    };
+
+}  // namespace Rt2::Math
@@ -49,8 +49,8 @@ namespace Rt2::Math
 
         const Real r = radius * radius;
         const Real c =
-            vec[0] * vec[0] - r +
-            vec[1] * vec[1] - r +
+            vec[0] * vec[0] +
+            vec[1] * vec[1] +
             vec[2] * vec[2] - r;
 
         Real d = b * b - a * c;
@@ -100,8 +100,8 @@ namespace Rt2::Math
         const Real r = radius * radius;
 
         const Real c =
-            vec[0] * vec[0] - r +
-            vec[1] * vec[1] - r +
+            vec[0] * vec[0] +
+            vec[1] * vec[1] +
             vec[2] * vec[2] - r;
 
         Real d = b * b - a * c;
@@ -0,0 +1,86 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Transform.h"
+#include <type_traits>
+#include "Math/Dispatch.h"
+
+namespace Rt2::Math
+{
+    template <typename T>
+    void Transform::apply(const TransformMode mode,
+                          const T*            m,
+                          T*                  d,
+                          const size_t        dStride,
+                          const T*            s,
+                          const size_t        sStride,
+                          const size_t        n)
+    {
+        if constexpr (std::is_same_v<T, Real>)
+        {
+            const KernelTable& k = Dispatch::kernels();
+            switch (mode)
+            {
+            case TM_POINT:
+                k.transformPoints(d, dStride, s, sStride, m, n);
+                break;
+            case TM_DIRECTION:
+                k.transformDirections(d, dStride, s, sStride, m, n);
+                break;
+            case TM_PROJECTIVE:
+                k.transformProjective(d, dStride, s, sStride, m, n);
+                break;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                const T* p = reinterpret_cast<const T*>(reinterpret_cast<const char*>(s) + i * sStride);
+                T*       r = reinterpret_cast<T*>(reinterpret_cast<char*>(d) + i * dStride);
+
+                const T h = mode == TM_DIRECTION ? T(0) : T(1);
+                const T x = m[0] * p[0] + m[1] * p[1] + m[2] * p[2] + m[3] * h;
+                const T y = m[4] * p[0] + m[5] * p[1] + m[6] * p[2] + m[7] * h;
+                const T z = m[8] * p[0] + m[9] * p[1] + m[10] * p[2] + m[11] * h;
+
+                if (mode == TM_PROJECTIVE)
+                {
+                    const T w = T(1) / (m[12] * p[0] + m[13] * p[1] + m[14] * p[2] + m[15]);
+
+                    r[0] = x * w;
+                    r[1] = y * w;
+                    r[2] = z * w;
+                }
+                else
+                {
+                    r[0] = x;
+                    r[1] = y;
+                    r[2] = z;
+                }
+            }
+        }
+    }
+
+    template void Transform::apply(TransformMode, const float*, float*, size_t, const float*, size_t, size_t);
+    template void Transform::apply(TransformMode, const double*, double*, size_t, const double*, size_t, size_t);
+
+}  // namespace Rt2::Math
@@ -0,0 +1,62 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include <cstddef>
+#include "Math/Scalar.h"
+
+namespace Rt2::Math
+{
+    enum TransformMode
+    {
+        TM_POINT = 0,   // M * [p, 1]
+        TM_DIRECTION,   // M * [v, 0]
+        TM_PROJECTIVE,  // M * [p, 1], divided by the resulting w
+    };
+
+    // Batch transform of Vec3 arrays, shared by the transform types.
+    // Three consecutive scalars are read from s and written to d every
+    // stride bytes, so positions can be transformed in place inside
+    // interleaved vertices. d may equal s.
+    //
+    // m holds the rows of a 3x4 matrix, or of a 4x4 matrix for
+    // TM_PROJECTIVE. Unlike Mat3::operator*, results are not snapped
+    // to zero.
+    //
+    // Every transform type has transformPoints and transformDirections
+    // built on apply. For Mat3 and Quat, which have no translation,
+    // the two are the same; both names exist so that call sites read
+    // the same for every transform type.
+    class Transform
+    {
+    public:
+        template <typename T>
+        static void apply(TransformMode mode,
+                          const T*      m,
+                          T*            d,
+                          size_t        dStride,
+                          const T*      s,
+                          size_t        sStride,
+                          size_t        n);
+    };
+
+}  // namespace Rt2::Math
@@ -25,8 +25,12 @@
 namespace Rt2::Math
 {
 
-    void Vec2::print() const
+    template <typename T>
+    void TVec2<T>::print() const
     {
-        Printer::print(*this);
+        Printer::print(Vec2(*this));
     }
+
+    template void TVec2<float>::print() const;
+    template void TVec2<double>::print() const;
 }  // namespace Rt2::Math
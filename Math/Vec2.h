@@ -21,263 +21,272 @@
 */
 #pragma once
 
+#include "Math/Forward.h"
 #include "Math/Math.h"
 
 namespace Rt2::Math
 {
-    class Vec2
+    template <typename T>
+    class TVec2
     {
     public:
-        Real x{}, y{};
+        T x{}, y{};
 
     public:
-        Vec2() = default;
+        TVec2() = default;
 
-        Vec2(const Vec2& v) = default;
+        TVec2(const TVec2& v) = default;
 
-        constexpr Vec2(const Real nx, const Real ny) :
+        constexpr TVec2(const T nx, const T ny) :
             x(nx),
             y(ny)
         {
         }
 
-        explicit Vec2(const Real* pointer)
+        template <typename U>
+        explicit constexpr TVec2(const TVec2<U>& v) :
+            x(T(v.x)),
+            y(T(v.y))
+        {
+        }
+
+        explicit constexpr TVec2(const T* pointer)
         {
             x = pointer[0];
             y = pointer[1];
         }
 
-        Real* ptr()
+        constexpr T* ptr()
         {
             return &x;
         }
 
-        const Real* ptr() const
+        constexpr const T* ptr() const
         {
             return &x;
         }
 
-        Vec2& operator=(const Vec2& v) = default;
+        TVec2& operator=(const TVec2& v) = default;
 
-        bool operator==(const Vec2& v) const
+        constexpr bool operator==(const TVec2& v) const
         {
-            return eq(x, v.x) && eq(y, v.y);
+            return eq<T>(x, v.x) && eq<T>(y, v.y);
         }
 
-        bool operator!=(const Vec2& v) const
+        constexpr bool operator!=(const TVec2& v) const
         {
-            return !eq(x, v.x) && !eq(y, v.y);
+            return !eq<T>(x, v.x) && !eq<T>(y, v.y);
         }
 
-        bool operator<(const Vec2& v) const
+        constexpr bool operator<(const TVec2& v) const
         {
             return x < v.x && y < v.y;
         }
 
-        bool operator>(const Vec2& v) const
+        constexpr bool operator>(const TVec2& v) const
         {
             return x > v.x && y > v.y;
         }
 
-        bool operator<=(const Vec2& v) const
+        constexpr bool operator<=(const TVec2& v) const
         {
             return x <= v.x && y <= v.y;
         }
 
-        bool operator>=(const Vec2& v) const
+        constexpr bool operator>=(const TVec2& v) const
         {
             return x >= v.x && y >= v.y;
         }
 
-        Vec2 operator+(const Real v) const
+        constexpr TVec2 operator+(const T v) const
         {
             return {x + v, y + v};
         }
 
-        Vec2 operator+(const Vec2& v) const
+        constexpr TVec2 operator+(const TVec2& v) const
         {
             return {x + v.x, y + v.y};
         }
 
-        Vec2& operator+=(const Real v)
+        constexpr TVec2& operator+=(const T v)
         {
             x += v;
             y += v;
             return *this;
         }
 
-        Vec2& operator+=(const Vec2& v)
+        constexpr TVec2& operator+=(const TVec2& v)
         {
             x += v.x;
             y += v.y;
             return *this;
         }
 
-        friend Vec2 operator+(const Real r, const Vec2& l)
+        friend constexpr TVec2 operator+(const T r, const TVec2& l)
         {
             return {l.x + r, l.y + r};
         }
 
-        Vec2 operator-(const Real v) const
+        constexpr TVec2 operator-(const T v) const
         {
             return {x - v, y - v};
         }
 
-        Vec2 operator-(const Vec2& v) const
+        constexpr TVec2 operator-(const TVec2& v) const
         {
             return {x - v.x, y - v.y};
         }
 
-        Vec2& operator-=(const Real v)
+        constexpr TVec2& operator-=(const T v)
         {
             x -= v;
             y -= v;
             return *this;
         }
 
-        Vec2& operator-=(const Vec2& v)
+        constexpr TVec2& operator-=(const TVec2& v)
         {
             x -= v.x;
             y -= v.y;
             return *this;
         }
 
-        Vec2 operator-() const
+        constexpr TVec2 operator-() const
         {
             return {-x, -y};
         }
 
-        friend Vec2 operator-(const Real r, const Vec2& l)
+        friend constexpr TVec2 operator-(const T r, const TVec2& l)
         {
             return {l.x - r, l.y - r};
         }
 
-        Vec2 operator*(const Real v) const
+        constexpr TVec2 operator*(const T v) const
         {
             return {x * v, y * v};
         }
 
-        Vec2 operator*(const Vec2& v) const
+        constexpr TVec2 operator*(const TVec2& v) const
         {
             return {x * v.x, y * v.y};
         }
 
-        Vec2& operator*=(const Real v)
+        constexpr TVec2& operator*=(const T v)
         {
             x *= v;
             y *= v;
             return *this;
         }
 
-        Vec2& operator*=(const Vec2& v)
+        constexpr TVec2& operator*=(const TVec2& v)
         {
             x *= v.x;
             y *= v.y;
             return *this;
         }
 
-        friend Vec2 operator*(const Real r, const Vec2& l)
+        friend constexpr TVec2 operator*(const T r, const TVec2& l)
         {
             return {l.x * r, l.y * r};
         }
 
-        Vec2 operator/(const Real v) const
+        constexpr TVec2 operator/(const T v) const
         {
-            const Real n = reciprocal(v);
+            const T n = reciprocal<T>(v);
             return {x * n, y * n};
         }
 
-        Vec2 operator/(const Vec2& v) const
+        constexpr TVec2 operator/(const TVec2& v) const
         {
-            return {x * reciprocal(v.x), y * reciprocal(v.y)};
+            return {x * reciprocal<T>(v.x), y * reciprocal<T>(v.y)};
         }
 
-        Vec2& operator/=(const Real v)
+        constexpr TVec2& operator/=(const T v)
         {
-            const Real n = reciprocal(v);
+            const T n = reciprocal<T>(v);
             x *= n;
             y *= n;
             return *this;
         }
 
-        Vec2& operator/=(const Vec2& v)
+        constexpr TVec2& operator/=(const TVec2& v)
         {
-            x *= reciprocal(v.x);
-            y *= reciprocal(v.y);
+            x *= reciprocal<T>(v.x);
+            y *= reciprocal<T>(v.y);
             return *this;
         }
 
-        Real length() const
+        constexpr T length() const
         {
-            return RtSqrt(length2());
+            return squareRoot<T>(length2());
         }
 
-        Real length2() const
+        constexpr T length2() const
         {
             return dot(*this);
         }
 
-        Real dot(const Vec2& v) const
+        constexpr T dot(const TVec2& v) const
         {
             return x * v.x + y * v.y;
         }
 
-        Vec2 abs() const
+        constexpr TVec2 abs() const
         {
-            return {Abs(x), Abs(y)};
+            return {Abs<T>(x), Abs<T>(y)};
         }
 
-        Real distance(const Vec2& v) const
+        constexpr T distance(const TVec2& v) const
         {
-            return Vec2(x - v.x, y - v.y).length();
+            return TVec2(x - v.x, y - v.y).length();
         }
 
-        Real distance2(const Vec2& v) const
+        constexpr T distance2(const TVec2& v) const
         {
-            return Vec2(x - v.x, y - v.y).length2();
+            return TVec2(x - v.x, y - v.y).length2();
         }
 
-        Vec2 perpendicular() const
+        constexpr TVec2 perpendicular() const
         {
             return {-y, x};
         }
 
-        void normalize()
+        constexpr void normalize()
         {
-            if (Real len = x * x + y * y;
-                len > Epsilon)
+            if (T len = x * x + y * y;
+                len > Limits<T>::Epsilon)
             {
-                len = RtRSqrt(len);
+                len = rsqrt<T>(len);
                 x *= len;
                 y *= len;
             }
         }
 
-        Vec2 normalized() const
+        constexpr TVec2 normalized() const
         {
-            Vec2 v(x, y);
+            TVec2 v(x, y);
             v.normalize();
             return v;
         }
 
-        Real hx() const
+        constexpr T hx() const
         {
-            return x * Half;
+            return x * T(0.5);
         }
 
-        Real hy() const
+        constexpr T hy() const
         {
-            return y * Half;
+            return y * T(0.5);
         }
 
-        Vec2 maxOf(const Vec2& v) const
+        constexpr TVec2 maxOf(const TVec2& v) const
         {
-            return {Max(x, v.x), Max(y, v.y)};
+            return {Max<T>(x, v.x), Max<T>(y, v.y)};
         }
 
-        Vec2 minOf(const Vec2& v) const
+        constexpr TVec2 minOf(const TVec2& v) const
         {
-            return {Min(x, v.x), Min(y, v.y)};
+            return {Min<T>(x, v.x), Min<T>(y, v.y)};
         }
 
         void print() const;
@@ -27,21 +27,22 @@
 namespace Rt2::Math
 {
 
-    Vec3::Vec3(const Color& col) :
-        x(col.r),
-        y(col.g),
-        z(col.b)
+    template <typename T>
+    TVec3<T>::TVec3(const Color& col) :
+        x(T(col.r)),
+        y(T(col.g)),
+        z(T(col.b))
     {
     }
 
-    const Vec3 Vec3::Unit  = Vec3(1, 1, 1);
-    const Vec3 Vec3::UnitX = Vec3(1, 0, 0);
-    const Vec3 Vec3::UnitY = Vec3(0, 1, 0);
-    const Vec3 Vec3::UnitZ = Vec3(0, 0, 1);
-    const Vec3 Vec3::Zero  = Vec3(0, 0, 0);
-
-    void Vec3::print() const
+    template <typename T>
+    void TVec3<T>::print() const
     {
-        Printer::print(*this);
+        Printer::print(Vec3(*this));
     }
+
+    template TVec3<float>::TVec3(const Color& col);
+    template TVec3<double>::TVec3(const Color& col);
+    template void TVec3<float>::print() const;
+    template void TVec3<double>::print() const;
 }  // namespace Rt2::Math
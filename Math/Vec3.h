@@ -21,92 +21,102 @@
 */
 #pragma once
 
+#include "Math/Forward.h"
 #include "Math/Math.h"
 
 namespace Rt2::Math
 {
     class Color;
 
-    class Vec3
+    template <typename T>
+    class TVec3
     {
     public:
-        Real x{}, y{}, z{};
+        T x{}, y{}, z{};
 
-        static const Vec3 Unit;
-        static const Vec3 UnitX;
-        static const Vec3 UnitY;
-        static const Vec3 UnitZ;
-        static const Vec3 Zero;
+        static const TVec3 Unit;
+        static const TVec3 UnitX;
+        static const TVec3 UnitY;
+        static const TVec3 UnitZ;
+        static const TVec3 Zero;
 
     public:
-        Vec3() = default;
+        TVec3() = default;
 
-        explicit Vec3(const Color& col);
+        explicit TVec3(const Color& col);
 
-        Vec3(const Real nx, const Real ny, const Real nz) :
+        constexpr TVec3(const T nx, const T ny, const T nz) :
             x(nx),
             y(ny),
             z(nz)
         {
         }
 
-        explicit Vec3(const float* pointer)
+        template <typename U>
+        explicit constexpr TVec3(const TVec3<U>& v) :
+            x(T(v.x)),
+            y(T(v.y)),
+            z(T(v.z))
+        {
+        }
+
+        explicit constexpr TVec3(const float* pointer)
         {
             if (pointer)
             {
-                x = (Real)pointer[0];
-                y = (Real)pointer[1];
-                z = (Real)pointer[2];
+                x = (T)pointer[0];
+                y = (T)pointer[1];
+                z = (T)pointer[2];
             }
             else
                 x = y = z = 0;
         }
 
-        explicit Vec3(const double* p)
+        explicit constexpr TVec3(const double* p)
         {
             if (p)
             {
-                x = (Real)p[0];
-                y = (Real)p[1];
-                z = (Real)p[2];
+                x = (T)p[0];
+                y = (T)p[1];
+                z = (T)p[2];
             }
             else
                 x = y = z = 0;
         }
 
-        Vec3(const Vec3& v) = default;
+        TVec3(const TVec3& v) = default;
 
-        Real* ptr()
+        constexpr T* ptr()
         {
             return &x;
         }
 
-        const Real* ptr() const
+        constexpr const T* ptr() const
         {
             return &x;
         }
 
-        bool operator==(const Vec3& v) const
+        constexpr bool operator==(const TVec3& v) const
         {
-            return eq(x, v.x) && eq(y, v.y) && eq(z, v.z);
+            return eq<T>(x, v.x) && eq<T>(y, v.y) && eq<T>(z, v.z);
         }
 
-        bool operator!=(const Vec3& v) const
+        constexpr bool operator!=(const TVec3& v) const
         {
-            return !eq(x, v.x) && !eq(y, v.y) && !eq(z, v.z);
+            return !eq<T>(x, v.x) && !eq<T>(y, v.y) && !eq<T>(z, v.z);
         }
 
-        Vec3 operator+(const Real v) const
+        constexpr TVec3 operator+(const T v) const
         {
             return {x + v, y + v, z + v};
         }
 
-        Vec3 operator+(const Vec3& v) const
+        constexpr TVec3 operator+(const TVec3& v) const
         {
             return {x + v.x, y + v.y, z + v.z};
         }
 
-        Vec3& operator+=(const Real v)
+        constexpr TVec3& operator+=(const T v)
         {
             x += v;
             y += v;
@@ -114,7 +124,7 @@ namespace Rt2::Math
             return *this;
         }
 
-        Vec3& operator+=(const Vec3& v)
+        constexpr TVec3& operator+=(const TVec3& v)
         {
             x += v.x;
             y += v.y;
@@ -122,33 +132,33 @@ namespace Rt2::Math
             return *this;
         }
 
-        Vec3 majorAxis() const
+        constexpr TVec3 majorAxis() const
         {
-            Vec3 result;
+            TVec3 result;
             majorAxis(result, *this);
             return result;
         }
 
-        Vec3 abs() const
+        constexpr TVec3 abs() const
         {
             return {
-                Abs(x),
-                Abs(y),
-                Abs(z),
+                Abs<T>(x),
+                Abs<T>(y),
+                Abs<T>(z),
             };
         }
 
-        Vec3 operator-(const Real v) const
+        constexpr TVec3 operator-(const T v) const
         {
             return {x - v, y - v, z - v};
         }
 
-        Vec3 operator-(const Vec3& v) const
+        constexpr TVec3 operator-(const TVec3& v) const
         {
             return {x - v.x, y - v.y, z - v.z};
         }
 
-        Vec3& operator-=(const Real v)
+        constexpr TVec3& operator-=(const T v)
         {
             x -= v;
             y -= v;
@@ -156,7 +166,7 @@ namespace Rt2::Math
             return *this;
         }
 
-        Vec3& operator-=(const Vec3& v)
+        constexpr TVec3& operator-=(const TVec3& v)
         {
             x -= v.x;
             y -= v.y;
@@ -164,22 +174,22 @@ namespace Rt2::Math
             return *this;
         }
 
-        Vec3 operator-() const
+        constexpr TVec3 operator-() const
         {
             return {-x, -y, -z};
         }
 
-        Vec3 operator*(const Real v) const
+        constexpr TVec3 operator*(const T v) const
         {
             return {x * v, y * v, z * v};
         }
 
-        Vec3 operator*(const Vec3& v) const
+        constexpr TVec3 operator*(const TVec3& v) const
         {
             return {x * v.x, y * v.y, z * v.z};
         }
 
-        Vec3& operator*=(const Real v)
+        constexpr TVec3& operator*=(const T v)
         {
             x *= v;
             y *= v;
@@ -187,7 +197,7 @@ namespace Rt2::Math
             return *this;
         }
 
-        Vec3& operator*=(const Vec3& v)
+        constexpr TVec3& operator*=(const TVec3& v)
         {
             x *= v.x;
             y *= v.y;
@@ -195,64 +205,64 @@ namespace Rt2::Math
             return *this;
         }
 
-        Vec3 operator/(const Real v) const
+        constexpr TVec3 operator/(const T v) const
         {
-            const Real n = reciprocal(v);
+            const T n = reciprocal<T>(v);
             return {x * n, y * n, z * n};
         }
 
-        Vec3 operator/(const Vec3& v) const
+        constexpr TVec3 operator/(const TVec3& v) const
         {
             return {
-                x * reciprocal(v.x),
-                y * reciprocal(v.y),
-                z * reciprocal(v.z),
+                x * reciprocal<T>(v.x),
+                y * reciprocal<T>(v.y),
+                z * reciprocal<T>(v.z),
             };
         }
 
-        Vec3& operator/=(const Real v)
+        constexpr TVec3& operator/=(const T v)
         {
-            const Real n = reciprocal(v);
+            const T n = reciprocal<T>(v);
             x *= n;
             y *= n;
             z *= n;
             return *this;
         }
 
-        Vec3& operator/=(const Vec3& v)
+        constexpr TVec3& operator/=(const TVec3& v)
         {
-            x *= reciprocal(v.x);
-            y *= reciprocal(v.y);
-            z *= reciprocal(v.z);
+            x *= reciprocal<T>(v.x);
+            y *= reciprocal<T>(v.y);
+            z *= reciprocal<T>(v.z);
             return *this;
         }
 
-        Real length() const
+        constexpr T length() const
         {
-            return RtSqrt(length2());
+            return squareRoot<T>(length2());
         }
 
-        Real length2() const
+        constexpr T length2() const
         {
             return x * x + y * y + z * z;
         }
 
-        Real dot(const Vec3& v) const
+        constexpr T dot(const TVec3& v) const
         {
             return x * v.x + y * v.y + z * v.z;
         }
 
-        Real distance(const Vec3& v) const
+        constexpr T distance(const TVec3& v) const
         {
-            return Vec3(x - v.x, y - v.y, z - v.z).length();
+            return TVec3(x - v.x, y - v.y, z - v.z).length();
         }
 
-        Real distance2(const Vec3& v) const
+        constexpr T distance2(const TVec3& v) const
         {
-            return Vec3(x - v.x, y - v.y, z - v.z).length2();
+            return TVec3(x - v.x, y - v.y, z - v.z).length2();
         }
 
-        Vec3 cross(const Vec3& v) const
+        constexpr TVec3 cross(const TVec3& v) const
         {
             return {
                 y * v.z - z * v.y,
@@ -261,40 +271,40 @@ namespace Rt2::Math
             };
         }
 
-        Real max3() const
+        constexpr T max3() const
         {
-            return Max3(x, y, z);
+            return Max3<T>(x, y, z);
         }
 
-        void normalize()
+        constexpr void normalize()
         {
-            if (const Real sl = length2(); sl > Epsilon)
+            if (const T sl = length2(); sl > Limits<T>::Epsilon)
             {
-                const Real rs = RtRSqrt(sl);
+                const T rs = rsqrt<T>(sl);
                 x *= rs;
                 y *= rs;
                 z *= rs;
             }
         }
 
-        Vec3 normalized() const
+        constexpr TVec3 normalized() const
         {
-            if (const Real sl = length2();
-                sl > Epsilon)
+            if (const T sl = length2();
+                sl > Limits<T>::Epsilon)
             {
-                const Real rs = RtRSqrt(sl);
+                const T rs = rsqrt<T>(sl);
                 return {x * rs, y * rs, z * rs};
             }
 
             return Zero;
         }
 
-        static void majorAxis(Vec3& dest, const Vec3& src)
+        static constexpr void majorAxis(TVec3& dest, const TVec3& src)
         {
-            if (const Real m = Max3(src.x, src.y, src.z);
-                eq(m, src.x))
+            if (const T m = Max3<T>(src.x, src.y, src.z);
+                eq<T>(m, src.x))
                 dest = UnitX;
-            else if (eq(m, src.y))
+            else if (eq<T>(m, src.y))
                 dest = UnitY;
             else
                 dest = UnitZ;
@@ -303,23 +313,43 @@ namespace Rt2::Math
         void print() const;
     };
 
-    inline Vec3 operator-(const Real r, const Vec3& l)
+    template <typename T>
+    constexpr TVec3<T> operator-(const NoDeduce<T> r, const TVec3<T>& l)
     {
         return {l.x - r, l.y - r, l.z - r};
     }
 
-    inline Vec3 operator+(const Real r, const Vec3& l)
+    template <typename T>
+    constexpr TVec3<T> operator+(const NoDeduce<T> r, const TVec3<T>& l)
     {
         return {l.x + r, l.y + r, l.z + r};
     }
 
-    inline Vec3 operator/(const Real r, const Vec3& l)
+    template <typename T>
+    constexpr TVec3<T> operator/(const NoDeduce<T> r, const TVec3<T>& l)
     {
-        return {l.x / r, l.y / r, l.z / r};
+        return {r / l.x, r / l.y, r / l.z};
     }
 
-    inline Vec3 operator*(const Real r, const Vec3& l)
+    template <typename T>
+    constexpr TVec3<T> operator*(const NoDeduce<T> r, const TVec3<T>& l)
     {
         return {l.x * r, l.y * r, l.z * r};
     }
+
+    template <typename T>
+    inline constexpr TVec3<T> TVec3<T>::Unit = TVec3<T>(1, 1, 1);
+
+    template <typename T>
+    inline constexpr TVec3<T> TVec3<T>::UnitX = TVec3<T>(1, 0, 0);
+
+    template <typename T>
+    inline constexpr TVec3<T> TVec3<T>::UnitY = TVec3<T>(0, 1, 0);
+
+    template <typename T>
+    inline constexpr TVec3<T> TVec3<T>::UnitZ = TVec3<T>(0, 0, 1);
+
+    template <typename T>
+    inline constexpr TVec3<T> TVec3<T>::Zero = TVec3<T>(0, 0, 0);
+
 }  // namespace Rt2::Math
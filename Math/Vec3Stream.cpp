@@ -0,0 +1,167 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Math/Vec3Stream.h"
+#include "Math/Dispatch.h"
+
+namespace Rt2::Math
+{
+    namespace
+    {
+        size_t common(const Vec3Stream& a, const Vec3Stream& b)
+        {
+            return a.size() < b.size() ? a.size() : b.size();
+        }
+
+        Vec3Out out(Vec3Stream& s)
+        {
+            return {s.x(), s.y(), s.z()};
+        }
+
+        Vec3In in(const Vec3Stream& s)
+        {
+            return {s.x(), s.y(), s.z()};
+        }
+    }  // namespace
+
+    Vec3Stream::Vec3Stream(const size_t size)
+    {
+        resize(size);
+    }
+
+    Vec3Stream::Vec3Stream(const Vec3* src, const size_t size)
+    {
+        assign(src, size);
+    }
+
+    void Vec3Stream::reserve(const size_t size)
+    {
+        _x.reserve(size);
+        _y.reserve(size);
+        _z.reserve(size);
+    }
+
+    void Vec3Stream::resize(const size_t size)
+    {
+        _x.resize(size);
+        _y.resize(size);
+        _z.resize(size);
+    }
+
+    void Vec3Stream::clear()
+    {
+        _x.clear();
+        _y.clear();
+        _z.clear();
+    }
+
+    void Vec3Stream::push(const Vec3& v)
+    {
+        _x.push_back(v.x);
+        _y.push_back(v.y);
+        _z.push_back(v.z);
+    }
+
+    void Vec3Stream::assign(const Vec3* src, const size_t size)
+    {
+        resize(size);
+        if (src)
+        {
+            for (size_t i = 0; i < size; ++i)
+                set(i, src[i]);
+        }
+    }
+
+    void Vec3Stream::copy(Vec3* dest) const
+    {
+        if (dest)
+        {
+            const size_t n = size();
+            for (size_t i = 0; i < n; ++i)
+                dest[i] = at(i);
+        }
+    }
+
+    void Vec3Stream::normalize()
+    {
+        Dispatch::kernels().vec3Normalize(out(*this), in(*this), size());
+    }
+
+    void Vec3Stream::add(Vec3Stream& dest, const Vec3Stream& a, const Vec3Stream& b)
+    {
+        const size_t n = common(a, b);
+        dest.resize(n);
+        Dispatch::kernels().vec3Add(out(dest), in(a), in(b), n);
+    }
+
+    void Vec3Stream::sub(Vec3Stream& dest, const Vec3Stream& a, const Vec3Stream& b)
+    {
+        const size_t n = common(a, b);
+        dest.resize(n);
+        Dispatch::kernels().vec3Sub(out(dest), in(a), in(b), n);
+    }
+
+    void Vec3Stream::mul(Vec3Stream& dest, const Vec3Stream& a, const Vec3Stream& b)
+    {
+        const size_t n = common(a, b);
+        dest.resize(n);
+        Dispatch::kernels().vec3Mul(out(dest), in(a), in(b), n);
+    }
+
+    void Vec3Stream::scale(Vec3Stream& dest, const Vec3Stream& a, const Real s)
+    {
+        dest.resize(a.size());
+        Dispatch::kernels().vec3Scale(out(dest), in(a), s, a.size());
+    }
+
+    void Vec3Stream::cross(Vec3Stream& dest, const Vec3Stream& a, const Vec3Stream& b)
+    {
+        const size_t n = common(a, b);
+        dest.resize(n);
+        Dispatch::kernels().vec3Cross(out(dest), in(a), in(b), n);
+    }
+
+    void Vec3Stream::normalize(Vec3Stream& dest, const Vec3Stream& a)
+    {
+        dest.resize(a.size());
+        Dispatch::kernels().vec3Normalize(out(dest), in(a), a.size());
+    }
+
+    void Vec3Stream::dot(RealArray& dest, const Vec3Stream& a, const Vec3Stream& b)
+    {
+        const size_t n = common(a, b);
+        dest.resize(n);
+        Dispatch::kernels().vec3Dot(dest.data(), in(a), in(b), n);
+    }
+
+    void Vec3Stream::length(RealArray& dest, const Vec3Stream& a)
+    {
+        dest.resize(a.size());
+        Dispatch::kernels().vec3Length(dest.data(), in(a), a.size());
+    }
+
+    void Vec3Stream::length2(RealArray& dest, const Vec3Stream& a)
+    {
+        dest.resize(a.size());
+        Dispatch::kernels().vec3Dot(dest.data(), in(a), in(a), a.size());
+    }
+
+}  // namespace Rt2::Math
@@ -0,0 +1,145 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+
+#include "Math/AlignedArray.h"
+#include "Math/Vec3.h"
+
+namespace Rt2::Math
+{
+    using RealArray = AlignedArray<Real>;
+
+    // Structure of arrays storage for Vec3.
+    // Each component is stored in its own cache aligned array
+    // so that the batch methods can process a full SIMD register
+    // of elements per instruction.
+    class Vec3Stream
+    {
+    private:
+        RealArray _x, _y, _z;
+
+    public:
+        Vec3Stream() = default;
+
+        explicit Vec3Stream(size_t size);
+
+        Vec3Stream(const Vec3* src, size_t size);
+
+        void reserve(size_t size);
+
+        void resize(size_t size);
+
+        void clear();
+
+        void push(const Vec3& v);
+
+        void set(size_t i, const Vec3& v);
+
+        Vec3 at(size_t i) const;
+
+        void assign(const Vec3* src, size_t size);
+
+        void copy(Vec3* dest) const;
+
+        size_t size() const;
+
+        Real* x();
+
+        Real* y();
+
+        Real* z();
+
+        const Real* x() const;
+
+        const Real* y() const;
+
+        const Real* z() const;
+
+        void normalize();
+
+        static void add(Vec3Stream& dest, const Vec3Stream& a, const Vec3Stream& b);
+
+        static void sub(Vec3Stream& dest, const Vec3Stream& a, const Vec3Stream& b);
+
+        static void mul(Vec3Stream& dest, const Vec3Stream& a, const Vec3Stream& b);
+
+        static void scale(Vec3Stream& dest, const Vec3Stream& a, Real s);
+
+        static void cross(Vec3Stream& dest, const Vec3Stream& a, const Vec3Stream& b);
+
+        static void normalize(Vec3Stream& dest, const Vec3Stream& a);
+
+        static void dot(RealArray& dest, const Vec3Stream& a, const Vec3Stream& b);
+
+        static void length(RealArray& dest, const Vec3Stream& a);
+
+        static void length2(RealArray& dest, const Vec3Stream& a);
+    };
+
+    inline size_t Vec3Stream::size() const
+    {
+        return _x.size();
+    }
+
+    inline Real* Vec3Stream::x()
+    {
+        return _x.data();
+    }
+
+    inline Real* Vec3Stream::y()
+    {
+        return _y.data();
+    }
+
+    inline Real* Vec3Stream::z()
+    {
+        return _z.data();
+    }
+
+    inline const Real* Vec3Stream::x() const
+    {
+        return _x.data();
+    }
+
+    inline const Real* Vec3Stream::y() const
+    {
+        return _y.data();
+    }
+
+    inline const Real* Vec3Stream::z() const
+    {
+        return _z.data();
+    }
+
+    inline void Vec3Stream::set(const size_t i, const Vec3& v)
+    {
+        _x[i] = v.x;
+        _y[i] = v.y;
+        _z[i] = v.z;
+    }
+
+    inline Vec3 Vec3Stream::at(const size_t i) const
+    {
+        return {_x[i], _y[i], _z[i]};
+    }
+
+}  // namespace Rt2::Math
@@ -25,9 +25,13 @@
 
 namespace Rt2::Math
 {
-    void Vec4::print() const
+    template <typename T>
+    void TVec4<T>::print() const
     {
-        Printer::print(*this);
+        Printer::print(Vec4(*this));
     }
 
+    template void TVec4<float>::print() const;
+    template void TVec4<double>::print() const;
+
 }  // namespace Rt2::Math
@@ -21,23 +21,52 @@
 */
 #pragma once
 
+#include "Math/Forward.h"
 #include "Math/Math.h"
 
+#ifdef Math_USE_SIMD_VEC4
+    #include "Math/Simd.h"
+    #ifdef Math_SIMD_QUAD
+        #define Math_VEC4_SIMD
+    #endif
+#endif
+
+// With Math_VEC4_SIMD, TVec4<Real> replaces its arithmetic with SIMD
+// specializations. Those are not usable in constant expressions, so only
+// construction, comparison and the constants of Vec4 stay constexpr.
+//
+// The alignment depends on Math_USE_SIMD_VEC4 and the precision only,
+// not on the instruction set a translation unit is compiled for, so
+// that every translation unit agrees on the layout of Vec4.
+#ifdef Math_USE_SIMD_VEC4
+    #define Math_VEC4_ALIGN alignas(std::is_same_v<T, Real> ? 4 * sizeof(Real) : alignof(T))
+#else
+    #define Math_VEC4_ALIGN
+#endif
+
+#ifdef Math_VEC4_SIMD
+static_assert(Rt2::Math::Simd::QuadAlignment <= 4 * sizeof(Rt2::Math::Real));
+#endif
+
 namespace Rt2::Math
 {
-    class Vec4
+    template <typename T>
+    class Math_VEC4_ALIGN TVec4
     {
     public:
-        Real x{}, y{}, z{}, w{};
-        
+        T x{}, y{}, z{}, w{};
+
+        static const TVec4 Unit;
+        static const TVec4 Zero;
+
     public:
-        Vec4()                 = default;
-        Vec4(const Vec4& v) = default;
+        TVec4()               = default;
+        TVec4(const TVec4& v) = default;
 
-        Vec4(const Real& nx,
-                const Real& ny,
-                const Real& nz,
-                const Real& nw) :
+        constexpr TVec4(const T& nx,
+                        const T& ny,
+                        const T& nz,
+                        const T& nw) :
             x(nx),
             y(ny),
             z(nz),
@@ -45,7 +74,16 @@ namespace Rt2::Math
         {
         }
 
-        explicit Vec4(const Real* p)
+        template <typename U>
+        explicit constexpr TVec4(const TVec4<U>& v) :
+            x(T(v.x)),
+            y(T(v.y)),
+            z(T(v.z)),
+            w(T(v.w))
+        {
+        }
+
+        explicit constexpr TVec4(const T* p)
         {
             if (p != nullptr)
             {
@@ -56,31 +94,393 @@ namespace Rt2::Math
             }
         }
 
-        Real* ptr()
+        TVec4& operator=(const TVec4& v) = default;
+
+        constexpr T* ptr()
         {
             return &x;
         }
 
-        const Real* ptr() const
+        constexpr const T* ptr() const
         {
             return &x;
         }
 
-        inline bool operator==(const Vec4& v) const;
+        constexpr bool operator==(const TVec4& v) const;
+
+        constexpr bool operator!=(const TVec4& v) const;
+
+        constexpr TVec4 operator+(T v) const;
+
+        constexpr TVec4 operator+(const TVec4& v) const;
+
+        constexpr TVec4& operator+=(T v);
+
+        constexpr TVec4& operator+=(const TVec4& v);
+
+        constexpr TVec4 operator-(T v) const;
+
+        constexpr TVec4 operator-(const TVec4& v) const;
+
+        constexpr TVec4& operator-=(T v);
+
+        constexpr TVec4& operator-=(const TVec4& v);
+
+        constexpr TVec4 operator-() const;
+
+        constexpr TVec4 operator*(T v) const;
+
+        constexpr TVec4 operator*(const TVec4& v) const;
+
+        constexpr TVec4& operator*=(T v);
+
+        constexpr TVec4& operator*=(const TVec4& v);
 
-        inline bool operator!=(const Vec4& v) const;
+        constexpr TVec4 operator/(T v) const;
+
+        constexpr TVec4 operator/(const TVec4& v) const;
+
+        constexpr TVec4& operator/=(T v);
+
+        constexpr TVec4& operator/=(const TVec4& v);
+
+        constexpr T dot(const TVec4& v) const;
+
+        constexpr T length() const;
+
+        constexpr T length2() const;
+
+        constexpr T distance(const TVec4& v) const;
+
+        constexpr T distance2(const TVec4& v) const;
+
+        constexpr void normalize();
+
+        constexpr TVec4 normalized() const;
+
+        constexpr TVec4 abs() const;
+
+        constexpr TVec4 minOf(const TVec4& v) const;
+
+        constexpr TVec4 maxOf(const TVec4& v) const;
+
+        constexpr TVec4 lerp(const TVec4& v, T t) const;
 
         void print() const;
+
+#ifdef Math_VEC4_SIMD
+    private:
+        explicit TVec4(const Simd::Quad& q)
+        {
+            Simd::storeQuad(&x, q);
+        }
+
+        Simd::Quad quad() const
+        {
+            return Simd::loadQuad(&x);
+        }
+#endif
     };
 
-    inline bool Vec4::operator==(const Vec4& v) const
+    template <typename T>
+    inline constexpr TVec4<T> TVec4<T>::Unit = TVec4<T>(1, 1, 1, 1);
+
+    template <typename T>
+    inline constexpr TVec4<T> TVec4<T>::Zero = TVec4<T>(0, 0, 0, 0);
+
+    template <typename T>
+    constexpr bool TVec4<T>::operator==(const TVec4<T>& v) const
+    {
+        return eq<T>(x, v.x) && eq<T>(y, v.y) && eq<T>(z, v.z) && eq<T>(w, v.w);
+    }
+
+    template <typename T>
+    constexpr bool TVec4<T>::operator!=(const TVec4<T>& v) const
+    {
+        return !eq<T>(x, v.x) && !eq<T>(y, v.y) && !eq<T>(z, v.z) && !eq<T>(w, v.w);
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::operator+(const T v) const
+    {
+        return {x + v, y + v, z + v, w + v};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::operator+(const TVec4<T>& v) const
+    {
+        return {x + v.x, y + v.y, z + v.z, w + v.w};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::operator-(const T v) const
+    {
+        return {x - v, y - v, z - v, w - v};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::operator-(const TVec4<T>& v) const
+    {
+        return {x - v.x, y - v.y, z - v.z, w - v.w};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::operator-() const
+    {
+        return {-x, -y, -z, -w};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::operator*(const T v) const
+    {
+        return {x * v, y * v, z * v, w * v};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::operator*(const TVec4<T>& v) const
+    {
+        return {x * v.x, y * v.y, z * v.z, w * v.w};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::operator/(const T v) const
+    {
+        const T n = reciprocal<T>(v);
+        return {x * n, y * n, z * n, w * n};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::operator/(const TVec4<T>& v) const
+    {
+        return {
+            x * reciprocal<T>(v.x),
+            y * reciprocal<T>(v.y),
+            z * reciprocal<T>(v.z),
+            w * reciprocal<T>(v.w),
+        };
+    }
+
+    template <typename T>
+    constexpr T TVec4<T>::dot(const TVec4<T>& v) const
+    {
+        return x * v.x + y * v.y + z * v.z + w * v.w;
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::abs() const
+    {
+        return {Abs<T>(x), Abs<T>(y), Abs<T>(z), Abs<T>(w)};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::minOf(const TVec4<T>& v) const
+    {
+        return {Min<T>(x, v.x), Min<T>(y, v.y), Min<T>(z, v.z), Min<T>(w, v.w)};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::maxOf(const TVec4<T>& v) const
+    {
+        return {Max<T>(x, v.x), Max<T>(y, v.y), Max<T>(z, v.z), Max<T>(w, v.w)};
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::lerp(const TVec4<T>& v, const T t) const
+    {
+        return {
+            x + (v.x - x) * t,
+            y + (v.y - y) * t,
+            z + (v.z - z) * t,
+            w + (v.w - w) * t,
+        };
+    }
+
+#ifdef Math_VEC4_SIMD
+
+    template <>
+    inline Vec4 Vec4::operator+(const Real v) const
+    {
+        return Vec4(quad() + Simd::splatQuad(v));
+    }
+
+    template <>
+    inline Vec4 Vec4::operator+(const Vec4& v) const
+    {
+        return Vec4(quad() + v.quad());
+    }
+
+    template <>
+    inline Vec4 Vec4::operator-(const Real v) const
+    {
+        return Vec4(quad() - Simd::splatQuad(v));
+    }
+
+    template <>
+    inline Vec4 Vec4::operator-(const Vec4& v) const
+    {
+        return Vec4(quad() - v.quad());
+    }
+
+    template <>
+    inline Vec4 Vec4::operator-() const
+    {
+        return Vec4(Simd::splatQuad(0) - quad());
+    }
+
+    template <>
+    inline Vec4 Vec4::operator*(const Real v) const
+    {
+        return Vec4(quad() * Simd::splatQuad(v));
+    }
+
+    template <>
+    inline Vec4 Vec4::operator*(const Vec4& v) const
+    {
+        return Vec4(quad() * v.quad());
+    }
+
+    template <>
+    inline Vec4 Vec4::operator/(const Real v) const
+    {
+        return Vec4(quad() * Simd::splatQuad(reciprocal(v)));
+    }
+
+    template <>
+    inline Vec4 Vec4::operator/(const Vec4& v) const
+    {
+        return Vec4(quad() * Simd::reciprocal(v.quad()));
+    }
+
+    template <>
+    inline Real Vec4::dot(const Vec4& v) const
+    {
+        return Simd::dot(quad(), v.quad());
+    }
+
+    template <>
+    inline Vec4 Vec4::abs() const
+    {
+        return Vec4(Simd::abs(quad()));
+    }
+
+    template <>
+    inline Vec4 Vec4::minOf(const Vec4& v) const
+    {
+        return Vec4(Simd::min(quad(), v.quad()));
+    }
+
+    template <>
+    inline Vec4 Vec4::maxOf(const Vec4& v) const
+    {
+        return Vec4(Simd::max(quad(), v.quad()));
+    }
+
+    template <>
+    inline Vec4 Vec4::lerp(const Vec4& v, const Real t) const
+    {
+        const Simd::Quad a = quad();
+        return Vec4(a + (v.quad() - a) * Simd::splatQuad(t));
+    }
+
+#endif
+
+    template <typename T>
+    constexpr TVec4<T>& TVec4<T>::operator+=(const T v)
+    {
+        return *this = *this + v;
+    }
+
+    template <typename T>
+    constexpr TVec4<T>& TVec4<T>::operator+=(const TVec4<T>& v)
+    {
+        return *this = *this + v;
+    }
+
+    template <typename T>
+    constexpr TVec4<T>& TVec4<T>::operator-=(const T v)
+    {
+        return *this = *this - v;
+    }
+
+    template <typename T>
+    constexpr TVec4<T>& TVec4<T>::operator-=(const TVec4<T>& v)
+    {
+        return *this = *this - v;
+    }
+
+    template <typename T>
+    constexpr TVec4<T>& TVec4<T>::operator*=(const T v)
+    {
+        return *this = *this * v;
+    }
+
+    template <typename T>
+    constexpr TVec4<T>& TVec4<T>::operator*=(const TVec4<T>& v)
+    {
+        return *this = *this * v;
+    }
+
+    template <typename T>
+    constexpr TVec4<T>& TVec4<T>::operator/=(const T v)
+    {
+        return *this = *this / v;
+    }
+
+    template <typename T>
+    constexpr TVec4<T>& TVec4<T>::operator/=(const TVec4<T>& v)
+    {
+        return *this = *this / v;
+    }
+
+    template <typename T>
+    constexpr T TVec4<T>::length() const
+    {
+        return squareRoot<T>(length2());
+    }
+
+    template <typename T>
+    constexpr T TVec4<T>::length2() const
+    {
+        return dot(*this);
+    }
+
+    template <typename T>
+    constexpr T TVec4<T>::distance(const TVec4<T>& v) const
+    {
+        return (*this - v).length();
+    }
+
+    template <typename T>
+    constexpr T TVec4<T>::distance2(const TVec4<T>& v) const
+    {
+        return (*this - v).length2();
+    }
+
+    template <typename T>
+    constexpr void TVec4<T>::normalize()
+    {
+        if (const T sl = length2(); sl > Limits<T>::Epsilon)
+            *this *= rsqrt<T>(sl);
+    }
+
+    template <typename T>
+    constexpr TVec4<T> TVec4<T>::normalized() const
+    {
+        if (const T sl = length2(); sl > Limits<T>::Epsilon)
+            return *this * rsqrt<T>(sl);
+        return Zero;
+    }
+
+    template <typename T>
+    constexpr TVec4<T> operator*(const NoDeduce<T> r, const TVec4<T>& l)
     {
-        return eq(x, v.x) && eq(y, v.y) && eq(z, v.z) && eq(w, v.w);
+        return l * r;
     }
 
-    inline bool Vec4::operator!=(const Vec4& v) const
+    template <typename T>
+    constexpr TVec4<T> operator+(const NoDeduce<T> r, const TVec4<T>& l)
     {
-        return !eq(x, v.x) && !eq(y, v.y) && !eq(z, v.z) && !eq(w, v.w);
+        return l + r;
     }
 
 }  // namespace Rt2::Math
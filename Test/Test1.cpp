@@ -19,10 +19,30 @@
   3. This notice may not be removed or altered from any source distribution.
 -------------------------------------------------------------------------------
 */
+#include <algorithm>
+#include <vector>
+#include "Math/Affine3.h"
+#include "Math/Animation.h"
+#include "Math/Box3d.h"
+#include "Math/Box3dArray.h"
+#include "Math/Bvh.h"
 #include "Math/Color.h"
+#include "Math/Dispatch.h"
+#include "Math/DualQuat.h"
+#include "Math/Frustum.h"
+#include "Math/Hierarchy.h"
 #include "Math/Mat3.h"
+#include "Math/Mat4.h"
+#include "Math/Packed.h"
+#include "Math/Precision.h"
+#include "Math/Quat.h"
+#include "Math/QuatStream.h"
 #include "Math/Rand.h"
+#include "Math/RayPacket.h"
 #include "Math/Rect.h"
+#include "Math/Skinning.h"
+#include "Math/Vec3Stream.h"
+#include "Math/Vec4.h"
 #include "Utils/StreamMethods.h"
 #include "gtest/gtest.h"
 #include "Math/Print.h"
@@ -37,6 +57,38 @@ using namespace Math;
 #endif
 
 constexpr int Steps = 32;
+
+// Batch kernels may contract to fused multiply-adds,
+// so they are compared against the scalar types with a tolerance.
+#define EXPECT_VEC3_NEAR(a, b)                             \
+    {                                                      \
+        const Vec3 _a = (a), _b = (b);                     \
+        EXPECT_NEAR(_a.x, _b.x, 1e-4 * (1 + Abs(_b.x)));   \
+        EXPECT_NEAR(_a.y, _b.y, 1e-4 * (1 + Abs(_b.y)));   \
+        EXPECT_NEAR(_a.z, _b.z, 1e-4 * (1 + Abs(_b.z)));   \
+    }
+
+// Calls fn with each kernel level the CPU supports selected in turn,
+// and selects the best one again on the way out, even when an ASSERT
+// inside fn returns early.
+template <typename Fn>
+void forEachKernelLevel(const Fn& fn)
+{
+    struct Restore
+    {
+        ~Restore()
+        {
+            Dispatch::select(Dispatch::best());
+        }
+    } restore;
+
+    for (int lv = KL_BASE; lv < KL_MAX; ++lv)
+    {
+        if (Dispatch::select((KernelLevel)lv))
+            fn((KernelLevel)lv);
+    }
+}
+
 constexpr int Lps   = Steps / 4;
 
 GTEST_TEST(Math, Random_range)
@@ -304,3 +356,1724 @@ GTEST_TEST(Math, Color_001)
     cv.toInt(iv);
     EXPECT_EQ(0x000000FF, iv);
 }
+
+GTEST_TEST(Math, Vec3Stream_001)
+{
+    Rand::init();
+
+    constexpr size_t Size = 8 * Steps + 3;
+
+    Vec3Stream a, b;
+    for (size_t i = 0; i < Size; ++i)
+    {
+        a.push({Rand::range(-Steps, Steps) + Rand::real(), Rand::real(), Rand::real() - Half});
+        b.push({Rand::real(), Rand::range(-Steps, Steps) + Rand::real(), Rand::real()});
+    }
+    a.set(1, Vec3::Zero);
+    EXPECT_EQ(a.size(), Size);
+    EXPECT_EQ((size_t)a.x() % 64, 0);
+    EXPECT_EQ((size_t)a.z() % 64, 0);
+
+    Vec3Stream sum, diff, cross, norm;
+    RealArray  dot, len;
+    Vec3Stream::add(sum, a, b);
+    Vec3Stream::sub(diff, a, b);
+    Vec3Stream::cross(cross, a, b);
+    Vec3Stream::normalize(norm, a);
+    Vec3Stream::dot(dot, a, b);
+    Vec3Stream::length(len, a);
+
+    for (size_t i = 0; i < Size; ++i)
+    {
+        const Vec3 va = a.at(i), vb = b.at(i);
+        EXPECT_VEC3_NEAR(sum.at(i), va + vb);
+        EXPECT_VEC3_NEAR(diff.at(i), va - vb);
+        EXPECT_VEC3_NEAR(cross.at(i), va.cross(vb));
+        EXPECT_VEC3_NEAR(norm.at(i), va.length2() > Epsilon ? va.normalized() : va);
+        EXPECT_NEAR(dot[i], va.dot(vb), 1e-4 * (1 + Abs(dot[i])));
+        EXPECT_NEAR(len[i], va.length(), 1e-4);
+    }
+
+    Vec3Stream::scale(a, a, 2);
+    a.normalize();
+    EXPECT_VEC3_NEAR(a.at(0), norm.at(0));
+    EXPECT_VEC3_NEAR(a.at(Size - 1), norm.at(Size - 1));
+
+    // Appending an element of the array itself, across a reallocation.
+    RealArray grow;
+    grow.push_back(3);
+    while (grow.size() < grow.capacity())
+        grow.push_back(grow[0]);
+    grow.push_back(grow[0]);
+    EXPECT_EQ(grow[grow.size() - 1], 3);
+}
+
+GTEST_TEST(Math, Vector4_001)
+{
+    const Vec4 a(1, -2, 3, -4);
+    const Vec4 b(2, 4, -6, 8);
+
+    EXPECT_EQ(a + b, Vec4(3, 2, -3, 4));
+    EXPECT_EQ(a - b, Vec4(-1, -6, 9, -12));
+    EXPECT_EQ(a * b, Vec4(2, -8, -18, -32));
+    EXPECT_EQ(b / a, Vec4(2, -2, -2, -2));
+    EXPECT_EQ(a * 2, Vec4(2, -4, 6, -8));
+    EXPECT_EQ(b / 2, Vec4(1, 2, -3, 4));
+    EXPECT_EQ(a + 1, Vec4(2, -1, 4, -3));
+    EXPECT_EQ(-a, Vec4(-1, 2, -3, 4));
+    EXPECT_EQ(a.abs(), Vec4(1, 2, 3, 4));
+    EXPECT_EQ(a.minOf(b), Vec4(1, -2, -6, -4));
+    EXPECT_EQ(a.maxOf(b), Vec4(2, 4, 3, 8));
+    EXPECT_EQ(a.lerp(b, Half), Vec4(Real(1.5), 1, Real(-1.5), 2));
+    EXPECT_REAL_EQ(a.dot(b), -56);
+    EXPECT_REAL_EQ(a.length2(), 30);
+
+    Vec4 c = a;
+    c += b;
+    c -= b;
+    c *= 3;
+    c /= 3;
+    EXPECT_EQ(c, a);
+
+    c.normalize();
+    EXPECT_NEAR(c.length(), 1, 1e-6);
+    EXPECT_EQ(Vec4::Zero.normalized(), Vec4::Zero);
+}
+
+GTEST_TEST(Math, RSqrt_001)
+{
+    for (Real x = Real(1e-6); x < Real(1e6); x *= Real(1.37))
+    {
+        const Real ex = Real(1) / RtSqrt(x);
+        EXPECT_NEAR(rsqrtExact(x), ex, ex * Real(1e-7));
+        EXPECT_NEAR(rsqrtFast(x), ex, ex * Real(2.8e-7));
+        EXPECT_NEAR(RtRSqrt(x), ex, ex * Real(2.8e-7));
+    }
+
+    // The bound also holds at the bottom of the normal float range.
+    for (float x = FLT_MIN; x < 2 * FLT_MIN; x = std::nextafter(x, 1.f))
+    {
+        const double ex = 1 / std::sqrt((double)x);
+        EXPECT_NEAR(rsqrtFast<float>(x), ex, ex * 2.8e-7);
+    }
+
+    Vec3 v(3, 4, 12);
+    v.normalize();
+    EXPECT_NEAR(v.length(), 1, 1e-6);
+    EXPECT_VEC3_NEAR(v, Vec3(3, 4, 12) / 13);
+}
+
+GTEST_TEST(Math, Dispatch_001)
+{
+    Rand::init();
+    EXPECT_TRUE(Dispatch::available(KL_BASE));
+    EXPECT_TRUE(Dispatch::available(Dispatch::best()));
+    EXPECT_EQ(Dispatch::level(), Dispatch::best());
+
+    constexpr size_t Size = 2 * Steps + 1;
+
+    Vec3Stream a, b;
+    Color      colors[Size];
+    for (size_t i = 0; i < Size; ++i)
+    {
+        a.push({Rand::unit(), Rand::unit(), Rand::unit()});
+        b.push({Rand::unit(), Rand::unit(), Rand::unit()});
+        colors[i] = {Rand::real(), Rand::real(), Rand::real(), Rand::real()};
+    }
+
+    const auto check = [&](const KernelLevel lv)
+    {
+        EXPECT_EQ(Dispatch::level(), lv);
+
+        Vec3Stream cross, norm;
+        Vec3Stream::cross(cross, a, b);
+        Vec3Stream::normalize(norm, a);
+
+        U32   packed[Size];
+        Color unpacked[Size];
+        ColorUtils::convert(packed, colors, Size);
+        ColorUtils::convert(unpacked, packed, Size);
+
+        for (size_t i = 0; i < Size; ++i)
+        {
+            EXPECT_VEC3_NEAR(cross.at(i), a.at(i).cross(b.at(i)));
+            EXPECT_VEC3_NEAR(norm.at(i), a.at(i).normalized());
+            EXPECT_EQ(packed[i], colors[i].toInt());
+            const Color expected(packed[i]);
+            EXPECT_REAL_EQ(unpacked[i].r, expected.r);
+            EXPECT_REAL_EQ(unpacked[i].g, expected.g);
+            EXPECT_REAL_EQ(unpacked[i].b, expected.b);
+            EXPECT_REAL_EQ(unpacked[i].a, expected.a);
+        }
+    };
+    forEachKernelLevel(check);
+
+    EXPECT_FALSE(Dispatch::select(KL_MAX));
+    EXPECT_EQ(Dispatch::level(), Dispatch::best());
+}
+
+GTEST_TEST(Math, Constexpr_001)
+{
+    static_assert(Vec3::UnitX.cross(Vec3::UnitY) == Vec3::UnitZ);
+    static_assert(Vec4::Unit != Vec4::Zero);
+    static_assert(Mat3::Identity * Vec3(1, 2, 3) == Vec3(1, 2, 3));
+    static_assert(Quat::Identity * Quat::Identity == Quat::Identity);
+
+    constexpr Mat4 tr = [] {
+        Mat4 r;
+        r.makeTransform({1, 2, 3}, Vec3::Unit, Mat3::Identity);
+        return r;
+    }();
+    static_assert(tr.getTrans() == Vec3(1, 2, 3));
+    static_assert(eq(tr.det(), 1) && tr.inverted().det() == tr.det());
+    static_assert(tr.col(3) == Vec4(0, 0, 0, 1) && tr.row(3) == Vec4(1, 2, 3, 1));
+
+#ifdef Math_HAS_CONSTANT_EVALUATED
+    constexpr Mat3 rz = [] {
+        Mat3 r;
+        r.makeRotZ(PiH);
+        return r;
+    }();
+    static_assert(rz * Vec3::UnitX == Vec3::UnitY);
+
+    constexpr Quat q(Real(0.25), Real(-0.5), Real(1.0));
+    static_assert(eq(q.length(), 1, Real(1e-6)));
+    static_assert(eq(Vec3(3, 4, 12).length(), 13, Real(1e-5)));
+
+    Quat rq;
+    rq.makeRotXyz(Real(0.25), Real(-0.5), Real(1.0));
+    EXPECT_NEAR(q.w, rq.w, 1e-6);
+    EXPECT_NEAR(q.x, rq.x, 1e-6);
+    EXPECT_NEAR(q.y, rq.y, 1e-6);
+    EXPECT_NEAR(q.z, rq.z, 1e-6);
+
+    for (Real a = -20; a < 20; a += Real(0.37))
+    {
+        EXPECT_NEAR(Const::sin(a), RtSin(a), 1e-6);
+        EXPECT_NEAR(Const::cos(a), RtCos(a), 1e-6);
+    }
+    for (Real x = Real(1e-6); x < Real(1e6); x *= Real(1.37))
+        EXPECT_NEAR(Const::sqrt(x), RtSqrt(x), RtSqrt(x) * Real(1e-7));
+#endif
+}
+
+GTEST_TEST(Math, Precision_001)
+{
+    Rand::init();
+
+    constexpr size_t Size = 2 * Steps + 3;
+
+    Vec3d world[Size];
+    Vec3f local[Size];
+    Vec3d back[Size];
+    for (Vec3d& v : world)
+        v = {1e6 + Rand::unit(), -1e6 * Rand::unit(), Rand::unit()};
+
+    Precision::convert(local, world, Size);
+    Precision::convert(back, local, Size);
+    for (size_t i = 0; i < Size; ++i)
+    {
+        EXPECT_EQ(local[i].x, float(world[i].x));
+        EXPECT_EQ(local[i].y, float(world[i].y));
+        EXPECT_EQ(local[i].z, float(world[i].z));
+        EXPECT_EQ(back[i].x, double(local[i].x));
+        EXPECT_EQ(back[i].z, double(local[i].z));
+    }
+
+    Mat4d md[3];
+    Mat4f mf[3];
+    for (Mat4d& m : md)
+        m.makeTransform({1e5, 2, 3}, Vec3d(2, 2, 2), Quatd(0.1, 0.2, 0.3));
+    Precision::convert(mf, md, 3);
+    EXPECT_EQ(mf[2].m[0][3], 1e5f);
+    EXPECT_EQ(Mat4f(md[1]).m[1][2], mf[1].m[1][2]);
+
+    Mat3f rz;
+    rz.makeRotZ(PiH);
+    Vec3f v = rz * Vec3f::UnitX;
+    EXPECT_NEAR(v.y, 1, 1e-6);
+    v = Vec3f(3, 4, 12).normalized();
+    EXPECT_NEAR(v.length(), 1, 1e-6);
+
+    const Box3df box(Vec3f(2, 2, 2), Vec3f::Zero);
+    EXPECT_TRUE(box.hit(Ray({-5, -5, -5}, Vec3::Unit), {0, 100}));
+    EXPECT_FALSE(box.hit(Ray({-5, 5, -5}, Vec3::Unit), {0, 100}));
+}
+
+GTEST_TEST(Math, Packed_001)
+{
+    EXPECT_EQ(Float16::encode(1), 0x3C00);
+    EXPECT_EQ(Float16::encode(-2), 0xC000);
+    EXPECT_EQ(Float16::encode(65504), 0x7BFF);
+    EXPECT_EQ(Float16::encode(65520), 0x7C00);
+    EXPECT_EQ(Float16::encode(Real(5.9604644775390625e-08)), 0x0001);
+    EXPECT_EQ(Float16::encode(Real(1e-9)), 0x0000);
+    EXPECT_EQ(Float16::decode(0x3555), Real(0.333251953125));
+    EXPECT_EQ(Float16::decode(0x8001), Real(-5.9604644775390625e-08));
+    EXPECT_EQ(Float16::decode(0x7C00), std::numeric_limits<Real>::infinity());
+
+    EXPECT_EQ(Snorm16::encode(1), 32767);
+    EXPECT_EQ(Snorm16::encode(-3), -32767);
+    EXPECT_EQ(Snorm16::encode(Real(0.5)), 16384);
+    EXPECT_EQ(Snorm16::encode(Real(-0.5)), -16384);
+    EXPECT_EQ(Snorm16::decode(-32768), -1);
+    EXPECT_EQ(Snorm16::decode(32767), 1);
+
+    static_assert(sizeof(Vec3h) == 6 && sizeof(Vec4sn16) == 8);
+
+    const Vec3 p(Real(12.75), Real(-0.1), Real(1000.3));
+    const Vec3 q = Vec3h(p).unpack();
+    EXPECT_NEAR(q.x, p.x, Abs(p.x) / 1024);
+    EXPECT_NEAR(q.y, p.y, Abs(p.y) / 1024);
+    EXPECT_NEAR(q.z, p.z, Abs(p.z) / 1024);
+
+    Rand::init();
+    constexpr size_t Size = 2 * Steps + 1;
+
+    Vec3 points[Size], normals[Size];
+    for (size_t i = 0; i < Size; ++i)
+    {
+        points[i]  = Vec3(Rand::unit(), Rand::unit(), Rand::unit()) * Real(1000);
+        normals[i] = Vec3(Rand::unit(), Rand::unit(), Rand::unit()).normalized();
+    }
+
+    const auto check = [&](KernelLevel)
+    {
+        Vec3h    ph[Size];
+        Vec3sn16 ns[Size];
+        Vec3     pu[Size], nu[Size];
+        Precision::convert(ph, points, Size);
+        Precision::convert(ns, normals, Size);
+        Precision::convert(pu, ph, Size);
+        Precision::convert(nu, ns, Size);
+
+        for (size_t i = 0; i < Size; ++i)
+        {
+            const Vec3h    eh(points[i]);
+            const Vec3sn16 es(normals[i]);
+            EXPECT_EQ(ph[i].x, eh.x);
+            EXPECT_EQ(ph[i].y, eh.y);
+            EXPECT_EQ(ph[i].z, eh.z);
+            EXPECT_EQ(ns[i].x, es.x);
+            EXPECT_EQ(ns[i].y, es.y);
+            EXPECT_EQ(ns[i].z, es.z);
+            EXPECT_EQ(pu[i], eh.unpack());
+            EXPECT_EQ(nu[i], es.unpack());
+            EXPECT_NEAR(nu[i].x, normals[i].x, 1.0 / 32767);
+            EXPECT_NEAR(nu[i].y, normals[i].y, 1.0 / 32767);
+            EXPECT_NEAR(nu[i].z, normals[i].z, 1.0 / 32767);
+        }
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Matrix4_multiply)
+{
+    const auto reference = [](const Mat4& a, const Mat4& b)
+    {
+        Mat4 r;
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                for (int k = 0; k < 4; ++k)
+                    r.m[i][j] += a.m[i][k] * b.m[k][j];
+        return r;
+    };
+
+    const auto expectNear = [](const Mat4& a, const Mat4& b)
+    {
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                EXPECT_NEAR(a.m[i][j], b.m[i][j], 1e-4 * (1 + Abs(b.m[i][j])));
+    };
+
+    Rand::init();
+    constexpr size_t Size = 2 * Steps + 1;
+
+    Mat4    a[Size], b[Size];
+    int32_t parent[Size];
+    for (size_t i = 0; i < Size; ++i)
+    {
+        a[i].makeTransform({Rand::unit(), Rand::unit(), Rand::unit()},
+                           {1 + Rand::real(), 1 + Rand::real(), 1 + Rand::real()},
+                           Quat(Rand::unit(), Rand::unit(), Rand::unit()));
+        b[i].makeTransform({Rand::unit(), Rand::unit(), Rand::unit()},
+                           Vec3::Unit,
+                           Quat(Rand::unit(), Rand::unit(), Rand::unit()));
+        parent[i] = i == 0 ? -1 : Rand::range(-1, (I32)i - 1);
+    }
+
+    Mat4 r = a[0];
+    r.mulAssign(r, b[0]);
+    expectNear(r, reference(a[0], b[0]));
+    Mat4::merge(r, a[1], r);
+    expectNear(r, reference(a[1], reference(a[0], b[0])));
+
+    const auto check = [&](KernelLevel)
+    {
+        Mat4 d[Size], world[Size];
+        Mat4::multiplyArrays(d, a, b, Size);
+        Mat4::multiplyHierarchy(world, b, parent, Size);
+
+        for (size_t i = 0; i < Size; ++i)
+        {
+            expectNear(d[i], reference(a[i], b[i]));
+            expectNear(world[i], parent[i] < 0 ? b[i] : reference(world[parent[i]], b[i]));
+        }
+
+        Mat4::multiplyArrays(d, d, b, Size);
+        for (size_t i = 0; i < Size; ++i)
+            expectNear(d[i], reference(reference(a[i], b[i]), b[i]));
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Affine3_001)
+{
+    static_assert(Affine3::Identity * Affine3::Identity == Affine3::Identity);
+
+    const auto expectNear = [](const Affine3& a, const Affine3& b)
+    {
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 4; ++j)
+                EXPECT_NEAR(a.m[i][j], b.m[i][j], 1e-4 * (1 + Abs(b.m[i][j])));
+    };
+
+    Rand::init();
+    constexpr size_t Size = 2 * Steps + 1;
+
+    Affine3 a[Size], b[Size];
+    Mat4    a4[Size], b4[Size];
+    int32_t parent[Size];
+    for (size_t i = 0; i < Size; ++i)
+    {
+        const Vec3 loc(Rand::unit(), Rand::unit(), Rand::unit());
+        const Vec3 scale(1 + Rand::real(), 1 + Rand::real(), 1 + Rand::real());
+        const Quat rot(Rand::unit(), Rand::unit(), Rand::unit());
+
+        a[i].makeTransform(loc, scale, rot);
+        a4[i].makeTransform(loc, scale, rot);
+        b[i].makeTransform(loc * 2, Vec3::Unit, rot.inverse());
+        b4[i] = b[i].toMat4();
+
+        parent[i] = i == 0 ? -1 : Rand::range(-1, (I32)i - 1);
+    }
+
+    for (size_t i = 0; i < Size; ++i)
+    {
+        expectNear(a[i], Affine3(a4[i]));
+        expectNear(a[i] * b[i], Affine3(a4[i] * b4[i]));
+        expectNear(a[i] * a[i].inverted(), Affine3::Identity);
+        expectNear(a[i].inverted() * a[i], Affine3::Identity);
+        expectNear(b[i].invertedRigid(), b[i].inverted());
+
+        const Vec3 p(Rand::unit(), Rand::unit(), Rand::unit());
+        const Vec3 q = a[i].inverted().transformPoint(a[i].transformPoint(p));
+        EXPECT_VEC3_NEAR(q, p);
+        EXPECT_VEC3_NEAR(a[i].transformDirection(p), a[i].linear() * p);
+    }
+
+    const auto check = [&](KernelLevel)
+    {
+        Affine3 d[Size], world[Size];
+        Affine3::multiplyArrays(d, a, b, Size);
+        Affine3::multiplyHierarchy(world, b, parent, Size);
+
+        for (size_t i = 0; i < Size; ++i)
+        {
+            expectNear(d[i], Affine3(a4[i] * b4[i]));
+            expectNear(world[i], parent[i] < 0 ? b[i] : world[parent[i]] * b[i]);
+        }
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Transform_001)
+{
+    struct Vertex
+    {
+        Vec3 position;
+        Real u, v;
+    };
+
+    Rand::init();
+    constexpr size_t Size = 2 * Steps + 1;
+
+    Mat4 m;
+    m.makeTransform({1, 2, 3}, {2, 3, 4}, Quat(Real(0.3), Real(0.2), Real(0.1)));
+    Mat4 p = m;
+    p.m[3][0] = Real(0.01);
+    p.m[3][2] = Real(0.2);
+    p.m[3][3] = 2;
+
+    Mat3 r;
+    r.fromQuaternion(Quat(Real(0.1), Real(0.2), Real(0.3)));
+    const Quat q(Real(0.4), Real(-0.5), Real(0.6));
+
+    Vec3   src[Size];
+    Vertex vertices[Size];
+    for (size_t i = 0; i < Size; ++i)
+    {
+        src[i]      = {Rand::unit(), Rand::unit(), Rand::unit()};
+        vertices[i] = {src[i], Real(i), -Real(i)};
+    }
+
+    EXPECT_VEC3_NEAR(m.transformPoint(src[0]), Affine3(m).transformPoint(src[0]));
+    EXPECT_VEC3_NEAR(r.transform(src[0]), r * src[0]);
+
+    const auto check = [&](KernelLevel)
+    {
+        Vec3 points[Size], directions[Size], projected[Size], linear[Size], rotated[Size];
+        m.transformPoints(points, src, Size);
+        m.transformDirections(directions, src, Size);
+        p.transformPointsProjective(projected, src, Size);
+        r.transformDirections(linear, src, Size);
+        q.transformPoints(rotated, src, Size);
+
+        Vertex inPlace[Size];
+        std::copy_n(vertices, Size, inPlace);
+        m.transformPoints(&inPlace[0].position.x, sizeof(Vertex), &inPlace[0].position.x, sizeof(Vertex), Size);
+
+        for (size_t i = 0; i < Size; ++i)
+        {
+            EXPECT_VEC3_NEAR(points[i], m.transformPoint(src[i]));
+            EXPECT_VEC3_NEAR(directions[i], m.transformDirection(src[i]));
+            EXPECT_VEC3_NEAR(projected[i], p.transformPointProjective(src[i]));
+            EXPECT_VEC3_NEAR(linear[i], r.transform(src[i]));
+            EXPECT_VEC3_NEAR(rotated[i], q * src[i]);
+            EXPECT_VEC3_NEAR(inPlace[i].position, points[i]);
+            EXPECT_EQ(inPlace[i].u, Real(i));
+            EXPECT_EQ(inPlace[i].v, -Real(i));
+        }
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Matrix4_compose)
+{
+    const auto expectNear = [](const auto& a, const auto& b, const int rows)
+    {
+        for (int i = 0; i < rows; ++i)
+            for (int j = 0; j < 4; ++j)
+                EXPECT_NEAR(a.m[i][j], b.m[i][j], 1e-4 * (1 + Abs(b.m[i][j])));
+    };
+
+    Rand::init();
+    constexpr size_t Size = 2 * Steps + 1;
+
+    Vec3 loc[Size], scale[Size];
+    Quat rot[Size];
+    for (size_t i = 0; i < Size; ++i)
+    {
+        loc[i]   = {Rand::unit(), Rand::unit(), Rand::unit()};
+        scale[i] = {1 + Rand::real(), 1 + Rand::real(), 1 + Rand::real()};
+        rot[i]   = Quat(Rand::unit(), Rand::unit(), Rand::unit());
+    }
+
+    // makeInverseTransform relies on the reciprocal form.
+    EXPECT_EQ(Real(1) / Vec3(2, 4, 8), Vec3(Real(0.5), Real(0.25), Real(0.125)));
+
+    const auto check = [&](KernelLevel)
+    {
+        Mat4    d[Size], di[Size];
+        Affine3 da[Size];
+        Mat4::makeTransforms(d, loc, scale, rot, Size);
+        Mat4::makeInverseTransforms(di, loc, scale, rot, Size);
+        Affine3::makeTransforms(da, loc, scale, rot, Size);
+
+        for (size_t i = 0; i < Size; ++i)
+        {
+            Mat4    m, mi;
+            Affine3 a;
+            m.makeTransform(loc[i], scale[i], rot[i]);
+            mi.makeInverseTransform(loc[i], scale[i], rot[i]);
+            a.makeTransform(loc[i], scale[i], rot[i]);
+
+            expectNear(d[i], m, 4);
+            expectNear(di[i], mi, 4);
+            expectNear(da[i], a, 3);
+            expectNear(m * mi, Mat4::Identity, 4);
+            expectNear(mi * m, Mat4::Identity, 4);
+        }
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Matrix4_inverse)
+{
+    const auto expectNear = [](const Mat4& a, const Mat4& b)
+    {
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                EXPECT_NEAR(a.m[i][j], b.m[i][j], 1e-4 * (1 + Abs(b.m[i][j])));
+    };
+
+    Rand::init();
+    constexpr size_t Size = 2 * Steps + 1;
+
+    Mat4       a[Size];
+    MatrixKind kind[Size];
+    for (size_t i = 0; i < Size; ++i)
+    {
+        const Vec3 loc(Rand::unit(), Rand::unit(), Rand::unit());
+        const Quat rot(Rand::unit(), Rand::unit(), Rand::unit());
+
+        kind[i] = (MatrixKind)(i % 3);
+        a[i].makeTransform(loc, kind[i] == MK_RIGID ? Vec3::Unit : Vec3(1 + Rand::real(), 2, 1 + Rand::real()), rot);
+        if (kind[i] == MK_GENERAL)
+        {
+            a[i].m[3][0] = Real(0.5) * Rand::unit();
+            a[i].m[3][2] = Real(0.5) * Rand::unit();
+            a[i].m[3][3] = 2;
+        }
+    }
+
+    // Singular rows go to identity, as before.
+    a[Size - 1]         = Mat4::Zero;
+    kind[Size - 1]      = MK_GENERAL;
+    a[Size - 1].m[0][0] = 1;
+
+    for (size_t i = 0; i < Size - 1; ++i)
+    {
+        EXPECT_EQ(a[i].classify(), kind[i]);
+        expectNear(a[i] * a[i].inverted(), Mat4::Identity);
+        expectNear(a[i].inverted(kind[i]), a[i].inverted());
+        EXPECT_NEAR(a[i].det() * a[i].inverted().det(), 1, 1e-4);
+    }
+    expectNear(a[Size - 1].inverted(), Mat4::Identity);
+
+    const auto check = [&](KernelLevel)
+    {
+        Mat4 d[Size], rigid[Size / 3];
+        Real det[Size];
+        Mat4::invertArrays(d, a, Size);
+        Mat4::determinants(det, a, Size);
+
+        for (size_t i = 0; i < Size; ++i)
+        {
+            expectNear(d[i], a[i].inverted());
+            EXPECT_NEAR(det[i], a[i].det(), 1e-4 * (1 + Abs(a[i].det())));
+        }
+
+        // In place, for the rigid ones only.
+        for (size_t i = 0; i < Size / 3; ++i)
+            rigid[i] = a[3 * i + 2];
+        Mat4::invertArrays(rigid, rigid, Size / 3, MK_RIGID);
+        for (size_t i = 0; i < Size / 3; ++i)
+            expectNear(rigid[i], a[3 * i + 2].inverted());
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Frustum_001)
+{
+    Mat4 proj, ortho, reverse;
+    proj.makePerspective(Pi * Half, 2, 1, 100);
+    ortho.makeOrthographic(-4, 4, -2, 2, 1, 100);
+    reverse.makeInfiniteReverseZ(Pi * Half, 2, 1);
+
+    EXPECT_NEAR(proj.transformPointProjective({0, 0, -1}).z, 0, 1e-5);
+    EXPECT_NEAR(proj.transformPointProjective({0, 0, -100}).z, 1, 1e-5);
+    EXPECT_NEAR(proj.transformPointProjective({2, 1, -1}).x, 1, 1e-5);
+    EXPECT_NEAR(ortho.transformPoint({4, -2, -100}).x, 1, 1e-5);
+    EXPECT_NEAR(ortho.transformPoint({4, -2, -100}).y, -1, 1e-5);
+    EXPECT_NEAR(ortho.transformPoint({4, -2, -100}).z, 1, 1e-5);
+    EXPECT_NEAR(reverse.transformPointProjective({0, 0, -1}).z, 1, 1e-5);
+    EXPECT_NEAR(reverse.transformPointProjective({0, 0, -1e6}).z, 0, 1e-5);
+
+    // Looking down -z from (0, 0, 10).
+    Mat4 view;
+    view.makeTransform({0, 0, -10}, Vec3::Unit, Quat::Identity);
+
+    const Frustum fp(proj * view), fo(ortho * view), fr(reverse * view);
+    EXPECT_TRUE(fp.contains({0, 0, 0}));
+    EXPECT_TRUE(fp.contains({-39, 19, -10}));
+    EXPECT_FALSE(fp.contains({0, 0, 10}));
+    EXPECT_FALSE(fp.contains({0, 0, -100}));
+    EXPECT_FALSE(fp.contains({41, 0, -10}));
+    EXPECT_TRUE(fr.contains({0, 0, -1e6}));
+    EXPECT_FALSE(fr.contains({0, 0, 10}));
+    EXPECT_TRUE(fo.contains({Real(3.9), 0, -80}));
+    EXPECT_FALSE(fo.contains({Real(4.1), 0, -80}));
+    EXPECT_NEAR(fp.distance(FP_NEAR, {0, 0, 0}), 9, 1e-4);
+    EXPECT_NEAR(fp.plane(FP_NEAR).n.z, -1, 1e-5);
+    EXPECT_NEAR(fp.plane(FP_NEAR).p0.z, 9, 1e-4);
+    EXPECT_NEAR(fp.plane(FP_FAR).n.z, 1, 1e-5);
+    EXPECT_NEAR(fr.distance(FP_NEAR, {0, 0, 0}), 9, 1e-4);
+    EXPECT_NEAR(fr.plane(FP_NEAR).n.z, -1, 1e-5);
+    EXPECT_EQ(fr.planes[FP_FAR][3], 1);
+    EXPECT_NEAR(fo.distance(FP_NEAR, {0, 0, 0}), 9, 1e-4);
+
+    EXPECT_TRUE(fp.intersects(Box3d(Vec3(4, 4, 4), Vec3(0, 0, 10))));
+    EXPECT_FALSE(fp.intersects(Box3d(Vec3(1, 1, 1), Vec3(0, 0, 10))));
+    EXPECT_TRUE(fp.intersects(Sphere({0, 0, 10}, 2)));
+    EXPECT_FALSE(fp.intersects(Sphere({0, 0, 10}, Real(0.5))));
+
+    Rand::init();
+    constexpr size_t Size = 4 * Steps + 5;
+
+    Box3d  boxes[Size];
+    Sphere spheres[Size];
+    for (size_t i = 0; i < Size; ++i)
+    {
+        const Vec3 c(40 * Rand::unit(), 40 * Rand::unit(), -60 * Rand::real() + 10);
+        boxes[i]   = Box3d(Vec3(1 + Rand::real(), 1 + Rand::real(), 1 + Rand::real()), c);
+        spheres[i] = Sphere(c, 1 + Rand::real());
+    }
+
+    const auto check = [&](KernelLevel)
+    {
+        for (const Frustum* f : {&fp, &fo, &fr})
+        {
+            uint32_t vb[(Size + 31) / 32], vs[(Size + 31) / 32];
+            std::fill_n(vb, (Size + 31) / 32, 0xFFFFFFFF);
+            std::fill_n(vs, (Size + 31) / 32, 0xFFFFFFFF);
+            f->cull(vb, boxes, Size);
+            f->cull(vs, spheres, Size);
+
+            for (size_t i = 0; i < Size; ++i)
+            {
+                EXPECT_EQ((vb[i / 32] >> (i % 32) & 1) != 0, f->intersects(boxes[i]));
+                EXPECT_EQ((vs[i / 32] >> (i % 32) & 1) != 0, f->intersects(spheres[i]));
+            }
+            EXPECT_EQ(vb[Size / 32] >> (Size % 32), 0u);
+        }
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Hierarchy_001)
+{
+    const auto expectNear = [](const Mat4& a, const Mat4& b)
+    {
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                EXPECT_NEAR(a.m[i][j], b.m[i][j], 1e-4 * (1 + Abs(b.m[i][j])));
+    };
+
+    const auto expectWorld = [&](const Hierarchy& h)
+    {
+        for (size_t i = 0; i < h.size(); ++i)
+        {
+            const int32_t p = h.parent(i);
+            EXPECT_FALSE(h.dirty(i));
+            expectNear(h.world(i), p < 0 ? h.local(i) : h.world(p) * h.local(i));
+        }
+    };
+
+    Rand::init();
+
+    // Large enough for update(workers) to use every thread.
+    constexpr size_t Size = 8192;
+
+    Hierarchy h;
+    h.reserve(Size);
+    EXPECT_EQ(h.add(0), Hierarchy::None);
+    for (size_t i = 0; i < Size; ++i)
+    {
+        const int32_t p = i < 4 ? Hierarchy::None : Rand::range(0, (I32)i - 1);
+        EXPECT_EQ(h.add(p), (int32_t)i);
+        h.setLocal(i,
+                   {Rand::unit(), Rand::unit(), Rand::unit()},
+                   {1 + Rand::real(), 1, 1 + Rand::real()},
+                   Quat(Rand::unit(), Rand::unit(), Rand::unit()));
+    }
+    EXPECT_GT(h.levels(), (size_t)2);
+
+    h.update();
+    expectWorld(h);
+
+    // Moving one node only touches its subtree.
+    const Mat4 before = h.world(0);
+    h.setLocal(Size / 2, {1, 2, 3}, Vec3::Unit, Quat(Real(0.1), Real(0.2), Real(0.3)));
+    h.update();
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            EXPECT_EQ(h.world(0).m[i][j], before.m[i][j]);
+    expectWorld(h);
+
+    for (unsigned workers = 1; workers <= 4; ++workers)
+    {
+        for (size_t i = 0; i < Size; i += 7)
+            h.setLocal(i, {Rand::unit(), Rand::unit(), Rand::unit()}, Vec3::Unit, Quat(Rand::unit(), 0, 0));
+        h.update(workers);
+        expectWorld(h);
+    }
+
+    h.invalidate();
+    h.update(4);
+    expectWorld(h);
+
+    h.clear();
+    EXPECT_EQ(h.size(), (size_t)0);
+    EXPECT_EQ(h.levels(), (size_t)0);
+    h.update(4);
+}
+
+GTEST_TEST(Math, Skinning_001)
+{
+    Rand::init();
+
+    // A dual quaternion applies the same rigid transform as the matrix.
+    const Quat rot(Real(0.3), Real(-1.1), Real(0.7));
+    const Vec3 loc(1, -2, 3);
+
+    Mat4 m;
+    m.makeTransform(loc, Vec3::Unit, rot);
+    const DualQuat dq(rot, loc);
+    for (const Vec3& p : {Vec3(0, 0, 0), Vec3(1, 2, 3), Vec3(-4, 5, Real(0.5))})
+    {
+        const Vec3 a = dq.transformPoint(p), b = m.transformPoint(p);
+        EXPECT_NEAR(a.x, b.x, 1e-5);
+        EXPECT_NEAR(a.y, b.y, 1e-5);
+        EXPECT_NEAR(a.z, b.z, 1e-5);
+
+        const Vec3 c = (dq * dq.conjugate()).transformPoint(p);
+        EXPECT_NEAR(c.x, p.x, 1e-5);
+        EXPECT_NEAR(c.y, p.y, 1e-5);
+        EXPECT_NEAR(c.z, p.z, 1e-5);
+    }
+
+    constexpr size_t Joints = 24, Size = 4099;
+
+    Mat4     mats[Joints];
+    Affine3  affs[Joints];
+    DualQuat dqs[Joints];
+    for (size_t j = 0; j < Joints; ++j)
+    {
+        const Quat q(Rand::unit() * Pi, Rand::unit() * Pi, Rand::unit() * Pi);
+        const Vec3 t(10 * Rand::unit(), 10 * Rand::unit(), 10 * Rand::unit());
+
+        mats[j].makeTransform(t, Vec3::Unit, q);
+        affs[j] = Affine3(mats[j]);
+        // Some joints sit in the opposite hemisphere.
+        dqs[j] = DualQuat(j % 3 ? q : Quat(-q.w, -q.x, -q.y, -q.z), t);
+    }
+
+    Vec3Stream  positions, normals;
+    uint16_t    joints[4 * Size];
+    Real        weights[4 * Size];
+    for (size_t i = 0; i < Size; ++i)
+    {
+        positions.push({Rand::unit(), Rand::unit(), Rand::unit()});
+        normals.push(Vec3(Rand::unit(), Rand::unit(), 1).normalized());
+
+        Real sum = 0;
+        for (int k = 0; k < 4; ++k)
+        {
+            joints[4 * i + k]  = (uint16_t)Rand::range(0, (I32)Joints - 1);
+            weights[4 * i + k] = k < 3 ? Rand::real() : 0;
+            sum += weights[4 * i + k];
+        }
+        for (int k = 0; k < 4; ++k)
+            weights[4 * i + k] = sum > 0 ? weights[4 * i + k] / sum : Real(k == 0);
+    }
+    const SkinInfluences inf{joints, weights};
+
+    const auto expectNear = [](const Vec3& a, const Vec3& b)
+    {
+        EXPECT_NEAR(a.x, b.x, 1e-4 * (1 + Abs(b.x)));
+        EXPECT_NEAR(a.y, b.y, 1e-4 * (1 + Abs(b.y)));
+        EXPECT_NEAR(a.z, b.z, 1e-4 * (1 + Abs(b.z)));
+    };
+
+    const auto check = [&](KernelLevel)
+    {
+        for (unsigned workers : {1u, 3u})
+        {
+            Vec3Stream lp, ln, ap, dp, dn;
+            Skinning::linear(lp, &ln, positions, &normals, inf, mats, workers);
+            Skinning::linear(ap, nullptr, positions, nullptr, inf, affs, workers);
+            Skinning::dualQuat(dp, &dn, positions, &normals, inf, dqs, workers);
+
+            ASSERT_EQ(lp.size(), Size);
+            ASSERT_EQ(dn.size(), Size);
+            for (size_t i = 0; i < Size; ++i)
+            {
+                const Vec3 p = positions.at(i), n = normals.at(i);
+
+                Mat4     ml;
+                DualQuat bd;
+                bd.real = Quat::Zero;
+                for (int k = 0; k < 4; ++k)
+                {
+                    const size_t j = joints[4 * i + k];
+                    const Real   w = weights[4 * i + k];
+                    for (int r = 0; r < 3; ++r)
+                        for (int c = 0; c < 4; ++c)
+                            ml.m[r][c] += mats[j].m[r][c] * w;
+
+                    bd = bd + dqs[j] * (dqs[j].dot(dqs[joints[4 * i]]) < 0 ? -w : w);
+                }
+                bd.normalize();
+
+                expectNear(lp.at(i), ml.transformPoint(p));
+                expectNear(ln.at(i), ml.transformDirection(n).normalized());
+                expectNear(ap.at(i), ml.transformPoint(p));
+                expectNear(dp.at(i), bd.transformPoint(p));
+                expectNear(dn.at(i), bd.transformDirection(n));
+            }
+        }
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Quat_interpolate)
+{
+    // The angle of the rotation from a to b. atan2 stays accurate for
+    // small angles, where acos of the dot product does not.
+    const auto angle = [](const Quat& a, const Quat& b)
+    {
+        const Quat d = a.inverse() * b;
+        return 2 * std::atan2(Vec3(d.x, d.y, d.z).length(), Abs(d.w));
+    };
+
+    const auto expectNear = [](const Quat& a, const Quat& b, const double tol)
+    {
+        // q and -q are the same rotation.
+        const Real s = a.dot(b) < 0 ? -1 : 1;
+        EXPECT_NEAR(a.w * s, b.w, tol);
+        EXPECT_NEAR(a.x * s, b.x, tol);
+        EXPECT_NEAR(a.y * s, b.y, tol);
+        EXPECT_NEAR(a.z * s, b.z, tol);
+    };
+
+    const Quat a(Real(0.1), Real(0.2), Real(0.3));
+    const Quat b(Real(1.4), Real(-0.8), Real(2.1));
+    const Quat nb(-b.w, -b.x, -b.y, -b.z);
+
+    expectNear(a.slerp(b, 0), a, 1e-5);
+    expectNear(a.slerp(b, 1), b, 1e-5);
+    expectNear(a.nlerp(b, 1), b, 1e-5);
+    expectNear(a.fastSlerp(b, 0), a, 1e-5);
+    expectNear(a.fastSlerp(b, 1), b, 1e-5);
+
+    // The shorter arc is taken whatever the sign of b.
+    expectNear(a.slerp(nb, Real(0.3)), a.slerp(b, Real(0.3)), 1e-5);
+    expectNear(a.nlerp(nb, Real(0.3)), a.nlerp(b, Real(0.3)), 1e-5);
+    expectNear(a.fastSlerp(nb, Real(0.3)), a.fastSlerp(b, Real(0.3)), 1e-5);
+    expectNear(a.slerp(a, Real(0.3)), a, 1e-5);
+
+    // slerp moves at a constant rate, fastSlerp stays close to it.
+    const Real total = angle(a, b);
+    for (int i = 0; i <= 16; ++i)
+    {
+        const Real t = Real(i) / 16;
+        const Quat s = a.slerp(b, t);
+
+        EXPECT_NEAR(s.length(), 1, 1e-5);
+        EXPECT_NEAR(angle(a, s), t * total, 100 * Epsilon);
+        EXPECT_LT(angle(s, a.fastSlerp(b, t)), Real(1e-3));
+    }
+
+    Rand::init();
+
+    constexpr size_t Size = 1027;
+
+    QuatStream qa, qb, r;
+    RealArray  t;
+    for (size_t i = 0; i < Size; ++i)
+    {
+        qa.push(Quat(Rand::unit() * Pi, Rand::unit() * Pi, Rand::unit() * Pi));
+        // Includes nearly equal pairs, which slerp treats linearly.
+        qb.push(i % 5 ? Quat(Rand::unit() * Pi, Rand::unit() * Pi, Rand::unit() * Pi) : qa.at(i));
+        t.push_back(Rand::real());
+    }
+
+    const auto check = [&](KernelLevel)
+    {
+        QuatStream::nlerp(r, qa, qb, t);
+        ASSERT_EQ(r.size(), Size);
+        for (size_t i = 0; i < Size; ++i)
+            expectNear(r.at(i), qa.at(i).nlerp(qb.at(i), t[i]), 1e-5);
+
+        QuatStream::slerp(r, qa, qb, t);
+        for (size_t i = 0; i < Size; ++i)
+            expectNear(r.at(i), qa.at(i).slerp(qb.at(i), t[i]), 1e-5);
+
+        QuatStream::fastSlerp(r, qa, qb, t);
+        for (size_t i = 0; i < Size; ++i)
+            expectNear(r.at(i), qa.at(i).fastSlerp(qb.at(i), t[i]), 1e-5);
+
+        QuatStream::slerp(r, qa, qb, Real(0.25));
+        for (size_t i = 0; i < Size; ++i)
+            expectNear(r.at(i), qa.at(i).slerp(qb.at(i), Real(0.25)), 1e-5);
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Animation_001)
+{
+    Rand::init();
+
+    constexpr size_t Tracks = 37;
+
+    AnimationClip clip;
+
+    const Real bad[] = {0, 1, 1};
+    EXPECT_EQ(clip.addTrack(bad, bad, 3), AnimationClip::None);
+    EXPECT_EQ(clip.addTrack(bad, bad, 0), AnimationClip::None);
+
+    // Each track keeps its own times, and some have a single key.
+    std::vector<std::vector<Real>> times(Tracks);
+    std::vector<std::vector<Quat>> keys(Tracks);
+    for (size_t i = 0; i < Tracks; ++i)
+    {
+        const size_t n = i % 7 == 0 ? 1 : 2 + Rand::range(0, 20);
+
+        Real t = Rand::real();
+        for (size_t k = 0; k < n; ++k)
+        {
+            times[i].push_back(t);
+            keys[i].emplace_back(Rand::unit() * Pi, Rand::unit() * Pi, Rand::unit() * Pi);
+            t += Real(0.05) + Rand::real();
+        }
+
+        std::vector<Real> reals;
+        std::vector<Vec3> vecs;
+        for (const Quat& q : keys[i])
+        {
+            reals.push_back(q.w);
+            vecs.emplace_back(q.x, q.y, q.z);
+        }
+
+        const int32_t slot = (int32_t)(i / 3);
+        switch (i % 3)
+        {
+        case 0:
+            EXPECT_EQ(clip.addTrack(times[i].data(), reals.data(), n), slot);
+            break;
+        case 1:
+            EXPECT_EQ(clip.addTrack(times[i].data(), vecs.data(), n), slot);
+            break;
+        default:
+            EXPECT_EQ(clip.addTrack(times[i].data(), keys[i].data(), n), slot);
+            break;
+        }
+    }
+    EXPECT_EQ(clip.tracks(), Tracks);
+    EXPECT_EQ(clip.tracks(TT_QUAT), Tracks / 3);
+    EXPECT_GT(clip.duration(), 1);
+
+    // Brute force reference of track i at time t.
+    const auto expectSample = [&](const AnimationState& state, const Real time)
+    {
+        for (size_t i = 0; i < Tracks; ++i)
+        {
+            const std::vector<Real>& kt = times[i];
+
+            size_t a = 0, b = 0;
+            Real   f = 0;
+            if (kt.size() > 1)
+            {
+                while (a + 2 < kt.size() && kt[a + 1] <= time)
+                    ++a;
+                b = a + 1;
+                f = Max(Real(0), Min(Real(1), (time - kt[a]) / (kt[b] - kt[a])));
+            }
+
+            const Quat& qa = keys[i][a];
+            const Quat& qb = keys[i][b];
+            const size_t slot = i / 3;
+            switch (i % 3)
+            {
+            case 0:
+                EXPECT_NEAR(state.real(slot), qa.w + (qb.w - qa.w) * f, 1e-5);
+                break;
+            case 1:
+                EXPECT_NEAR(state.vec3(slot).x, qa.x + (qb.x - qa.x) * f, 1e-5);
+                EXPECT_NEAR(state.vec3(slot).z, qa.z + (qb.z - qa.z) * f, 1e-5);
+                break;
+            default:
+            {
+                Quat q = qa.fastSlerp(qb, f);
+                if (clip.rotationBlend() == RB_NLERP)
+                    q = qa.nlerp(qb, f);
+                else if (clip.rotationBlend() == RB_SLERP)
+                    q = qa.slerp(qb, f);
+                EXPECT_NEAR(Abs(state.quat(slot).dot(q)), 1, 1e-5);
+                break;
+            }
+            }
+        }
+    };
+
+    const auto check = [&](KernelLevel)
+    {
+        for (const RotationBlend blend : {RB_NLERP, RB_SLERP, RB_FAST_SLERP})
+        {
+            clip.setRotationBlend(blend);
+
+            // Advancing time, then jumps in both directions and beyond
+            // either end.
+            AnimationState state;
+            for (Real t = -1; t < clip.duration() + 1; t += Real(0.07))
+            {
+                clip.sample(state, t);
+                expectSample(state, t);
+            }
+            for (const Real t : {Real(3), Real(0.5), Real(100), Real(-5), Real(2)})
+            {
+                clip.sample(state, t);
+                expectSample(state, t);
+            }
+        }
+
+        constexpr size_t States = 100;
+
+        std::vector<AnimationState> states(States);
+        std::vector<Real>           at(States);
+        for (unsigned workers : {1u, 4u})
+        {
+            for (int frame = 0; frame < 3; ++frame)
+            {
+                for (size_t i = 0; i < States; ++i)
+                    at[i] = Real(i) / States * clip.duration() + Real(frame) / 10;
+
+                clip.sample(states.data(), at.data(), States, workers);
+                for (size_t i = 0; i < States; ++i)
+                    expectSample(states[i], at[i]);
+            }
+        }
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Packed_quat)
+{
+    static_assert(sizeof(PackedQuat32) == 4 && sizeof(PackedQuat48) == 6);
+
+    // From the chord between the two, acos loses the small angles
+    // in float.
+    const auto angle = [](const Quat& a, const Quat& b)
+    {
+        const Real s = a.dot(b) < 0 ? -1 : 1;
+        return 4 * std::asin(Min((a - b * s).length() / 2, 1));
+    };
+
+    EXPECT_NEAR(PackedQuat32(Quat::Identity).unpack().w, 1, 1e-5);
+    EXPECT_NEAR(PackedQuat48(Quat(0, 0, 0, -1)).unpack().z, 1, 1e-5);
+    EXPECT_EQ(PackedQuat32(Quat::Identity).v >> 30, 0u);
+    EXPECT_EQ(PackedQuat32(Quat(0, 0, 1, 0)).v >> 30, 2u);
+
+    Rand::init();
+    constexpr size_t Size = 1029;
+
+    Quat src[Size];
+    for (size_t i = 0; i < Size; ++i)
+        src[i] = Quat(Rand::unit() * Pi, Rand::unit() * Pi, Rand::unit() * Pi);
+    src[0] = Quat(Real(0.5), Real(-0.5), Real(0.5), Real(-0.5));
+
+    const auto check = [&](KernelLevel)
+    {
+        PackedQuat32 p32[Size];
+        PackedQuat48 p48[Size];
+        Quat         d32[Size], d48[Size];
+        Precision::convert(p32, src, Size);
+        Precision::convert(p48, src, Size);
+        Precision::convert(d32, p32, Size);
+        Precision::convert(d48, p48, Size);
+
+        for (size_t i = 0; i < Size; ++i)
+        {
+            EXPECT_LT(angle(d32[i], src[i]), 4.4e-3);
+            EXPECT_LT(angle(d48[i], src[i]), 1.4e-4);
+            EXPECT_NEAR(d32[i].length(), 1, 1e-5);
+
+            // The batch forms agree with the scalar ones to within a
+            // rounding of one quantization step.
+            EXPECT_LT(angle(d32[i], PackedQuat32(src[i]).unpack()), 3e-3);
+            EXPECT_LT(angle(d48[i], PackedQuat48(src[i]).unpack()), 1e-4);
+            EXPECT_LT(angle(d32[i], p32[i].unpack()), 1e-5);
+            EXPECT_LT(angle(d48[i], p48[i].unpack()), 1e-5);
+        }
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, QuatStream_001)
+{
+    const auto expectNear = [](const Quat& a, const Quat& b)
+    {
+        EXPECT_NEAR(a.w, b.w, 1e-5);
+        EXPECT_NEAR(a.x, b.x, 1e-5);
+        EXPECT_NEAR(a.y, b.y, 1e-5);
+        EXPECT_NEAR(a.z, b.z, 1e-5);
+    };
+
+    const auto expectNear3 = [](const Vec3& a, const Vec3& b)
+    {
+        EXPECT_NEAR(a.x, b.x, 1e-4);
+        EXPECT_NEAR(a.y, b.y, 1e-4);
+        EXPECT_NEAR(a.z, b.z, 1e-4);
+    };
+
+    Rand::init();
+
+    constexpr size_t Size = 259, Bodies = 7;
+
+    QuatStream a, b, r;
+    Vec3Stream v, rv;
+    uint32_t   body[Size];
+    for (size_t i = 0; i < Size; ++i)
+    {
+        a.push(Quat(Rand::unit() * Pi, Rand::unit() * Pi, Rand::unit() * Pi));
+        b.push(Quat(Rand::unit(), Rand::unit(), Rand::unit(), Rand::unit()) * Real(3));
+        v.push({10 * Rand::unit(), 10 * Rand::unit(), 10 * Rand::unit()});
+        body[i] = (uint32_t)Rand::range(0, Bodies - 1);
+    }
+    b.set(3, Quat::Zero);
+
+    EXPECT_EQ(QuatStream(a).size(), Size);
+
+    const auto check = [&](KernelLevel)
+    {
+        QuatStream::mul(r, a, b);
+        ASSERT_EQ(r.size(), Size);
+        for (size_t i = 0; i < Size; ++i)
+            expectNear(r.at(i), a.at(i) * b.at(i));
+
+        QuatStream::rotate(rv, a, v);
+        ASSERT_EQ(rv.size(), Size);
+        for (size_t i = 0; i < Size; ++i)
+            expectNear3(rv.at(i), a.at(i) * v.at(i));
+
+        QuatStream::rotate(rv, a, body, v);
+        for (size_t i = 0; i < Size; ++i)
+            expectNear3(rv.at(i), a.at(body[i]) * v.at(i));
+
+        QuatStream::normalize(r, b);
+        for (size_t i = 0; i < Size; ++i)
+            expectNear(r.at(i), b.at(i).normalized());
+
+        QuatStream::conjugate(r, a);
+        for (size_t i = 0; i < Size; ++i)
+            expectNear(r.at(i), a.at(i).inverse());
+
+        // q * q^-1 is the identity whatever the length of q.
+        QuatStream::inverse(r, b);
+        expectNear(r.at(3), Quat::Zero);
+        QuatStream::mul(r, b, r);
+        for (size_t i = 0; i < Size; ++i)
+        {
+            if (i != 3)
+                expectNear(r.at(i), Quat::Identity);
+        }
+
+        r = b;
+        r.normalize();
+        for (size_t i = 0; i < Size; ++i)
+            expectNear(r.at(i), b.at(i).normalized());
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Box3d_prepared)
+{
+    Rand::init();
+
+    const Vec2 limit(0, 1000);
+
+    // Rays parallel to a slab hit when their origin is inside it.
+    const Box3d       unit(Vec3(2, 2, 2), Vec3::Zero);
+    const PreparedRay px(Ray({-5, Real(0.5), Real(-0.5)}, {1, 0, 0}));
+    const PreparedRay py(Ray({-5, 3, 0}, {1, 0, 0}));
+    EXPECT_TRUE(unit.hit(px, limit));
+    EXPECT_FALSE(unit.hit(py, limit));
+    EXPECT_TRUE(Box3df(Vec3f(2, 2, 2), Vec3f::Zero).hit(px, limit));
+
+    RayHitTest rh;
+    EXPECT_TRUE(unit.hit(rh, px, limit));
+    EXPECT_NEAR(rh.distance, 4, 1e-5);
+    EXPECT_EQ(rh.normal.x, -1);
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        const Vec3 c(10 * Rand::unit(), 10 * Rand::unit(), 10 * Rand::unit());
+        const Box3d  box(Vec3(1 + 3 * Rand::real(), 1 + 3 * Rand::real(), 1 + 3 * Rand::real()), c);
+        const Box3df boxf(Vec3f(box.extent()), Vec3f(box.center()));
+
+        // Away from zero on every axis, where both forms agree.
+        Vec3 d(Rand::unit(), Rand::unit(), Rand::unit());
+        for (Real* v = d.ptr(); v < d.ptr() + 3; ++v)
+            *v += *v < 0 ? Real(-0.05) : Real(0.05);
+
+        const Ray         ray(Vec3(10 * Rand::unit(), 10 * Rand::unit(), 10 * Rand::unit()) - d * 15, d);
+        const PreparedRay pr(ray);
+
+        EXPECT_EQ(box.hit(pr, limit), box.hit(ray, limit));
+        EXPECT_EQ(boxf.hit(pr, limit), boxf.hit(ray, limit));
+
+        Real a0, a1, b0, b1;
+        const bool h = box.hit(a0, a1, ray, limit);
+        EXPECT_EQ(box.hit(b0, b1, pr, limit), h);
+        if (h)
+        {
+            EXPECT_NEAR(a0, b0, 1e-4);
+            EXPECT_NEAR(a1, b1, 1e-4);
+        }
+
+        RayHitTest ta, tb;
+        EXPECT_EQ(box.hit(tb, pr, limit), box.hit(ta, ray, limit));
+        EXPECT_NEAR(ta.distance, tb.distance, 1e-4);
+        EXPECT_EQ(ta.normal.x, tb.normal.x);
+        EXPECT_EQ(ta.normal.y, tb.normal.y);
+        EXPECT_EQ(ta.normal.z, tb.normal.z);
+    }
+}
+
+template <typename P>
+void testRayPacket(const Box3d* boxes, const Sphere* spheres, const size_t n)
+{
+    P packet;
+    EXPECT_EQ(packet.hit(boxes[0]), 0u);
+
+    Ray  rays[P::Size];
+    Vec2 limits[P::Size];
+    for (size_t k = 0; k < P::Size; ++k)
+    {
+        // Coherent rays from near one point, some parallel to an axis,
+        // one lane left unset.
+        Vec3 d(Rand::unit(), Rand::unit(), Real(0.2) + Rand::real());
+        if (k % 5 == 1)
+            d.x = 0;
+
+        rays[k]   = Ray(Vec3(Rand::unit(), Rand::unit(), -20), d);
+        limits[k] = Vec2(k % 3 ? 0 : 15, k % 4 ? 1000 : 30);
+        if (k != 2)
+            packet.set(k, rays[k], limits[k]);
+    }
+
+    Real r0[P::Size], r1[P::Size], d[P::Size];
+    for (size_t i = 0; i < n; ++i)
+    {
+        const uint32_t mb = packet.hit(r0, r1, boxes[i]);
+        const uint32_t ms = packet.hit(d, spheres[i]);
+        EXPECT_EQ(packet.hit(boxes[i]), mb);
+        EXPECT_EQ(packet.hit(spheres[i]), ms);
+        EXPECT_EQ(mb & 4, 0u);
+        EXPECT_EQ(ms & 4, 0u);
+
+        for (size_t k = 0; k < P::Size; ++k)
+        {
+            if (k == 2)
+                continue;
+
+            Real       a0, a1;
+            RayHitTest rh;
+            const bool hb = boxes[i].hit(a0, a1, PreparedRay(rays[k]), limits[k]);
+            const bool hs = spheres[i].hit(rh, rays[k], limits[k]);
+
+            EXPECT_EQ((mb >> k & 1) != 0, hb);
+            EXPECT_EQ((ms >> k & 1) != 0, hs);
+            if (hb)
+            {
+                EXPECT_NEAR(r0[k], a0, 1e-4);
+                EXPECT_NEAR(r1[k], a1, 1e-4);
+            }
+            if (hs)
+            {
+                EXPECT_NEAR(d[k], rh.distance, 1e-4 * (1 + Abs(rh.distance)));
+            }
+        }
+    }
+}
+
+GTEST_TEST(Math, RayPacket_001)
+{
+    Rand::init();
+
+    // The corrected sphere test, the ray enters at 4 and leaves at 6.
+    const Sphere unit(Vec3(0, 0, 5), 1);
+    RayHitTest   rh;
+    EXPECT_TRUE(unit.hit(rh, Ray(Vec3::Zero, Vec3(0, 0, 1)), {0, 100}));
+    EXPECT_NEAR(rh.distance, 4, 1e-5);
+    EXPECT_TRUE(unit.hit(rh, Ray(Vec3::Zero, Vec3(0, 0, 1)), {5, 100}));
+    EXPECT_NEAR(rh.distance, 6, 1e-5);
+    EXPECT_FALSE(unit.hit(Ray(Vec3(0, Real(1.1), 0), Vec3(0, 0, 1)), {0, 100}));
+
+    constexpr size_t Size = 300;
+
+    Box3d  boxes[Size];
+    Sphere spheres[Size];
+    for (size_t i = 0; i < Size; ++i)
+    {
+        const Vec3 c(8 * Rand::unit(), 8 * Rand::unit(), 20 * Rand::real());
+        boxes[i]   = Box3d(Vec3(1 + Rand::real(), 1 + Rand::real(), 1 + Rand::real()), c);
+        spheres[i] = Sphere(c, 1 + Rand::real());
+    }
+
+    const auto check = [&](KernelLevel)
+    {
+        testRayPacket<RayPacket4>(boxes, spheres, Size);
+        testRayPacket<RayPacket8>(boxes, spheres, Size);
+        testRayPacket<RayPacket16>(boxes, spheres, Size);
+    };
+    forEachKernelLevel(check);
+}
+
+GTEST_TEST(Math, Box3dArray_001)
+{
+    Rand::init();
+
+    // Box3d::contains used to compare the x bounds against z.
+    const Box3d outer(Vec3(4, 4, 1), Vec3::Zero);
+    EXPECT_TRUE(outer.contains(Box3d(Vec3(1, 1, Real(0.5)), Vec3::Zero)));
+    EXPECT_FALSE(outer.contains(Box3d(Vec3(1, 1, 2), Vec3::Zero)));
+    EXPECT_TRUE(outer.overlaps(Box3d(Vec3::Unit, Vec3(Real(2.5), 0, 0))));
+    EXPECT_FALSE(outer.overlaps(Box3d(Vec3::Unit, Vec3(0, 0, 3))));
+
+    constexpr size_t Size  = 301;
+    constexpr size_t Words = (Size + 31) / 32;
+
+    Box3dArray boxes;
+    for (size_t i = 0; i < Size; ++i)
+    {
+        const Vec3 c(8 * Rand::unit(), 8 * Rand::unit(), 20 * Rand::real());
+        boxes.push(Box3d(Vec3(1 + Rand::real(), 1 + Rand::real(), 1 + Rand::real()), c));
+    }
+    EXPECT_EQ(boxes.size(), Size);
+
+    const Box3d queries[3] = {
+        Box3d(Vec3(2, 2, 2), Vec3(1, 1, 10)),
+        Box3d(Vec3(10, 10, 12), Vec3(0, 0, 10)),
+        Box3d(Vec3(Real(0.1), Real(0.1), Real(0.1)), Vec3(3, -3, 5)),
+    };
+
+    const auto check = [&](KernelLevel)
+    {
+        uint32_t mask[Words];
+        Real     dist[Size];
+        for (int k = 0; k < 16; ++k)
+        {
+            Vec3 d(Rand::unit(), Rand::unit(), Real(0.2) + Rand::real());
+            if (k % 5 == 1)
+                d.x = 0;
+
+            const PreparedRay ray(Ray(Vec3(Rand::unit(), Rand::unit(), -20), d));
+            const Vec2        limit(k % 3 ? 0 : 15, k % 4 ? 1000 : 30);
+
+            boxes.hit(mask, dist, ray, limit);
+            for (size_t i = 0; i < Size; ++i)
+            {
+                Real       r0, r1;
+                const bool hit = boxes.at(i).hit(r0, r1, ray, limit);
+                EXPECT_EQ((mask[i / 32] >> i % 32 & 1) != 0, hit);
+                if (hit)
+                {
+                    EXPECT_NEAR(dist[i], r0, 1e-4);
+                }
+            }
+        }
+
+        for (const Box3d& q : queries)
+        {
+            uint32_t inside[Words], overlap[Words];
+            boxes.contains(inside, q);
+            boxes.overlaps(overlap, q);
+            for (size_t i = 0; i < Size; ++i)
+            {
+                EXPECT_EQ((inside[i / 32] >> i % 32 & 1) != 0, boxes.at(i).contains(q));
+                EXPECT_EQ((overlap[i / 32] >> i % 32 & 1) != 0, boxes.at(i).overlaps(q));
+            }
+        }
+
+        for (size_t first : {(size_t)0, (size_t)7, (size_t)100})
+        {
+            const size_t count = Size - first - first / 2;
+
+            Box3d expected;
+            expected.clear();
+            for (size_t i = first; i < first + count; ++i)
+                expected.merge(boxes.at(i));
+
+            const Box3d merged = boxes.merge(first, count);
+            for (int j = 0; j < 3; ++j)
+            {
+                EXPECT_EQ(merged.bMin[j], expected.bMin[j]);
+                EXPECT_EQ(merged.bMax[j], expected.bMax[j]);
+            }
+        }
+
+        const Box3d empty = boxes.merge(5, 0);
+        EXPECT_GT(empty.bMin[0], empty.bMax[0]);
+    };
+    forEachKernelLevel(check);
+}
+
+// Checks the structure of bvh and its queries against testing
+// every one of the n boxes.
+void testBvh(const Bvh& bvh, const Box3d* boxes, const size_t n)
+{
+    ASSERT_EQ(bvh.size(), n);
+    ASSERT_EQ(bvh.nodeCount() > 0, n > 0);
+
+    const BvhNode*  nodes = bvh.nodes();
+    const uint32_t* prims = bvh.primitives();
+
+    // Walks the tree, the array can hold nodes that left it.
+    std::vector<int>      seen(n, 0);
+    std::vector<uint32_t> stack;
+    if (n > 0)
+        stack.push_back(0);
+    while (!stack.empty())
+    {
+        const BvhNode& nd = nodes[stack.back()];
+        stack.pop_back();
+        if (nd.leaf())
+        {
+            EXPECT_LE(nd.count, Bvh::MaxLeafSize);
+            for (uint32_t k = nd.first; k < nd.first + nd.count; ++k)
+            {
+                ++seen[prims[k]];
+                for (int j = 0; j < 3; ++j)
+                {
+                    EXPECT_LE(nd.bounds.bMin[j], boxes[prims[k]].bMin[j]);
+                    EXPECT_GE(nd.bounds.bMax[j], boxes[prims[k]].bMax[j]);
+                }
+            }
+        }
+        else
+        {
+            EXPECT_LT(nd.first + 1, bvh.nodeCount());
+            for (uint32_t c = nd.first; c < nd.first + 2; ++c)
+            {
+                stack.push_back(c);
+                for (int j = 0; j < 3; ++j)
+                {
+                    EXPECT_LE(nd.bounds.bMin[j], nodes[c].bounds.bMin[j]);
+                    EXPECT_GE(nd.bounds.bMax[j], nodes[c].bounds.bMax[j]);
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < n; ++i)
+        EXPECT_EQ(seen[i], 1);
+
+    for (int k = 0; k < 64; ++k)
+    {
+        // Most rays aim at a box, some run parallel to an axis.
+        const Vec3 o(30 * Rand::unit(), 30 * Rand::unit(), 30 * Rand::unit());
+
+        Vec3 d(Rand::unit(), Rand::unit(), Rand::unit());
+        if (n > 0 && k % 4 != 0)
+            d = boxes[Rand::range(0, (I32)n - 1)].center() - o;
+        if (k % 7 == 3)
+            d.y = 0;
+
+        const Ray  ray(o, d);
+        const Vec2 limit(k % 3 ? 0 : 5, k % 4 ? 1000 : 20);
+
+        const PreparedRay pr(ray);
+
+        int32_t    best = Bvh::None;
+        RayHitTest expected;
+        for (size_t i = 0; i < n; ++i)
+        {
+            RayHitTest rh;
+            if (boxes[i].hit(rh, pr, limit) && (best == Bvh::None || rh.distance < expected.distance))
+            {
+                best     = (int32_t)i;
+                expected = rh;
+            }
+        }
+
+        RayHitTest    rh;
+        const int32_t id = bvh.hit(rh, ray, limit);
+        EXPECT_EQ(id == Bvh::None, best == Bvh::None);
+        EXPECT_EQ(bvh.hitAny(ray, limit), best != Bvh::None);
+        if (id != Bvh::None && best != Bvh::None)
+        {
+            EXPECT_NEAR(rh.distance, expected.distance, 1e-5);
+            EXPECT_NEAR(rh.point.x, expected.point.x, 1e-4);
+            EXPECT_NEAR(rh.point.y, expected.point.y, 1e-4);
+            EXPECT_NEAR(rh.point.z, expected.point.z, 1e-4);
+        }
+    }
+
+    AlignedArray<uint32_t> found;
+    for (int k = 0; k < 16; ++k)
+    {
+        const Vec3   c(30 * Rand::unit(), 30 * Rand::unit(), 30 * Rand::unit());
+        const Box3d  box(Vec3(8 * Rand::real(), 8 * Rand::real(), 8 * Rand::real()), c);
+        const Sphere sphere(c, 6 * Rand::real());
+
+        std::vector<uint32_t> inBox, inSphere;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (boxes[i].overlaps(box))
+                inBox.push_back((uint32_t)i);
+
+            const Vec3 p(clamp<Real>(c.x, boxes[i].bMin[0], boxes[i].bMax[0]),
+                         clamp<Real>(c.y, boxes[i].bMin[1], boxes[i].bMax[1]),
+                         clamp<Real>(c.z, boxes[i].bMin[2], boxes[i].bMax[2]));
+            if ((p - c).length2() <= sphere.radius * sphere.radius)
+                inSphere.push_back((uint32_t)i);
+        }
+
+        bvh.overlaps(found, box);
+        std::vector<uint32_t> ids(found.begin(), found.end());
+        std::sort(ids.begin(), ids.end());
+        EXPECT_EQ(ids, inBox);
+
+        bvh.overlaps(found, sphere);
+        ids.assign(found.begin(), found.end());
+        std::sort(ids.begin(), ids.end());
+        EXPECT_EQ(ids, inSphere);
+    }
+}
+
+GTEST_TEST(Math, Bvh_001)
+{
+    Rand::init();
+
+    Bvh bvh;
+    bvh.build(nullptr, 0);
+    RayHitTest rh;
+    EXPECT_EQ(bvh.hit(rh, Ray(Vec3::Zero, Vec3(0, 0, 1)), {0, 100}), Bvh::None);
+    EXPECT_FALSE(bvh.hitAny(Ray(Vec3::Zero, Vec3(0, 0, 1)), {0, 100}));
+    EXPECT_EQ(bvh.cost(), 0);
+
+    constexpr size_t Size = 2000;
+
+    std::vector<Box3d> boxes(Size);
+    for (size_t i = 0; i < Size; ++i)
+    {
+        // Clusters of small boxes, with some long thin ones.
+        const Vec3 c(30 * Rand::unit(), 30 * Rand::unit(), 30 * Rand::unit());
+        const Real s = i % 50 == 0 ? 10 : 1;
+        boxes[i]     = Box3d(Vec3(s * Rand::real(), Rand::real(), Rand::real()), c);
+    }
+
+    bvh.build(boxes.data(), Size);
+    testBvh(bvh, boxes.data(), Size);
+    EXPECT_LT(bvh.cost(), Real(Size) / 20);
+
+    // Coincident centers leave nothing for the heuristic to split.
+    std::vector<Box3d> same(100, Box3d(Vec3::Unit, Vec3::Zero));
+    for (size_t i = 0; i < same.size(); ++i)
+        same[i].scale(1 + Real(i % 3));
+
+    bvh.build(same.data(), same.size());
+    testBvh(bvh, same.data(), same.size());
+
+    // New slots are constructed, so boxes start out cleared.
+    AlignedArray<Box3d> cleared(3);
+    cleared.resize(5);
+    for (const Box3d& bb : cleared)
+    {
+        EXPECT_EQ(bb.min().x, Box3d().min().x);
+        EXPECT_EQ(bb.max().z, Box3d().max().z);
+    }
+}
+
+GTEST_TEST(Math, Bvh_linear)
+{
+    Rand::init();
+
+    constexpr size_t Size = 20000;
+
+    std::vector<Box3d> boxes(Size);
+    for (size_t i = 0; i < Size; ++i)
+    {
+        const Vec3 c(30 * Rand::unit(), 30 * Rand::unit(), 30 * Rand::unit());
+        boxes[i] = Box3d(Vec3(Rand::real(), Rand::real(), Rand::real()), c);
+    }
+
+    // Repeated boxes give equal codes, which the build orders by index.
+    for (size_t i = 0; i < 64; ++i)
+        boxes[Size - 1 - i] = boxes[0];
+
+    Bvh sah;
+    sah.build(boxes.data(), Size);
+
+    for (const MortonBits bits : {MB_30, MB_63})
+    {
+        for (const unsigned workers : {1u, 4u})
+        {
+            Bvh bvh;
+            bvh.buildLinear(boxes.data(), Size, bits, workers);
+            EXPECT_EQ(bvh.nodeCount(), 2 * Size - 1);
+            testBvh(bvh, boxes.data(), Size);
+
+            // The heuristic build is the better tree.
+            EXPECT_LT(sah.cost(), bvh.cost());
+        }
+
+        Bvh small;
+        small.buildLinear(boxes.data(), 1, bits);
+        testBvh(small, boxes.data(), 1);
+        small.buildLinear(boxes.data(), 2, bits);
+        testBvh(small, boxes.data(), 2);
+        small.buildLinear(boxes.data(), 100, bits, 8);
+        testBvh(small, boxes.data(), 100);
+    }
+}
+
+GTEST_TEST(Math, Bvh_refit)
+{
+    // Fixed, so that the rebuilds repair makes are repeatable.
+    Rand::init(7);
+
+    constexpr size_t Size = 20000;
+
+    std::vector<Box3d> boxes(Size);
+    for (size_t i = 0; i < Size; ++i)
+    {
+        const Vec3 c(30 * Rand::unit(), 30 * Rand::unit(), 30 * Rand::unit());
+        boxes[i] = Box3d(Vec3(Rand::real(), Rand::real(), Rand::real()), c);
+    }
+
+    for (const bool linear : {false, true})
+    {
+        std::vector<Box3d> moved(boxes);
+
+        Bvh bvh;
+        if (linear)
+            bvh.buildLinear(moved.data(), Size, MB_30, 4);
+        else
+            bvh.build(moved.data(), Size);
+
+        // Nothing queued leaves the tree as it is.
+        const Real built = bvh.cost();
+        bvh.refit(4);
+        bvh.repair();
+        EXPECT_EQ(bvh.cost(), built);
+
+        for (size_t tick = 0; tick < 8; ++tick)
+        {
+            // A tenth of the boxes drift, a few jump across the scene.
+            for (size_t i = tick; i < Size; i += 10)
+            {
+                const Vec3 d = i % 100 == tick
+                                   ? Vec3(30 * Rand::unit(), 30 * Rand::unit(), 30 * Rand::unit())
+                                   : Vec3(Rand::unit(), Rand::unit(), Rand::unit()) * Real(0.2);
+
+                moved[i].translate(d);
+                bvh.update(i, moved[i]);
+            }
+
+            bvh.refit(tick % 2 ? 4 : 1);
+            testBvh(bvh, moved.data(), Size);
+
+            const Real refitted = bvh.cost();
+            bvh.repair();
+            testBvh(bvh, moved.data(), Size);
+            EXPECT_LE(bvh.cost(), refitted);
+        }
+
+        // Scattering every box grows most nodes past the threshold,
+        // and the rebuilt tree is compacted again.
+        for (size_t i = 0; i < Size; ++i)
+        {
+            moved[i] = Box3d(moved[i].extent(), Vec3(30 * Rand::unit(), 30 * Rand::unit(), 30 * Rand::unit()));
+            bvh.update(i, moved[i]);
+        }
+        bvh.repair();
+        testBvh(bvh, moved.data(), Size);
+        EXPECT_LT(bvh.nodeCount(), 2 * Size);
+
+        Bvh fresh;
+        fresh.build(moved.data(), Size);
+        EXPECT_LT(bvh.cost(), fresh.cost() * Real(1.25));
+    }
+}